@@ -3,69 +3,129 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include "../planning_arena.h"
 #include "../../../../dependencies/cvector/cvector.h"
 #include "../coverage_path_planning.h"
 #include "bcd_event_list_building.h"
 #include "bcd_cell_computation.h"
+#include "bcd_sweep_status.h"
+#include "../../logger.h"
+
+#define LOG_MODULE LOG_MODULE_BCD
+
+// Event as seen by the sweep: edge references resolved to coordinates
+typedef struct
+{
+    point_t polygon_vertex;
+    bcd_event_type_t bcd_event_type;
+    polygon_edge_t floor_edge;
+    polygon_edge_t ceiling_edge;
+} bcd_sweep_event_t;
 
 // FORWARD DECLARATIONS ---------------------------------------------
 
 // --- COMPUTE_BCD_CELLS
 
-static int handle_side_in(const bcd_event_t curr_evt,
-                          cvector_vector_type(bcd_cell_t) * cell_list);
+static bcd_sweep_event_t resolve_sweep_event(const input_environment_t *env,
+                                             const bcd_event_t *event);
 
-static int handle_in(const bcd_event_t curr_evt,
-                     cvector_vector_type(bcd_cell_t) * cell_list);
+static int handle_side_in(const bcd_sweep_event_t curr_evt,
+                          cvector_vector_type(bcd_cell_t) * cell_list,
+                          bcd_edge_pool_t *edge_pool,
+                          bcd_sweep_status_t *status);
+
+static int handle_in(const bcd_sweep_event_t curr_evt,
+                     cvector_vector_type(bcd_cell_t) * cell_list,
+                     bcd_edge_pool_t *edge_pool,
+                     bcd_sweep_status_t *status);
 
 // --- --- HANDLE_IN HELPERS
 
-static void in_find_prev_cell(const bcd_event_t curr_evt,
+static void in_find_prev_cell(const bcd_sweep_event_t curr_evt,
                               cvector_vector_type(bcd_cell_t) * cell_list,
+                              const bcd_sweep_status_t *status,
                               int *prev_cell_index,
+                              int *prev_cell_rank,
                               point_t *c_pt,
                               point_t *f_pt);
 
+static bool in_cell_encloses_event(const bcd_sweep_event_t curr_evt,
+                                   const bcd_edge_pool_t *edge_pool,
+                                   const bcd_cell_t *cell,
+                                   float *evt_to_ceil_dist,
+                                   float *evt_to_floor_dist,
+                                   point_t *c_pt,
+                                   point_t *f_pt);
+
 // ---
 
-static int handle_side_out(const bcd_event_t curr_evt,
-                           cvector_vector_type(bcd_cell_t) * cell_list);
+static int handle_side_out(const bcd_sweep_event_t curr_evt,
+                           cvector_vector_type(bcd_cell_t) * cell_list,
+                           bcd_edge_pool_t *edge_pool,
+                           bcd_sweep_status_t *status);
 
-static int handle_out(const bcd_event_t curr_evt,
-                      cvector_vector_type(bcd_cell_t) * cell_list);
+static int handle_out(const bcd_sweep_event_t curr_evt,
+                      cvector_vector_type(bcd_cell_t) * cell_list,
+                      bcd_edge_pool_t *edge_pool,
+                      bcd_sweep_status_t *status);
 
 // --- --- HANDLE_OUT
 
-static void out_find_top_cell(const bcd_event_t curr_evt,
+static void out_find_top_cell(const bcd_sweep_event_t curr_evt,
                               cvector_vector_type(bcd_cell_t) * cell_list,
+                              const bcd_sweep_status_t *status,
                               int *top_cell_index,
                               point_t *c_pt);
 
-static void out_find_bottom_cell(const bcd_event_t curr_evt,
+static void out_find_bottom_cell(const bcd_sweep_event_t curr_evt,
                                  cvector_vector_type(bcd_cell_t) * cell_list,
+                                 const bcd_sweep_status_t *status,
                                  int *bottom_cell_index,
                                  point_t *f_pt);
 
 // ---
 
-static int handle_floor(const bcd_event_t curr_evt,
-                        cvector_vector_type(bcd_cell_t) * cell_list);
+static int handle_floor(const bcd_sweep_event_t curr_evt,
+                        cvector_vector_type(bcd_cell_t) * cell_list,
+                        bcd_edge_pool_t *edge_pool,
+                        bcd_sweep_status_t *status);
 
-static int handle_ceiling(const bcd_event_t curr_evt,
-                          cvector_vector_type(bcd_cell_t) * cell_list);
+static int handle_ceiling(const bcd_sweep_event_t curr_evt,
+                          cvector_vector_type(bcd_cell_t) * cell_list,
+                          bcd_edge_pool_t *edge_pool,
+                          bcd_sweep_status_t *status);
 
 // --- --- HANDLER HELPERS
 
-static bcd_cell_t fill_bcd_cell(point_t c_begin,
-                                polygon_edge_t c_edge,
-                                point_t c_end,
-                                point_t f_begin,
-                                polygon_edge_t f_edge,
-                                point_t f_end,
-                                bcd_neighbor_list_t neighbor_list,
-                                bool open,
-                                bool visited,
-                                bool cleaned);
+static int fill_bcd_cell(bcd_edge_pool_t *edge_pool,
+                         bcd_cell_t *cell,
+                         point_t c_begin,
+                         polygon_edge_t c_edge,
+                         point_t c_end,
+                         point_t f_begin,
+                         polygon_edge_t f_edge,
+                         point_t f_end,
+                         bcd_neighbor_list_t neighbor_list,
+                         bool open,
+                         bool visited,
+                         bool cleaned);
+
+// --- EDGE_POOL HELPERS
+
+static int init_bcd_edge_pool(bcd_edge_pool_t *edge_pool,
+                              int capacity);
+
+static int append_bcd_edge(bcd_edge_pool_t *edge_pool,
+                           bcd_edge_chain_t *chain,
+                           polygon_edge_t edge);
+
+static int freeze_bcd_edge_pool(bcd_edge_pool_t *edge_pool,
+                                cvector_vector_type(bcd_cell_t) * cell_list);
+
+static void compact_bcd_edge_chain(const bcd_edge_pool_t *edge_pool,
+                                   bcd_edge_chain_t *chain,
+                                   polygon_edge_t *edges,
+                                   int *write_index);
 
 static void update_bcd_cell(cvector_vector_type(bcd_cell_t) * cell_list,
                             int target_cell_index,
@@ -92,103 +152,173 @@ static void free_neighbor_list(bcd_neighbor_list_t *neighbor_list);
 // IMPLEMENTATION --- compute_bcd_cells -----------------------------
 
 int compute_bcd_cells(const bcd_event_list_t *event_list,
-                      cvector_vector_type(bcd_cell_t) * cell_list)
+                      cvector_vector_type(bcd_cell_t) * cell_list,
+                      bcd_edge_pool_t *edge_pool)
+{
+    bcd_event_stream_t stream;
+    if (open_bcd_event_list_stream(event_list, &stream) != 0)
+    {
+        return -6;
+    }
+
+    int rc = compute_bcd_cells_from_stream(&stream, cell_list, edge_pool);
+
+    close_bcd_event_stream(&stream);
+    return rc;
+}
+
+int compute_bcd_cells_from_stream(bcd_event_stream_t *stream,
+                                  cvector_vector_type(bcd_cell_t) * cell_list,
+                                  bcd_edge_pool_t *edge_pool)
 {
     int rc = 0;
 
-    for (int i = 0; i < event_list->length; i++)
+    // Most events add one or two edges; the pool grows if a layout needs more
+    if (init_bcd_edge_pool(edge_pool, 2 * stream->length) != 0)
+    {
+        return -6;
+    }
+
+    bcd_sweep_status_t status;
+    if (init_bcd_sweep_status(&status, edge_pool) != 0)
     {
-        bcd_event_t curr_evt = event_list->bcd_events[i];
+        return -6;
+    }
+
+    bcd_event_t event;
+    for (int i = 0; next_bcd_event(stream, &event); i++)
+    {
+        bcd_sweep_event_t curr_evt = resolve_sweep_event(stream->env, &event);
         bcd_event_type_t curr_evt_type = curr_evt.bcd_event_type;
 
         switch (curr_evt_type)
         {
         case SIDE_IN:
-            rc = handle_side_in(curr_evt, cell_list);
+            rc = handle_side_in(curr_evt, cell_list, edge_pool, &status);
             break;
 
         case IN:
-            rc = handle_in(curr_evt, cell_list);
+            rc = handle_in(curr_evt, cell_list, edge_pool, &status);
             break;
 
         case SIDE_OUT:
-            rc = handle_side_out(curr_evt, cell_list);
+            rc = handle_side_out(curr_evt, cell_list, edge_pool, &status);
             break;
 
         case OUT:
-            rc = handle_out(curr_evt, cell_list);
+            rc = handle_out(curr_evt, cell_list, edge_pool, &status);
             break;
 
         case FLOOR:
-            rc = handle_floor(curr_evt, cell_list);
+            rc = handle_floor(curr_evt, cell_list, edge_pool, &status);
             break;
 
         case CEILING:
-            rc = handle_ceiling(curr_evt, cell_list);
+            rc = handle_ceiling(curr_evt, cell_list, edge_pool, &status);
             break;
 
         case NONE:
+            free_bcd_sweep_status(&status);
             return -2; // Unhandled event
 
         default:
+            free_bcd_sweep_status(&status);
             return -1; // Invalid event
         }
 
         if (rc != 0)
         {
-            fprintf(stderr, "Error handling event %d (type %d): %d\n", i, curr_evt_type, rc);
+            LOG_ERROR("Error handling event %d (type %d): %d", i, curr_evt_type, rc);
+            free_bcd_sweep_status(&status);
             return rc;
         }
     }
 
-    return 0;
+    free_bcd_sweep_status(&status);
+
+    // Every cell is closed: lay each chain out contiguously for the later stages
+    return freeze_bcd_edge_pool(edge_pool, cell_list);
 }
 
 // --- COMPUTE_BCD_CELLS
 
-static int handle_side_in(const bcd_event_t curr_evt,
-                          cvector_vector_type(bcd_cell_t) * cell_list)
+static bcd_sweep_event_t resolve_sweep_event(const input_environment_t *env,
+                                             const bcd_event_t *event)
 {
-    bcd_cell_t new_cell = fill_bcd_cell(curr_evt.polygon_vertex,
-                                        curr_evt.ceiling_edge,
-                                        (point_t){0},
-                                        (point_t){0},
-                                        curr_evt.floor_edge,
-                                        curr_evt.polygon_vertex,
-                                        (bcd_neighbor_list_t){0},
-                                        true,
-                                        false,
-                                        false);
+    bcd_sweep_event_t sweep_event;
+    sweep_event.polygon_vertex = event->polygon_vertex;
+    sweep_event.bcd_event_type = event->bcd_event_type;
+    sweep_event.floor_edge = resolve_polygon_edge(env, event->floor_edge);
+    sweep_event.ceiling_edge = resolve_polygon_edge(env, event->ceiling_edge);
+    return sweep_event;
+}
+
+static int handle_side_in(const bcd_sweep_event_t curr_evt,
+                          cvector_vector_type(bcd_cell_t) * cell_list,
+                          bcd_edge_pool_t *edge_pool,
+                          bcd_sweep_status_t *status)
+{
+    bcd_cell_t new_cell;
+    if (fill_bcd_cell(edge_pool,
+                      &new_cell,
+                      curr_evt.polygon_vertex,
+                      curr_evt.ceiling_edge,
+                      (point_t){0},
+                      (point_t){0},
+                      curr_evt.floor_edge,
+                      curr_evt.polygon_vertex,
+                      (bcd_neighbor_list_t){0},
+                      true,
+                      false,
+                      false) != 0)
+    {
+        LOG_ERROR("Edge pool full in handle_side_in");
+        return -6;
+    }
 
     cvector_push_back(*cell_list, new_cell);
+    int new_cell_index = (int)cvector_size(*cell_list) - 1;
+
+    int rank = find_open_cell_insert_rank(status,
+                                          (const cvector_vector_type(bcd_cell_t) *)cell_list,
+                                          curr_evt.polygon_vertex);
+
+    if (open_sweep_cell(status, (const cvector_vector_type(bcd_cell_t) *)cell_list, new_cell_index, rank) != 0)
+    {
+        LOG_ERROR("Sweep status full in handle_side_in");
+        return -6;
+    }
 
     return 0;
 }
 
-static int handle_in(const bcd_event_t curr_evt,
-                     cvector_vector_type(bcd_cell_t) * cell_list)
+static int handle_in(const bcd_sweep_event_t curr_evt,
+                     cvector_vector_type(bcd_cell_t) * cell_list,
+                     bcd_edge_pool_t *edge_pool,
+                     bcd_sweep_status_t *status)
 {
     // PREV CELL
     
     int prev_cell_index = -1;
+    int prev_cell_rank = -1;
     point_t c_point;
     point_t f_point;
 
-    in_find_prev_cell(curr_evt, cell_list, &prev_cell_index, &c_point, &f_point);
+    in_find_prev_cell(curr_evt, cell_list, status, &prev_cell_index, &prev_cell_rank, &c_point, &f_point);
     if (prev_cell_index == -1)
     {
-        printf("Error: No previous cell found for IN event\n");
+        LOG_ERROR("No previous cell found for IN event");
         return -3;
     }
 
-    if (cvector_size((*cell_list)[prev_cell_index].ceiling_edge_list) == 0)
+    if ((*cell_list)[prev_cell_index].ceiling_edges.count == 0)
     {
-        printf("Error: prev_cell has empty ceiling_edge_list in handle_in\n");
+        LOG_ERROR("prev_cell has empty ceiling chain in handle_in");
         return -4;
     }
-    if (cvector_size((*cell_list)[prev_cell_index].floor_edge_list) == 0)
+    if ((*cell_list)[prev_cell_index].floor_edges.count == 0)
     {
-        printf("Error: prev_cell has empty floor_edge_list in handle_in\n");
+        LOG_ERROR("prev_cell has empty floor chain in handle_in");
         return -5;
     }
 
@@ -197,16 +327,23 @@ static int handle_in(const bcd_event_t curr_evt,
     bcd_neighbor_list_t top_nl = {0};
     add_head_cell_neighbor_list(&top_nl, prev_cell_index);
 
-    bcd_cell_t top_cell = fill_bcd_cell(c_point,
-                                        *cvector_back((*cell_list)[prev_cell_index].ceiling_edge_list),
-                                        (point_t){0},
-                                        (point_t){0},
-                                        curr_evt.floor_edge,
-                                        curr_evt.polygon_vertex,
-                                        top_nl,
-                                        true,
-                                        false,
-                                        false);
+    bcd_cell_t top_cell;
+    if (fill_bcd_cell(edge_pool,
+                      &top_cell,
+                      c_point,
+                      *bcd_edge_chain_back(edge_pool, (*cell_list)[prev_cell_index].ceiling_edges),
+                      (point_t){0},
+                      (point_t){0},
+                      curr_evt.floor_edge,
+                      curr_evt.polygon_vertex,
+                      top_nl,
+                      true,
+                      false,
+                      false) != 0)
+    {
+        LOG_ERROR("Edge pool full in handle_in");
+        return -6;
+    }
 
     cvector_push_back(*cell_list, top_cell);
     size_t top_cell_index = cvector_size(*cell_list) - 1;
@@ -216,20 +353,38 @@ static int handle_in(const bcd_event_t curr_evt,
     bcd_neighbor_list_t bottom_nl = {0};
     add_head_cell_neighbor_list(&bottom_nl, prev_cell_index);
 
-    bcd_cell_t bottom_cell = fill_bcd_cell(curr_evt.polygon_vertex,
-                                           curr_evt.ceiling_edge,
-                                           (point_t){0},
-                                           (point_t){0},
-                                           *cvector_back((*cell_list)[prev_cell_index].floor_edge_list),
-                                           f_point,
-                                           bottom_nl,
-                                           true,
-                                           false,
-                                           false);
+    bcd_cell_t bottom_cell;
+    if (fill_bcd_cell(edge_pool,
+                      &bottom_cell,
+                      curr_evt.polygon_vertex,
+                      curr_evt.ceiling_edge,
+                      (point_t){0},
+                      (point_t){0},
+                      *bcd_edge_chain_back(edge_pool, (*cell_list)[prev_cell_index].floor_edges),
+                      f_point,
+                      bottom_nl,
+                      true,
+                      false,
+                      false) != 0)
+    {
+        LOG_ERROR("Edge pool full in handle_in");
+        return -6;
+    }
 
     cvector_push_back(*cell_list, bottom_cell);
     size_t bottom_cell_index = cvector_size(*cell_list) - 1;
     
+    // SWEEP STATUS: prev cell is split in place into top (ceiling side) and bottom (floor side)
+
+    const cvector_vector_type(bcd_cell_t) *cells = (const cvector_vector_type(bcd_cell_t) *)cell_list;
+    close_sweep_cell(status, cells, prev_cell_index, prev_cell_rank);
+    if (open_sweep_cell(status, cells, (int)top_cell_index, prev_cell_rank) != 0 ||
+        open_sweep_cell(status, cells, (int)bottom_cell_index, prev_cell_rank + 1) != 0)
+    {
+        LOG_ERROR("Sweep status full in handle_in");
+        return -6;
+    }
+
     // PREV CELL
 
     update_bcd_cell(cell_list,
@@ -245,95 +400,123 @@ static int handle_in(const bcd_event_t curr_evt,
 
 // --- --- HANDLE_IN
 
-static void in_find_prev_cell(const bcd_event_t curr_evt,
+static void in_find_prev_cell(const bcd_sweep_event_t curr_evt,
                               cvector_vector_type(bcd_cell_t) * cell_list,
+                              const bcd_sweep_status_t *status,
                               int *prev_cell_index,
+                              int *prev_cell_rank,
                               point_t *c_pt,
                               point_t *f_pt)
 {
     if (!cell_list || !*cell_list)
     {
-        printf("BCD Cell List: NULL or empty\n");
+        LOG_ERROR("BCD Cell List: NULL or empty");
         return;
     }
 
+    float evt_to_ceil_dist;
+    float evt_to_floor_dist;
+    point_t c_intersection;
+    point_t f_intersection;
+
+    // Open cells are disjoint along the sweep line: binary search, then confirm with the exact test
+    int rank = find_enclosing_open_cell_rank(status,
+                                             (const cvector_vector_type(bcd_cell_t) *)cell_list,
+                                             curr_evt.polygon_vertex);
+    if (rank >= 0 &&
+        in_cell_encloses_event(curr_evt, status->edge_pool, &(*cell_list)[status->open_cells[rank]],
+                               &evt_to_ceil_dist, &evt_to_floor_dist,
+                               &c_intersection, &f_intersection))
+    {
+        *prev_cell_index = status->open_cells[rank];
+        *prev_cell_rank = rank;
+        *c_pt = c_intersection;
+        *f_pt = f_intersection;
+        return;
+    }
+
+    // Degenerate geometry (edges not spanning the sweep x): closest enclosing open cell
+
     float min_evt_to_ceil_dist = INFINITY;
     float min_evt_to_floor_dist = INFINITY;
 
     int closest_cell_index = -1;
+    int closest_cell_rank = -1;
     point_t closest_c_pt;
     point_t closest_f_pt;
 
-    size_t i;
-    for (i = 0; i < cvector_size(*cell_list); ++i)
+    size_t r;
+    for (r = 0; r < cvector_size(status->open_cells); ++r)
     {
-        if (!(*cell_list)[i].open)
-            continue;
+        int i = status->open_cells[r];
 
-        if (cvector_size((*cell_list)[i].ceiling_edge_list) == 0 ||
-            cvector_size((*cell_list)[i].floor_edge_list) == 0)
-            continue;
-
-        polygon_edge_t ceil_edge = (*cell_list)[i].ceiling_edge_list[(cvector_size((*cell_list)[i].ceiling_edge_list)) - 1];
-        point_t c_intersection;
-        float evt_to_ceil_dist = calc_evt_to_edge_dist(curr_evt.polygon_vertex, ceil_edge, &c_intersection);
-
-        polygon_edge_t floor_edge = (*cell_list)[i].floor_edge_list[(cvector_size((*cell_list)[i].floor_edge_list)) - 1];
-        point_t f_intersection;
-        float evt_to_floor_dist = calc_evt_to_edge_dist(curr_evt.polygon_vertex, floor_edge, &f_intersection);
-
-        if (evt_to_ceil_dist < min_evt_to_ceil_dist &&
-            evt_to_floor_dist < min_evt_to_floor_dist &&
-            c_intersection.y < curr_evt.polygon_vertex.y &&
-            f_intersection.y > curr_evt.polygon_vertex.y)
+        if (in_cell_encloses_event(curr_evt, status->edge_pool, &(*cell_list)[i],
+                                   &evt_to_ceil_dist, &evt_to_floor_dist,
+                                   &c_intersection, &f_intersection) &&
+            evt_to_ceil_dist < min_evt_to_ceil_dist &&
+            evt_to_floor_dist < min_evt_to_floor_dist)
         {
             min_evt_to_ceil_dist = evt_to_ceil_dist;
             min_evt_to_floor_dist = evt_to_floor_dist;
 
             closest_cell_index = i;
+            closest_cell_rank = (int)r;
             closest_c_pt = c_intersection;
             closest_f_pt = f_intersection;
         }
     }
 
     *prev_cell_index = closest_cell_index;
+    *prev_cell_rank = closest_cell_rank;
     *c_pt = closest_c_pt;
     *f_pt = closest_f_pt;
 }
 
-// ---
-
-static int handle_side_out(const bcd_event_t curr_evt,
-                           cvector_vector_type(bcd_cell_t) * cell_list)
+static bool in_cell_encloses_event(const bcd_sweep_event_t curr_evt,
+                                   const bcd_edge_pool_t *edge_pool,
+                                   const bcd_cell_t *cell,
+                                   float *evt_to_ceil_dist,
+                                   float *evt_to_floor_dist,
+                                   point_t *c_pt,
+                                   point_t *f_pt)
 {
-    size_t cell_index;
-    for (cell_index = 0; cell_index < cvector_size(*cell_list); ++cell_index)
-    {
-        if (!(*cell_list)[cell_index].open)
-            continue;
+    if (cell->ceiling_edges.count == 0 ||
+        cell->floor_edges.count == 0)
+        return false;
 
-        if (cvector_size((*cell_list)[cell_index].ceiling_edge_list) == 0 ||
-            cvector_size((*cell_list)[cell_index].floor_edge_list) == 0)
-            continue;
+    *evt_to_ceil_dist = calc_evt_to_edge_dist(curr_evt.polygon_vertex, *bcd_edge_chain_back(edge_pool, cell->ceiling_edges), c_pt);
+    *evt_to_floor_dist = calc_evt_to_edge_dist(curr_evt.polygon_vertex, *bcd_edge_chain_back(edge_pool, cell->floor_edges), f_pt);
 
-        point_t ceil_edge_end = cvector_back((*cell_list)[cell_index].ceiling_edge_list)->end;
-        point_t floor_edge_begin = cvector_back((*cell_list)[cell_index].floor_edge_list)->begin;
+    return *evt_to_ceil_dist < INFINITY &&
+           *evt_to_floor_dist < INFINITY &&
+           c_pt->y < curr_evt.polygon_vertex.y &&
+           f_pt->y > curr_evt.polygon_vertex.y;
+}
 
-        if (are_equal_points(curr_evt.polygon_vertex, ceil_edge_end) &&
-            are_equal_points(curr_evt.polygon_vertex, floor_edge_begin))
-        {
-            break;
-        }
-    }
+// ---
+
+static int handle_side_out(const bcd_sweep_event_t curr_evt,
+                           cvector_vector_type(bcd_cell_t) * cell_list,
+                           bcd_edge_pool_t *edge_pool,
+                           bcd_sweep_status_t *status)
+{
+    int cell_index = find_cell_by_floor_frontier(status, curr_evt.polygon_vertex);
 
-    if (cell_index >= cvector_size(*cell_list))
+    if (cell_index < 0 ||
+        !are_equal_points(curr_evt.polygon_vertex, bcd_edge_chain_back(edge_pool, (*cell_list)[cell_index].ceiling_edges)->end))
     {
-        printf("Error: No matching cell found in handle_side_out\n");
+        LOG_ERROR("No matching cell found in handle_side_out");
         return -1;
     }
 
+    const cvector_vector_type(bcd_cell_t) *cells = (const cvector_vector_type(bcd_cell_t) *)cell_list;
+    close_sweep_cell(status,
+                     cells,
+                     cell_index,
+                     find_open_cell_rank(status, cells, cell_index, curr_evt.polygon_vertex));
+
     update_bcd_cell(cell_list,
-                    (int)cell_index,
+                    cell_index,
                     curr_evt.polygon_vertex,
                     curr_evt.polygon_vertex,
                     SIDE_OUT,
@@ -343,18 +526,20 @@ static int handle_side_out(const bcd_event_t curr_evt,
     return 0;
 }
 
-static int handle_out(const bcd_event_t curr_evt,
-                      cvector_vector_type(bcd_cell_t) * cell_list)
+static int handle_out(const bcd_sweep_event_t curr_evt,
+                      cvector_vector_type(bcd_cell_t) * cell_list,
+                      bcd_edge_pool_t *edge_pool,
+                      bcd_sweep_status_t *status)
 {
     // TOP CELL
     int top_cell_index = -1;
     point_t c_pt;
 
-    out_find_top_cell(curr_evt, cell_list, &top_cell_index, &c_pt);
+    out_find_top_cell(curr_evt, cell_list, status, &top_cell_index, &c_pt);
 
     if (top_cell_index == -1)
     {
-        printf("Error: Failed to find top cell in handle_out\n");
+        LOG_ERROR("Failed to find top cell in handle_out");
         return -1;
     }
 
@@ -362,11 +547,11 @@ static int handle_out(const bcd_event_t curr_evt,
     int bottom_cell_index = -1;
     point_t f_pt;
 
-    out_find_bottom_cell(curr_evt, cell_list, &bottom_cell_index, &f_pt);
+    out_find_bottom_cell(curr_evt, cell_list, status, &bottom_cell_index, &f_pt);
 
     if (bottom_cell_index == -1)
     {
-        printf("Error: Failed to find bottom cell in handle_out\n");
+        LOG_ERROR("Failed to find bottom cell in handle_out");
         return -1;
     }
 
@@ -377,22 +562,48 @@ static int handle_out(const bcd_event_t curr_evt,
     add_tail_cell_neighbor_list(&new_nl, top_cell_index);
     add_tail_cell_neighbor_list(&new_nl, bottom_cell_index);
     
-    new_cell = fill_bcd_cell(c_pt,
-                             *cvector_back((*cell_list)[top_cell_index].ceiling_edge_list),
-                             (point_t){0},
-                             (point_t){0},
-                             *cvector_back((*cell_list)[bottom_cell_index].floor_edge_list),
-                             f_pt,
-                             new_nl,
-                             true,
-                             false,
-                             false);
+    if (fill_bcd_cell(edge_pool,
+                      &new_cell,
+                      c_pt,
+                      *bcd_edge_chain_back(edge_pool, (*cell_list)[top_cell_index].ceiling_edges),
+                      (point_t){0},
+                      (point_t){0},
+                      *bcd_edge_chain_back(edge_pool, (*cell_list)[bottom_cell_index].floor_edges),
+                      f_pt,
+                      new_nl,
+                      true,
+                      false,
+                      false) != 0)
+    {
+        LOG_ERROR("Edge pool full in handle_out");
+        return -6;
+    }
 
     cvector_push_back(*cell_list, new_cell);
 
-    // UPDATING CELLS
+    // SWEEP STATUS: top and bottom cells merge into the new cell in place
     int new_cell_index = (int) cvector_size(*cell_list) - 1;
 
+    const cvector_vector_type(bcd_cell_t) *cells = (const cvector_vector_type(bcd_cell_t) *)cell_list;
+    int top_rank = find_open_cell_rank(status, cells, top_cell_index, curr_evt.polygon_vertex);
+    close_sweep_cell(status, cells, top_cell_index, top_rank);
+    int bottom_rank = find_open_cell_rank(status, cells, bottom_cell_index, curr_evt.polygon_vertex);
+    close_sweep_cell(status, cells, bottom_cell_index, bottom_rank);
+
+    int new_rank = top_rank;
+    if (new_rank < 0 || (bottom_rank >= 0 && bottom_rank < new_rank))
+        new_rank = bottom_rank;
+    if (new_rank < 0)
+        new_rank = find_open_cell_insert_rank(status, cells, curr_evt.polygon_vertex);
+
+    if (open_sweep_cell(status, cells, new_cell_index, new_rank) != 0)
+    {
+        LOG_ERROR("Sweep status full in handle_out");
+        return -6;
+    }
+
+    // UPDATING CELLS
+
     update_bcd_cell(cell_list,
                     top_cell_index,
                     c_pt,
@@ -414,190 +625,164 @@ static int handle_out(const bcd_event_t curr_evt,
 
 // --- --- HANDLE_OUT
 
-static void out_find_top_cell(const bcd_event_t curr_evt,
+static void out_find_top_cell(const bcd_sweep_event_t curr_evt,
                               cvector_vector_type(bcd_cell_t) * cell_list,
+                              const bcd_sweep_status_t *status,
                               int *top_cell_index,
                               point_t *c_pt)
 {
     if (!cell_list || !*cell_list)
     {
-        printf("BCD Cell List: NULL or empty\n");
+        LOG_ERROR("BCD Cell List: NULL or empty");
         return;
     }
 
-    point_t floor_edge_begin;
-    size_t i;
-    
-    for (i = 0; i < cvector_size(*cell_list); ++i)
-    {
-        if (!(*cell_list)[i].open)
-            continue;
-
-        if (cvector_size((*cell_list)[i].floor_edge_list) == 0)
-            continue;
+    *top_cell_index = find_cell_by_floor_frontier(status, curr_evt.polygon_vertex);
 
-        floor_edge_begin = cvector_back((*cell_list)[i].floor_edge_list)->begin;
-
-        if (!are_equal_points(curr_evt.polygon_vertex, floor_edge_begin))
-            continue;
-
-        break;
-    }
-
-    if (i >= cvector_size(*cell_list))
+    if (*top_cell_index < 0)
     {
-        printf("Error: No matching top cell found in out_find_top_cell\n");
+        LOG_ERROR("No matching top cell found in out_find_top_cell");
         *top_cell_index = -1;
         return;
     }
 
-    *top_cell_index = (int)i;
-
-    if (cvector_size((*cell_list)[*top_cell_index].ceiling_edge_list) == 0)
+    if ((*cell_list)[*top_cell_index].ceiling_edges.count == 0)
     {
-        printf("Error: Invalid top_cell or empty ceiling_edge_list in out_find_top_cell\n");
+        LOG_ERROR("Invalid top_cell or empty ceiling chain in out_find_top_cell");
         *top_cell_index = -1;
         return;
     }
 
-    polygon_edge_t ceil_edge = (*cell_list)[*top_cell_index].ceiling_edge_list[(cvector_size((*cell_list)[*top_cell_index].ceiling_edge_list)) - 1];
+    polygon_edge_t ceil_edge = *bcd_edge_chain_back(status->edge_pool, (*cell_list)[*top_cell_index].ceiling_edges);
     (void)calc_evt_to_edge_dist(curr_evt.polygon_vertex, ceil_edge, c_pt);
 }
 
-static void out_find_bottom_cell(const bcd_event_t curr_evt,
+static void out_find_bottom_cell(const bcd_sweep_event_t curr_evt,
                                  cvector_vector_type(bcd_cell_t) * cell_list,
+                                 const bcd_sweep_status_t *status,
                                  int *bottom_cell_index,
                                  point_t *f_pt)
 {
     if (!cell_list || !*cell_list)
     {
-        printf("BCD Cell List: NULL or empty\n");
+        LOG_ERROR("BCD Cell List: NULL or empty");
         return;
     }
 
-    point_t ceil_edge_end;
+    *bottom_cell_index = find_cell_by_ceiling_frontier(status, curr_evt.polygon_vertex);
 
-    size_t i;
-    for (i = 0; i < cvector_size(*cell_list); ++i)
+    if (*bottom_cell_index < 0)
     {
-        if (!(*cell_list)[i].open)
-            continue;
-
-        if (cvector_size((*cell_list)[i].ceiling_edge_list) == 0)
-            continue;
-
-        ceil_edge_end = cvector_back((*cell_list)[i].ceiling_edge_list)->end;
-
-        if (!are_equal_points(curr_evt.polygon_vertex, ceil_edge_end))
-            continue;
-
-        break;
-    }
-
-    if (i >= cvector_size(*cell_list))
-    {
-        printf("Error: No matching bottom cell found in out_find_bottom_cell\n");
+        LOG_ERROR("No matching bottom cell found in out_find_bottom_cell");
         *bottom_cell_index = -1;
         return;
     }
 
-    *bottom_cell_index = (int)i;
-
-    if (cvector_size((*cell_list)[*bottom_cell_index].floor_edge_list) == 0)
+    if ((*cell_list)[*bottom_cell_index].floor_edges.count == 0)
     {
-        printf("Error: Invalid bottom_cell or empty floor_edge_list in out_find_bottom_cell\n");
+        LOG_ERROR("Invalid bottom_cell or empty floor chain in out_find_bottom_cell");
         *bottom_cell_index = -1;
         return;
     }
 
-    polygon_edge_t floor_edge = (*cell_list)[*bottom_cell_index].floor_edge_list[(cvector_size((*cell_list)[*bottom_cell_index].floor_edge_list)) - 1];
+    polygon_edge_t floor_edge = *bcd_edge_chain_back(status->edge_pool, (*cell_list)[*bottom_cell_index].floor_edges);
     (void)calc_evt_to_edge_dist(curr_evt.polygon_vertex, floor_edge, f_pt);
 }
 
 // ---
 
-static int handle_floor(const bcd_event_t curr_evt,
-                        cvector_vector_type(bcd_cell_t) * cell_list)
+static int handle_floor(const bcd_sweep_event_t curr_evt,
+                        cvector_vector_type(bcd_cell_t) * cell_list,
+                        bcd_edge_pool_t *edge_pool,
+                        bcd_sweep_status_t *status)
 {
-    size_t i;
-    for (i = 0; i < cvector_size(*cell_list); ++i)
+    int i = find_cell_by_floor_frontier(status, curr_evt.polygon_vertex);
+    if (i < 0)
     {
-        if (!(*cell_list)[i].open)
-            continue;
-
-        point_t f_edge_begin;
-        f_edge_begin = cvector_back((*cell_list)[i].floor_edge_list)->begin;
+        LOG_ERROR("No matching cell found in handle_floor");
+        return -1;
+    }
 
-        if (are_equal_points(curr_evt.polygon_vertex, f_edge_begin))
-        {
-            break;
-        }
+    if (append_bcd_edge(edge_pool, &(*cell_list)[i].floor_edges, curr_evt.floor_edge) != 0)
+    {
+        LOG_ERROR("Edge pool full in handle_floor");
+        return -6;
     }
 
-    cvector_push_back((*cell_list)[i].floor_edge_list, curr_evt.floor_edge);
+    if (move_floor_frontier(status, i, curr_evt.polygon_vertex, curr_evt.floor_edge.begin) != 0)
+    {
+        LOG_ERROR("Sweep status full in handle_floor");
+        return -6;
+    }
 
     return 0;
 }
 
-static int handle_ceiling(const bcd_event_t curr_evt,
-                          cvector_vector_type(bcd_cell_t) * cell_list)
+static int handle_ceiling(const bcd_sweep_event_t curr_evt,
+                          cvector_vector_type(bcd_cell_t) * cell_list,
+                          bcd_edge_pool_t *edge_pool,
+                          bcd_sweep_status_t *status)
 {
-    size_t i;
-    for (i = 0; i < cvector_size(*cell_list); ++i)
+    int i = find_cell_by_ceiling_frontier(status, curr_evt.polygon_vertex);
+    if (i < 0)
     {
-        if (!(*cell_list)[i].open)
-            continue;
-
-        point_t c_edge_end;
-        c_edge_end = cvector_back((*cell_list)[i].ceiling_edge_list)->end;
+        LOG_ERROR("No matching cell found in handle_ceiling");
+        return -1;
+    }
 
-        if (are_equal_points(curr_evt.polygon_vertex, c_edge_end))
-            break;
+    if (append_bcd_edge(edge_pool, &(*cell_list)[i].ceiling_edges, curr_evt.ceiling_edge) != 0)
+    {
+        LOG_ERROR("Edge pool full in handle_ceiling");
+        return -6;
     }
 
-    cvector_push_back((*cell_list)[i].ceiling_edge_list, curr_evt.ceiling_edge);
+    if (move_ceiling_frontier(status, i, curr_evt.polygon_vertex, curr_evt.ceiling_edge.end) != 0)
+    {
+        LOG_ERROR("Sweep status full in handle_ceiling");
+        return -6;
+    }
 
     return 0;
 }
 
 // --- --- HANDLER HELPERS
 
-static bcd_cell_t fill_bcd_cell(point_t c_begin,
-                                polygon_edge_t c_edge,
-                                point_t c_end,
-                                point_t f_begin,
-                                polygon_edge_t f_edge,
-                                point_t f_end,
-                                bcd_neighbor_list_t neighbor_list,
-                                bool open,
-                                bool visited,
-                                bool cleaned)
+static int fill_bcd_cell(bcd_edge_pool_t *edge_pool,
+                         bcd_cell_t *cell,
+                         point_t c_begin,
+                         polygon_edge_t c_edge,
+                         point_t c_end,
+                         point_t f_begin,
+                         polygon_edge_t f_edge,
+                         point_t f_end,
+                         bcd_neighbor_list_t neighbor_list,
+                         bool open,
+                         bool visited,
+                         bool cleaned)
 {
-    bcd_cell_t cell;
+    cell->c_begin = c_begin;
 
-    cell.c_begin = c_begin;
+    cell->ceiling_edges = (bcd_edge_chain_t){0};
+    if (append_bcd_edge(edge_pool, &cell->ceiling_edges, c_edge) != 0)
+        return -6;
 
-    cvector_vector_type(polygon_edge_t) c_edge_list = NULL;
-    cvector_push_back(c_edge_list, c_edge);
-    cell.ceiling_edge_list = c_edge_list;
+    cell->c_end = c_end;
 
-    cell.c_end = c_end;
+    cell->f_begin = f_begin;
 
-    cell.f_begin = f_begin;
+    cell->floor_edges = (bcd_edge_chain_t){0};
+    if (append_bcd_edge(edge_pool, &cell->floor_edges, f_edge) != 0)
+        return -6;
 
-    cvector_vector_type(polygon_edge_t) f_edge_list = NULL;
-    cvector_push_back(f_edge_list, f_edge);
-    cell.floor_edge_list = f_edge_list;
+    cell->f_end = f_end;
 
-    cell.f_end = f_end;
+    cell->neighbor_list = neighbor_list;
 
-    cell.neighbor_list = neighbor_list;
+    cell->open = open;
+    cell->visited = visited;
+    cell->cleaned = cleaned;
 
-    cell.open = open;
-    cell.visited = visited;
-    cell.cleaned = cleaned;
-
-    return cell;
+    return 0;
 }
 
 static void update_bcd_cell(cvector_vector_type(bcd_cell_t) * cell_list,
@@ -670,6 +855,107 @@ static float calc_evt_to_edge_dist(point_t evt_vertex, polygon_edge_t cell_edge,
     return fabsf(dist_dy);
 }
 
+// --- EDGE_POOL HELPERS
+
+static int init_bcd_edge_pool(bcd_edge_pool_t *edge_pool,
+                              int capacity)
+{
+    if (capacity < 16)
+        capacity = 16;
+
+    edge_pool->edges = (polygon_edge_t *)planning_malloc((size_t)capacity * sizeof(polygon_edge_t));
+    edge_pool->next = (int *)planning_malloc((size_t)capacity * sizeof(int));
+    edge_pool->count = 0;
+    edge_pool->capacity = capacity;
+
+    if (!edge_pool->edges || !edge_pool->next)
+    {
+        free_bcd_edge_pool(edge_pool);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int append_bcd_edge(bcd_edge_pool_t *edge_pool,
+                           bcd_edge_chain_t *chain,
+                           polygon_edge_t edge)
+{
+    if (edge_pool->count == edge_pool->capacity)
+    {
+        int new_capacity = edge_pool->capacity * 2;
+        polygon_edge_t *edges = (polygon_edge_t *)planning_realloc(edge_pool->edges, (size_t)new_capacity * sizeof(polygon_edge_t));
+        if (!edges)
+            return -1;
+        edge_pool->edges = edges;
+
+        int *next = (int *)planning_realloc(edge_pool->next, (size_t)new_capacity * sizeof(int));
+        if (!next)
+            return -1;
+        edge_pool->next = next;
+
+        edge_pool->capacity = new_capacity;
+    }
+
+    int index = edge_pool->count++;
+    edge_pool->edges[index] = edge;
+    edge_pool->next[index] = -1;
+
+    if (chain->count == 0)
+        chain->first = index;
+    else
+        edge_pool->next[chain->last] = index;
+
+    chain->last = index;
+    chain->count++;
+
+    return 0;
+}
+
+static int freeze_bcd_edge_pool(bcd_edge_pool_t *edge_pool,
+                                cvector_vector_type(bcd_cell_t) * cell_list)
+{
+    int capacity = edge_pool->count > 0 ? edge_pool->count : 1;
+    polygon_edge_t *edges = (polygon_edge_t *)planning_malloc((size_t)capacity * sizeof(polygon_edge_t));
+    if (!edges)
+        return -6;
+
+    // Cell by cell, ceiling chain first, in the order the motion stage reads them
+    int write_index = 0;
+    for (size_t i = 0; i < cvector_size(*cell_list); ++i)
+    {
+        compact_bcd_edge_chain(edge_pool, &(*cell_list)[i].ceiling_edges, edges, &write_index);
+        compact_bcd_edge_chain(edge_pool, &(*cell_list)[i].floor_edges, edges, &write_index);
+    }
+
+    planning_free(edge_pool->edges);
+    planning_free(edge_pool->next);
+    edge_pool->edges = edges;
+    edge_pool->next = NULL;
+    edge_pool->count = write_index;
+    edge_pool->capacity = capacity;
+
+    return 0;
+}
+
+static void compact_bcd_edge_chain(const bcd_edge_pool_t *edge_pool,
+                                   bcd_edge_chain_t *chain,
+                                   polygon_edge_t *edges,
+                                   int *write_index)
+{
+    int first = *write_index;
+
+    int edge_index = chain->first;
+    for (int n = 0; n < chain->count; n++)
+    {
+        edges[(*write_index)++] = edge_pool->edges[edge_index];
+        edge_index = edge_pool->next[edge_index];
+    }
+
+    chain->first = first;
+    chain->last = first + chain->count - 1;
+}
+
 // --- NEIGHBOR_LIST HELPERS
 
 static void add_head_cell_neighbor_list(bcd_neighbor_list_t *neighbor_list,
@@ -678,7 +964,7 @@ static void add_head_cell_neighbor_list(bcd_neighbor_list_t *neighbor_list,
     if (!neighbor_list || cell_index < 0)
         return;
 
-    bcd_neighbor_node_t *new_node = (bcd_neighbor_node_t *)malloc(sizeof(bcd_neighbor_node_t));
+    bcd_neighbor_node_t *new_node = (bcd_neighbor_node_t *)planning_malloc(sizeof(bcd_neighbor_node_t));
     if (!new_node)
         return;
 
@@ -707,7 +993,7 @@ static void add_tail_cell_neighbor_list(bcd_neighbor_list_t *neighbor_list,
     if (!neighbor_list || cell_index < 0)
         return;
 
-    bcd_neighbor_node_t *new_node = (bcd_neighbor_node_t *)malloc(sizeof(bcd_neighbor_node_t));
+    bcd_neighbor_node_t *new_node = (bcd_neighbor_node_t *)planning_malloc(sizeof(bcd_neighbor_node_t));
     if (!new_node)
         return;
 
@@ -739,7 +1025,7 @@ static void free_neighbor_list(bcd_neighbor_list_t *neighbor_list)
     while (current)
     {
         bcd_neighbor_node_t *next = current->next;
-        free(current);
+        planning_free(current);
         current = next;
     }
 
@@ -750,70 +1036,77 @@ static void free_neighbor_list(bcd_neighbor_list_t *neighbor_list)
 
 // CELL LIST HELPERS
 
-// log_bcd_cell_list((const cvector_vector_type(bcd_cell_t) *) &cell_list);
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_DEBUG
 // Warning: Vector realloc unsafe.
-void log_bcd_cell_list(const cvector_vector_type(bcd_cell_t) * cell_list)
+void log_bcd_cell_list(const cvector_vector_type(bcd_cell_t) * cell_list,
+                       const bcd_edge_pool_t *edge_pool)
 {
+    // Callers need not check: the dump is skipped unless BCD debug output is on
+    if (!LOG_DEBUG_ENABLED())
+        return;
+
     if (!cell_list || !*cell_list)
     {
-        printf("BCD Cell List: NULL or empty\n");
+        LOG_DEBUG("BCD Cell List: NULL or empty");
         return;
     }
 
     size_t count = cvector_size(*cell_list);
-    printf("BCD Cell List: %zu cells\n", count);
+    LOG_DEBUG("BCD Cell List: %zu cells", count);
 
     for (size_t i = 0; i < count; ++i)
     {
         const bcd_cell_t *cell = &(*cell_list)[i];
-        printf("  Cell %zu:\n", i);
-        printf("    c_begin: (%.2f, %.2f)\n", cell->c_begin.x, cell->c_begin.y);
-        printf("    c_end: (%.2f, %.2f)\n", cell->c_end.x, cell->c_end.y);
-        printf("    f_begin: (%.2f, %.2f)\n", cell->f_begin.x, cell->f_begin.y);
-        printf("    f_end: (%.2f, %.2f)\n", cell->f_end.x, cell->f_end.y);
-        printf("    open: %s\n", cell->open ? "true" : "false");
-        printf("    visited: %s\n", cell->visited ? "true" : "false");
-        printf("    cleaned: %s\n", cell->cleaned ? "true" : "false");
-
-        // Log ceiling edge list
-        if (cell->ceiling_edge_list)
+        LOG_DEBUG("  Cell %zu:", i);
+        LOG_DEBUG("    c_begin: (%.2f, %.2f)", cell->c_begin.x, cell->c_begin.y);
+        LOG_DEBUG("    c_end: (%.2f, %.2f)", cell->c_end.x, cell->c_end.y);
+        LOG_DEBUG("    f_begin: (%.2f, %.2f)", cell->f_begin.x, cell->f_begin.y);
+        LOG_DEBUG("    f_end: (%.2f, %.2f)", cell->f_end.x, cell->f_end.y);
+        LOG_DEBUG("    open: %s", cell->open ? "true" : "false");
+        LOG_DEBUG("    visited: %s", cell->visited ? "true" : "false");
+        LOG_DEBUG("    cleaned: %s", cell->cleaned ? "true" : "false");
+
+        // Log ceiling edge chain
+        if (cell->ceiling_edges.count > 0)
         {
-            size_t ceiling_count = cvector_size(cell->ceiling_edge_list);
-            printf("    ceiling_edges: %zu edges\n", ceiling_count);
+            const polygon_edge_t *ceiling_edges = bcd_edge_chain_begin(edge_pool, cell->ceiling_edges);
+            size_t ceiling_count = (size_t)cell->ceiling_edges.count;
+            LOG_DEBUG("    ceiling_edges: %zu edges", ceiling_count);
             for (size_t j = 0; j < ceiling_count; ++j)
             {
-                printf("      [%zu]: (%.2f,%.2f) -> (%.2f,%.2f)\n", j,
-                       cell->ceiling_edge_list[j].begin.x, cell->ceiling_edge_list[j].begin.y,
-                       cell->ceiling_edge_list[j].end.x, cell->ceiling_edge_list[j].end.y);
+                LOG_DEBUG("      [%zu]: (%.2f,%.2f) -> (%.2f,%.2f)", j,
+                          ceiling_edges[j].begin.x, ceiling_edges[j].begin.y,
+                          ceiling_edges[j].end.x, ceiling_edges[j].end.y);
             }
         }
         else
         {
-            printf("    ceiling_edges: NULL\n");
+            LOG_DEBUG("    ceiling_edges: (empty chain)");
         }
 
-        // Log floor edge list
-        if (cell->floor_edge_list)
+        // Log floor edge chain
+        if (cell->floor_edges.count > 0)
         {
-            size_t floor_count = cvector_size(cell->floor_edge_list);
-            printf("    floor_edges: %zu edges\n", floor_count);
+            const polygon_edge_t *floor_edges = bcd_edge_chain_begin(edge_pool, cell->floor_edges);
+            size_t floor_count = (size_t)cell->floor_edges.count;
+            LOG_DEBUG("    floor_edges: %zu edges", floor_count);
             for (size_t j = 0; j < floor_count; ++j)
             {
-                printf("      [%zu]: (%.2f,%.2f) -> (%.2f,%.2f)\n", j,
-                       cell->floor_edge_list[j].begin.x, cell->floor_edge_list[j].begin.y,
-                       cell->floor_edge_list[j].end.x, cell->floor_edge_list[j].end.y);
+                LOG_DEBUG("      [%zu]: (%.2f,%.2f) -> (%.2f,%.2f)", j,
+                          floor_edges[j].begin.x, floor_edges[j].begin.y,
+                          floor_edges[j].end.x, floor_edges[j].end.y);
             }
         }
         else
         {
-            printf("    floor_edges: NULL\n");
+            LOG_DEBUG("    floor_edges: (empty chain)");
         }
 
-        printf("    neighbor_list: count=%d\n", cell->neighbor_list.count);
+        LOG_DEBUG("    neighbor_list: count=%d", cell->neighbor_list.count);
 
         if (cell->neighbor_list.head)
         {
-            printf("    neighbor nodes:\n");
+            LOG_DEBUG("    neighbor nodes:");
             bcd_neighbor_node_t *current = cell->neighbor_list.head;
             int node_index = 0;
             while (current)
@@ -823,32 +1116,31 @@ void log_bcd_cell_list(const cvector_vector_type(bcd_cell_t) * cell_list)
                 if (cell_index >= 0 && cell_index < (int)cvector_size(*cell_list))
                 {
                     const bcd_cell_t *neighbor_cell = &(*cell_list)[cell_index];
-                    printf("      [%d]: cell_index=%d cell_pos=(%.2f,%.2f)",
-                           node_index, cell_index,
-                           neighbor_cell->c_begin.x, neighbor_cell->c_begin.y);
+                    LOG_DEBUG("      [%d]: cell_index=%d cell_pos=(%.2f,%.2f)",
+                              node_index, cell_index,
+                              neighbor_cell->c_begin.x, neighbor_cell->c_begin.y);
                 }
                 else
                 {
-                    printf("      [%d]: cell_index=%d (INVALID INDEX)", node_index, cell_index);
+                    LOG_DEBUG("      [%d]: cell_index=%d (INVALID INDEX)", node_index, cell_index);
                 }
-                printf("\n");
                 current = current->next;
                 node_index++;
 
                 if (node_index > cell->neighbor_list.count + 1)
                 {
-                    printf("      [WARNING]: Potential infinite loop detected in neighbor list!\n");
+                    LOG_DEBUG("      [WARNING]: Potential infinite loop detected in neighbor list!");
                     break;
                 }
             }
         }
         else
         {
-            printf("    neighbor nodes: (empty list)\n");
+            LOG_DEBUG("    neighbor nodes: (empty list)");
         }
-        printf("\n");
     }
 }
+#endif
 
 void free_bcd_cell_list(cvector_vector_type(bcd_cell_t) * cell_list)
 {
@@ -857,10 +1149,21 @@ void free_bcd_cell_list(cvector_vector_type(bcd_cell_t) * cell_list)
         size_t i;
         for (i = 0; i < cvector_size(*cell_list); ++i)
         {
-            cvector_free((*cell_list)[i].ceiling_edge_list);
-            cvector_free((*cell_list)[i].floor_edge_list);
             free_neighbor_list(&(*cell_list)[i].neighbor_list);
         }
     }
     cvector_free(*cell_list);
 }
+
+void free_bcd_edge_pool(bcd_edge_pool_t *edge_pool)
+{
+    if (!edge_pool)
+        return;
+
+    planning_free(edge_pool->edges);
+    planning_free(edge_pool->next);
+    edge_pool->edges = NULL;
+    edge_pool->next = NULL;
+    edge_pool->count = 0;
+    edge_pool->capacity = 0;
+}
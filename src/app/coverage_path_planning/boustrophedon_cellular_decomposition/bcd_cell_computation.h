@@ -1,8 +1,10 @@
 #ifndef BCD_CELL_COMPUTATION_H
 #define BCD_CELL_COMPUTATION_H
 
+#include "../planning_arena.h"
 #include "../../../../dependencies/cvector/cvector.h"
 #include "bcd_event_list_building.h"
+#include "../../logger.h"
 
 typedef struct bcd_cell_t bcd_cell_t;
 typedef struct bcd_neighbor_node_t bcd_neighbor_node_t;
@@ -21,13 +23,31 @@ typedef struct
     int count;
 } bcd_neighbor_list_t;
 
+// Append-only storage shared by every cell's ceiling and floor chain. While the sweep
+// runs, chains of open cells interleave and are linked through next; once it ends the
+// pool is frozen: each chain is compacted into one contiguous run and next is dropped.
+typedef struct
+{
+    polygon_edge_t *edges;
+    int *next;          // Next edge of the same chain, -1 at its end; NULL once frozen
+    int count;
+    int capacity;
+} bcd_edge_pool_t;
+
+typedef struct
+{
+    int first;          // Start of the contiguous run once the pool is frozen
+    int last;           // Most recently appended edge, the chain's frontier
+    int count;
+} bcd_edge_chain_t;
+
 struct bcd_cell_t
 {
     point_t c_begin;
-    cvector_vector_type(polygon_edge_t) ceiling_edge_list;
+    bcd_edge_chain_t ceiling_edges;
     point_t c_end;
     point_t f_begin;
-    cvector_vector_type(polygon_edge_t) floor_edge_list;
+    bcd_edge_chain_t floor_edges;
     point_t f_end;
     bcd_neighbor_list_t neighbor_list;
     bool open;
@@ -35,10 +55,36 @@ struct bcd_cell_t
     bool cleaned;
 };
 
+// Boundary chains of the cells end up in edge_pool, frozen
 int compute_bcd_cells(const bcd_event_list_t *event_list,
-                      cvector_vector_type(bcd_cell_t) * cell_list);
+                      cvector_vector_type(bcd_cell_t) * cell_list,
+                      bcd_edge_pool_t *edge_pool);
+
+// Same as compute_bcd_cells, pulling events one at a time from stream
+int compute_bcd_cells_from_stream(bcd_event_stream_t *stream,
+                                  cvector_vector_type(bcd_cell_t) * cell_list,
+                                  bcd_edge_pool_t *edge_pool);
+
+// Edges of a chain in order; only valid once the pool is frozen
+static inline const polygon_edge_t *bcd_edge_chain_begin(const bcd_edge_pool_t *edge_pool,
+                                                         bcd_edge_chain_t chain)
+{
+    return chain.count > 0 ? edge_pool->edges + chain.first : NULL;
+}
+
+static inline const polygon_edge_t *bcd_edge_chain_back(const bcd_edge_pool_t *edge_pool,
+                                                        bcd_edge_chain_t chain)
+{
+    return &edge_pool->edges[chain.last];
+}
 
-void log_bcd_cell_list(const cvector_vector_type(bcd_cell_t) * cell_list);
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_DEBUG
+void log_bcd_cell_list(const cvector_vector_type(bcd_cell_t) * cell_list,
+                       const bcd_edge_pool_t *edge_pool);
+#else
+#define log_bcd_cell_list(...) ((void)0)
+#endif
 void free_bcd_cell_list(cvector_vector_type(bcd_cell_t) * cell_list);
+void free_bcd_edge_pool(bcd_edge_pool_t *edge_pool);
 
 #endif // BCD_CELL_COMPUTATION_H
@@ -0,0 +1,596 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+#include "../planning_arena.h"
+#include "../../../../dependencies/cvector/cvector.h"
+#include "bcd_cell_graph.h"
+#include "../../logger.h"
+
+#define LOG_MODULE LOG_MODULE_BCD
+
+#define CORRIDOR_SAME_LINE 1e-6 // Metres; windows this close ahead of a bend are on its line
+
+// A boundary crossed by a corridor, with x in the unfolded plane (see trace_bcd_cell_corridor)
+typedef struct
+{
+    double x;
+    double low;
+    double high;
+    float real_x;
+    bool turn; // The corridor turns back across this line
+} corridor_window_t;
+
+static point_t shared_boundary_midpoint(const bcd_cell_t *a, const bcd_cell_t *b);
+
+static bool find_shared_boundary(const bcd_cell_t *a, const bcd_cell_t *b, float *x, float *low, float *high);
+
+static bool are_neighbor_cells(const bcd_cell_t *a, int cell_index_b);
+
+static void append_corridor_turns(const corridor_window_t *window,
+                                  int window_from,
+                                  double from_x,
+                                  double from_y,
+                                  int window_to,
+                                  double to_y,
+                                  cvector_vector_type(point_t) * bends);
+
+static int search_cell_graph(bcd_cell_router_t *router, int cell_index_from, int cell_index_to, double *distance);
+
+static void relax_crossing(bcd_cell_router_t *router, int crossing, int parent, double cost, point_t target);
+
+static int pop_crossing(bcd_cell_router_t *router);
+
+static void place_in_heap(bcd_cell_router_t *router, int slot, int crossing, double key);
+
+static double point_distance(point_t a, point_t b);
+
+// IMPLEMENTATION --- build_bcd_cell_graph --------------------------
+
+int build_bcd_cell_graph(const cvector_vector_type(bcd_cell_t) * cell_list,
+                         bcd_cell_graph_t *graph)
+{
+    if (cell_list == NULL || graph == NULL)
+    {
+        LOG_ERROR("build_bcd_cell_graph: Invalid input parameters");
+        return -1;
+    }
+
+    int cell_count = (int)cvector_size(*cell_list);
+
+    graph->cell_count = cell_count;
+    graph->offsets = (int *)planning_malloc((size_t)(cell_count + 1) * sizeof(int));
+    graph->neighbors = NULL;
+    graph->crossings = NULL;
+    graph->centers = (point_t *)planning_malloc((size_t)(cell_count > 0 ? cell_count : 1) * sizeof(point_t));
+    if (!graph->offsets || !graph->centers)
+    {
+        free_bcd_cell_graph(graph);
+        return -2;
+    }
+
+    graph->offsets[0] = 0;
+    for (int i = 0; i < cell_count; i++)
+    {
+        graph->offsets[i + 1] = graph->offsets[i] + (*cell_list)[i].neighbor_list.count;
+    }
+
+    int edge_count = graph->offsets[cell_count];
+    graph->neighbors = (int *)planning_malloc((size_t)(edge_count > 0 ? edge_count : 1) * sizeof(int));
+    graph->crossings = (point_t *)planning_malloc((size_t)(edge_count > 0 ? edge_count : 1) * sizeof(point_t));
+    if (!graph->neighbors || !graph->crossings)
+    {
+        free_bcd_cell_graph(graph);
+        return -2;
+    }
+
+    for (int i = 0; i < cell_count; i++)
+    {
+        int *row = graph->neighbors + graph->offsets[i];
+        int n = 0;
+        for (const bcd_neighbor_node_t *node = (*cell_list)[i].neighbor_list.head;
+             node != NULL && n < (*cell_list)[i].neighbor_list.count;
+             node = node->next)
+        {
+            if (node->cell_index < 0 || node->cell_index >= cell_count)
+            {
+                LOG_ERROR("build_bcd_cell_graph: Cell %d has out-of-range neighbor %d", i, node->cell_index);
+                free_bcd_cell_graph(graph);
+                return -3;
+            }
+            row[n++] = node->cell_index;
+        }
+
+        if (n != bcd_cell_graph_degree(graph, i))
+        {
+            LOG_ERROR("build_bcd_cell_graph: Cell %d neighbor count mismatch", i);
+            free_bcd_cell_graph(graph);
+            return -3;
+        }
+    }
+
+    for (int i = 0; i < cell_count; i++)
+    {
+        const bcd_cell_t *cell = &(*cell_list)[i];
+        graph->centers[i].x = 0.25f * (cell->c_begin.x + cell->c_end.x + cell->f_begin.x + cell->f_end.x);
+        graph->centers[i].y = 0.25f * (cell->c_begin.y + cell->c_end.y + cell->f_begin.y + cell->f_end.y);
+
+        for (int k = graph->offsets[i]; k < graph->offsets[i + 1]; k++)
+        {
+            graph->crossings[k] = shared_boundary_midpoint(cell, &(*cell_list)[graph->neighbors[k]]);
+        }
+    }
+
+    return 0;
+}
+
+// --- BUILD_BCD_CELL_GRAPH
+
+static point_t shared_boundary_midpoint(const bcd_cell_t *a, const bcd_cell_t *b)
+{
+    float x;
+    float low;
+    float high;
+    find_shared_boundary(a, b, &x, &low, &high);
+    return (point_t){x, 0.5f * (low + high)};
+}
+
+// IMPLEMENTATION --- bcd_cell_router -------------------------------
+
+int init_bcd_cell_router(const bcd_cell_graph_t *graph, bcd_cell_router_t *router)
+{
+    int crossing_count = graph->offsets[graph->cell_count];
+    size_t slots = (size_t)(crossing_count > 0 ? crossing_count : 1);
+
+    router->graph = graph;
+    router->epoch = 0;
+    router->heap_size = 0;
+    router->cost = (double *)planning_malloc(slots * sizeof(double));
+    router->parent = (int *)planning_malloc(slots * sizeof(int));
+    router->reached = (unsigned *)planning_calloc(slots, sizeof(unsigned));
+    router->heap = (int *)planning_malloc(slots * sizeof(int));
+    router->heap_key = (double *)planning_malloc(slots * sizeof(double));
+    router->heap_slot = (int *)planning_malloc(slots * sizeof(int));
+    if (!router->cost || !router->parent || !router->reached ||
+        !router->heap || !router->heap_key || !router->heap_slot)
+    {
+        free_bcd_cell_router(router);
+        return -2;
+    }
+
+    return 0;
+}
+
+double bcd_cell_router_distance(bcd_cell_router_t *router, int cell_index_from, int cell_index_to)
+{
+    if (cell_index_from == cell_index_to)
+        return 0.0;
+
+    double distance;
+    if (search_cell_graph(router, cell_index_from, cell_index_to, &distance) < 0)
+        return -1.0;
+    return distance;
+}
+
+int bcd_cell_router_append_path(bcd_cell_router_t *router,
+                                int cell_index_from,
+                                int cell_index_to,
+                                cvector_vector_type(int) * path)
+{
+    if (cell_index_from == cell_index_to)
+        return 0;
+
+    double distance;
+    int crossing = search_cell_graph(router, cell_index_from, cell_index_to, &distance);
+    if (crossing < 0)
+        return -1;
+
+    // Walk back from the crossing into the target, collecting the cells entered on the
+    // way reversed in the (now idle) heap
+    int hops = 0;
+    for (int k = router->parent[crossing]; k != -1; k = router->parent[k])
+    {
+        router->heap[hops++] = router->graph->neighbors[k];
+    }
+
+    for (int i = hops - 1; i >= 0; i--)
+    {
+        cvector_push_back(*path, router->heap[i]);
+    }
+    return hops + 1;
+}
+
+void free_bcd_cell_router(bcd_cell_router_t *router)
+{
+    if (!router)
+        return;
+
+    planning_free(router->cost);
+    planning_free(router->parent);
+    planning_free(router->reached);
+    planning_free(router->heap);
+    planning_free(router->heap_key);
+    planning_free(router->heap_slot);
+    router->cost = NULL;
+    router->parent = NULL;
+    router->reached = NULL;
+    router->heap = NULL;
+    router->heap_key = NULL;
+    router->heap_slot = NULL;
+}
+
+// --- BCD_CELL_ROUTER
+
+// A* from the center of cell_index_from to the center of cell_index_to. The first
+// crossing into the target to leave the heap ends a shortest path: its key is then
+// the exact length, and no other key undershoots the length of its own best path.
+// Returns that crossing, with the length in *distance, or -1 if the target cannot be
+// reached.
+static int search_cell_graph(bcd_cell_router_t *router, int cell_index_from, int cell_index_to, double *distance)
+{
+    const bcd_cell_graph_t *graph = router->graph;
+    point_t target = graph->centers[cell_index_to];
+
+    // A new epoch marks every crossing unreached without touching the array
+    if (++router->epoch == 0)
+    {
+        for (int k = 0; k < graph->offsets[graph->cell_count]; k++)
+            router->reached[k] = 0;
+        router->epoch = 1;
+    }
+    router->heap_size = 0;
+
+    for (int k = graph->offsets[cell_index_from]; k < graph->offsets[cell_index_from + 1]; k++)
+    {
+        relax_crossing(router, k, -1, point_distance(graph->centers[cell_index_from], graph->crossings[k]), target);
+    }
+
+    while (router->heap_size > 0)
+    {
+        int crossing = pop_crossing(router);
+        int cell = graph->neighbors[crossing];
+        if (cell == cell_index_to)
+        {
+            *distance = router->cost[crossing] + point_distance(graph->crossings[crossing], target);
+            return crossing;
+        }
+
+        // On through the cell to each of its other boundaries. Straight back into the
+        // cell it was entered from never beats going on from that cell directly.
+        int previous_cell = router->parent[crossing] < 0 ? cell_index_from
+                                                          : graph->neighbors[router->parent[crossing]];
+        for (int k = graph->offsets[cell]; k < graph->offsets[cell + 1]; k++)
+        {
+            if (graph->neighbors[k] == previous_cell)
+                continue;
+
+            relax_crossing(router, k, crossing,
+                           router->cost[crossing] + point_distance(graph->crossings[crossing], graph->crossings[k]),
+                           target);
+        }
+    }
+
+    return -1;
+}
+
+// Records cost for crossing if it beats what the search has so far, and (re)queues it
+static void relax_crossing(bcd_cell_router_t *router, int crossing, int parent, double cost, point_t target)
+{
+    int slot;
+    if (router->reached[crossing] == router->epoch)
+    {
+        slot = router->heap_slot[crossing];
+        if (slot < 0 || cost >= router->cost[crossing])
+            return;
+    }
+    else
+    {
+        router->reached[crossing] = router->epoch;
+        slot = router->heap_size++;
+    }
+
+    router->cost[crossing] = cost;
+    router->parent[crossing] = parent;
+    double key = cost + point_distance(router->graph->crossings[crossing], target);
+
+    // Sift up: keys only ever decrease
+    while (slot > 0 && router->heap_key[(slot - 1) / 2] > key)
+    {
+        int up = (slot - 1) / 2;
+        place_in_heap(router, slot, router->heap[up], router->heap_key[up]);
+        slot = up;
+    }
+    place_in_heap(router, slot, crossing, key);
+}
+
+// Removes and returns the open crossing with the smallest key, marking it settled
+static int pop_crossing(bcd_cell_router_t *router)
+{
+    int top = router->heap[0];
+    router->heap_slot[top] = -1;
+
+    int size = --router->heap_size;
+    if (size == 0)
+        return top;
+
+    // Sift the last entry down from the root
+    int last = router->heap[size];
+    double key = router->heap_key[size];
+    int slot = 0;
+    for (;;)
+    {
+        int child = 2 * slot + 1;
+        if (child >= size)
+            break;
+        if (child + 1 < size && router->heap_key[child + 1] < router->heap_key[child])
+            child++;
+        if (router->heap_key[child] >= key)
+            break;
+
+        place_in_heap(router, slot, router->heap[child], router->heap_key[child]);
+        slot = child;
+    }
+    place_in_heap(router, slot, last, key);
+
+    return top;
+}
+
+static void place_in_heap(bcd_cell_router_t *router, int slot, int crossing, double key)
+{
+    router->heap[slot] = crossing;
+    router->heap_key[slot] = key;
+    router->heap_slot[crossing] = slot;
+}
+
+// IMPLEMENTATION --- trace_bcd_cell_corridor ----------------------
+
+// The boundaries crossed are windows on vertical lines. Mirroring the plane about a
+// line each time the corridor turns back across it makes the corridor run rightwards
+// throughout, and the shortest way through the windows is found there: the slopes
+// that still see every window from the last bend narrow window by window, and when a
+// window falls outside them the way bends at the end of the window that closed that
+// side, and the search restarts from there. The bends are mapped back to the real
+// plane, adding the points where the way touches the lines it turns back on.
+double trace_bcd_cell_corridor(const cvector_vector_type(bcd_cell_t) * cell_list,
+                               const int *corridor,
+                               int corridor_length,
+                               point_t from,
+                               point_t to,
+                               cvector_vector_type(point_t) * bends)
+{
+    // The last window is `to` itself
+    corridor_window_t stack_window[BCD_CORRIDOR_MAX_GATES];
+    corridor_window_t *window = stack_window;
+    if (corridor_length > BCD_CORRIDOR_MAX_GATES)
+    {
+        window = (corridor_window_t *)planning_malloc((size_t)corridor_length * sizeof(corridor_window_t));
+        if (!window) // Without room for the windows only the straight line can be given
+            return point_distance(from, to);
+    }
+
+    // Unfolded x = mirror * x + shift
+    int window_count = 0;
+    int direction = 0;
+    double mirror = 1.0;
+    double shift = 0.0;
+    double apex_x = from.x;
+    for (int i = 1; i < corridor_length; i++)
+    {
+        const bcd_cell_t *a = &(*cell_list)[corridor[i - 1]];
+        const bcd_cell_t *b = &(*cell_list)[corridor[i]];
+        if (!are_neighbor_cells(a, corridor[i]))
+            continue;
+
+        float x;
+        float low;
+        float high;
+        int gate_direction = find_shared_boundary(a, b, &x, &low, &high) ? 1 : -1;
+        bool turn = direction != 0 && gate_direction != direction;
+        if (direction == 0)
+        {
+            mirror = gate_direction;
+            apex_x = mirror * from.x;
+        }
+        else if (turn)
+        {
+            shift += 2.0 * mirror * x;
+            mirror = -mirror;
+        }
+        direction = gate_direction;
+        window[window_count++] = (corridor_window_t){mirror * x + shift, low, high, x, turn};
+    }
+    window[window_count++] = (corridor_window_t){mirror * to.x + shift, to.y, to.y, to.x, false};
+
+    double length = 0.0;
+    double apex_y = from.y;
+    int apex = -1; // Window the last bend lies on, -1 while it is `from`
+    for (;;)
+    {
+        double low_slope = -INFINITY;
+        double high_slope = INFINITY;
+        int low_window = -1;
+        int high_window = -1;
+        int bend = -1;
+        double bend_y = 0.0;
+        for (int k = apex + 1; k < window_count; k++)
+        {
+            const corridor_window_t *w = &window[k];
+            double dx = w->x - apex_x;
+            double slope_low;
+            double slope_high;
+            if (dx <= CORRIDOR_SAME_LINE)
+            {
+                // A window on the bend's own line is reached straight up or down
+                if (apex_y >= w->low && apex_y <= w->high)
+                    continue;
+                double step_y = apex_y > w->high ? w->high : w->low;
+                if (low_window < 0 && high_window < 0)
+                {
+                    bend = k;
+                    bend_y = step_y;
+                    break;
+                }
+                slope_low = slope_high = step_y > apex_y ? INFINITY : -INFINITY;
+            }
+            else
+            {
+                slope_low = (w->low - apex_y) / dx;
+                slope_high = (w->high - apex_y) / dx;
+            }
+
+            if (slope_low > high_slope)
+            {
+                bend = high_window;
+                bend_y = window[high_window].high;
+                break;
+            }
+            if (slope_high < low_slope)
+            {
+                bend = low_window;
+                bend_y = window[low_window].low;
+                break;
+            }
+            if (slope_low > low_slope)
+            {
+                low_slope = slope_low;
+                low_window = k;
+            }
+            if (slope_high < high_slope)
+            {
+                high_slope = slope_high;
+                high_window = k;
+            }
+        }
+        if (bend < 0)
+            break;
+
+        length += hypot(window[bend].x - apex_x, bend_y - apex_y);
+        if (bends)
+        {
+            append_corridor_turns(window, apex, apex_x, apex_y, bend, bend_y, bends);
+            if (bend < window_count - 1)
+                cvector_push_back(*bends, ((point_t){window[bend].real_x, (float)bend_y}));
+        }
+        apex = bend;
+        apex_x = window[bend].x;
+        apex_y = bend_y;
+    }
+
+    int last = window_count - 1;
+    length += hypot(window[last].x - apex_x, window[last].low - apex_y);
+    if (bends)
+        append_corridor_turns(window, apex, apex_x, apex_y, last, window[last].low, bends);
+
+    if (window != stack_window)
+        planning_free(window);
+    return length;
+}
+
+// --- TRACE_BCD_CELL_CORRIDOR
+
+// Cells only meet along the vertical line where one ends and the other begins, over
+// the stretch both of their sides there cover. Where a side's corners do not line up
+// the stretches can miss each other; the middle of the gap is used then, as a stretch
+// of no height. Returns whether b lies after (to the right of) a.
+static bool find_shared_boundary(const bcd_cell_t *a, const bcd_cell_t *b, float *x, float *low, float *high)
+{
+    bool b_after_a = fabsf(a->c_end.x - b->c_begin.x) <= fabsf(a->c_begin.x - b->c_end.x);
+    point_t a_ceiling = b_after_a ? a->c_end : a->c_begin;
+    point_t a_floor = b_after_a ? a->f_begin : a->f_end;
+    point_t b_ceiling = b_after_a ? b->c_begin : b->c_end;
+    point_t b_floor = b_after_a ? b->f_end : b->f_begin;
+
+    *x = 0.5f * (a_ceiling.x + b_ceiling.x);
+    *low = fmaxf(fminf(a_ceiling.y, a_floor.y), fminf(b_ceiling.y, b_floor.y));
+    *high = fminf(fmaxf(a_ceiling.y, a_floor.y), fmaxf(b_ceiling.y, b_floor.y));
+    if (*low > *high)
+        *low = *high = 0.5f * (*low + *high);
+    return b_after_a;
+}
+
+static bool are_neighbor_cells(const bcd_cell_t *a, int cell_index_b)
+{
+    int n = 0;
+    for (const bcd_neighbor_node_t *node = a->neighbor_list.head;
+         node != NULL && n < a->neighbor_list.count;
+         node = node->next, n++)
+    {
+        if (node->cell_index == cell_index_b)
+            return true;
+    }
+    return false;
+}
+
+// Appends where the straight way from the apex on window_from to window_to touches the
+// lines the corridor turns back on in between
+static void append_corridor_turns(const corridor_window_t *window,
+                                  int window_from,
+                                  double from_x,
+                                  double from_y,
+                                  int window_to,
+                                  double to_y,
+                                  cvector_vector_type(point_t) * bends)
+{
+    double to_x = window[window_to].x;
+    for (int k = window_from + 1; k < window_to; k++)
+    {
+        if (!window[k].turn || window[k].x <= from_x || window[k].x >= to_x)
+            continue;
+        double y = from_y + (to_y - from_y) * (window[k].x - from_x) / (to_x - from_x);
+        cvector_push_back(*bends, ((point_t){window[k].real_x, (float)y}));
+    }
+}
+
+static double point_distance(point_t a, point_t b)
+{
+    double dx = (double)a.x - b.x;
+    double dy = (double)a.y - b.y;
+    return sqrt(dx * dx + dy * dy);
+}
+
+// CELL GRAPH HELPERS
+
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_DEBUG
+void log_bcd_cell_graph(const bcd_cell_graph_t *graph)
+{
+    if (!LOG_DEBUG_ENABLED())
+        return;
+
+    if (!graph || !graph->offsets)
+    {
+        LOG_DEBUG("BCD Cell Graph: NULL");
+        return;
+    }
+
+    LOG_DEBUG("BCD Cell Graph: %d cells, %d adjacencies", graph->cell_count, graph->offsets[graph->cell_count]);
+
+    for (int i = 0; i < graph->cell_count; i++)
+    {
+        // One line per cell; very long rows are cut at the record size
+        char line[200];
+        int used = snprintf(line, sizeof(line), "  Cell %d ->", i);
+        const int *row = bcd_cell_graph_neighbors(graph, i);
+        for (int j = 0; j < bcd_cell_graph_degree(graph, i) && used > 0 && (size_t)used < sizeof(line); j++)
+        {
+            used += snprintf(line + used, sizeof(line) - (size_t)used, " %d", row[j]);
+        }
+        LOG_DEBUG("%s", line);
+    }
+}
+#endif
+
+void free_bcd_cell_graph(bcd_cell_graph_t *graph)
+{
+    if (!graph)
+        return;
+
+    planning_free(graph->offsets);
+    planning_free(graph->neighbors);
+    planning_free(graph->crossings);
+    planning_free(graph->centers);
+    graph->offsets = NULL;
+    graph->neighbors = NULL;
+    graph->crossings = NULL;
+    graph->centers = NULL;
+    graph->cell_count = 0;
+}
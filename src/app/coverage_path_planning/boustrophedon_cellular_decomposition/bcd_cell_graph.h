@@ -0,0 +1,93 @@
+#ifndef BCD_CELL_GRAPH_H
+#define BCD_CELL_GRAPH_H
+
+#include "../planning_arena.h"
+#include "../../../../dependencies/cvector/cvector.h"
+#include "bcd_cell_computation.h"
+
+// Cell adjacency frozen into compressed sparse rows once the sweep is done:
+// the neighbors of cell i are neighbors[offsets[i] .. offsets[i + 1]), in the
+// same order as the cell's neighbor_list. Each adjacency also keeps where it is
+// crossed, so routes can be measured in distance rather than in cells.
+typedef struct
+{
+    int cell_count;
+    int *offsets;       // cell_count + 1 entries
+    int *neighbors;     // offsets[cell_count] entries
+    point_t *crossings; // Parallel to neighbors: midpoint of the boundary shared with that neighbor
+    point_t *centers;   // cell_count entries: mean of each cell's four corners
+} bcd_cell_graph_t;
+
+int build_bcd_cell_graph(const cvector_vector_type(bcd_cell_t) * cell_list,
+                         bcd_cell_graph_t *graph);
+
+static inline int bcd_cell_graph_degree(const bcd_cell_graph_t *graph, int cell_index)
+{
+    return graph->offsets[cell_index + 1] - graph->offsets[cell_index];
+}
+
+static inline const int *bcd_cell_graph_neighbors(const bcd_cell_graph_t *graph, int cell_index)
+{
+    return graph->neighbors + graph->offsets[cell_index];
+}
+
+// Shortest paths between cells by distance travelled: from the center of the first
+// cell through the crossings of the boundaries on the way to the center of the last,
+// in straight lines. A* over the crossings (each adjacency, in either direction, is
+// one search node) with the straight distance to the target center as heuristic, so
+// a query settles little beyond the corridor it ends up using. Every buffer, the
+// binary heap included, is allocated once and reused by all queries.
+typedef struct
+{
+    const bcd_cell_graph_t *graph;
+    double *cost;               // Per crossing: distance from the start center along the best path found
+    int *parent;                // Per crossing: the crossing before it, -1 right after the start cell
+    unsigned *reached;          // reached[k] == epoch: crossing k has a cost in the current search
+    unsigned epoch;
+
+    int *heap;                  // Open crossings, a binary min-heap on heap_key
+    double *heap_key;           // cost plus straight distance to the target center
+    int *heap_slot;             // Per crossing: its index in heap, -1 once settled
+    int heap_size;
+} bcd_cell_router_t;
+
+// Returns 0, or -2 when out of memory
+int init_bcd_cell_router(const bcd_cell_graph_t *graph, bcd_cell_router_t *router);
+
+// Length of a shortest path from -> to, or -1 if to cannot be reached
+double bcd_cell_router_distance(bcd_cell_router_t *router, int cell_index_from, int cell_index_to);
+
+// Appends the cells strictly between from and to on a shortest path.
+// Returns the hop count, or -1 (nothing appended) if to cannot be reached.
+int bcd_cell_router_append_path(bcd_cell_router_t *router,
+                                int cell_index_from,
+                                int cell_index_to,
+                                cvector_vector_type(int) * path);
+
+void free_bcd_cell_router(bcd_cell_router_t *router);
+
+// Corridors up to this many cells are traced without allocating
+#ifndef BCD_CORRIDOR_MAX_GATES
+#define BCD_CORRIDOR_MAX_GATES 64
+#endif
+
+// Shortest way from `from`, in the first cell of corridor, to `to`, in its last: straight
+// lines that bend at the ends of the boundaries crossed from cell to cell, and where they
+// touch a boundary line the corridor turns back across. Steps between cells that are not
+// neighbors are not constrained. Appends the bends, in order, to *bends unless it is
+// NULL, and returns the length.
+double trace_bcd_cell_corridor(const cvector_vector_type(bcd_cell_t) * cell_list,
+                               const int *corridor,
+                               int corridor_length,
+                               point_t from,
+                               point_t to,
+                               cvector_vector_type(point_t) * bends);
+
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_DEBUG
+void log_bcd_cell_graph(const bcd_cell_graph_t *graph);
+#else
+#define log_bcd_cell_graph(...) ((void)0)
+#endif
+void free_bcd_cell_graph(bcd_cell_graph_t *graph);
+
+#endif // BCD_CELL_GRAPH_H
@@ -0,0 +1,1078 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "../planning_arena.h"
+#include "../../../../dependencies/cvector/cvector.h"
+#include "bcd_cell_ordering.h"
+#include "bcd_motion_planning.h"
+#include "../../logger.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define LOG_MODULE LOG_MODULE_BCD
+
+#define CELL_ORDER_NEIGHBORS 8          // Nearby cells tried by the moves, and by the construction
+#define CELL_ORDER_MAX_SEGMENT 3        // Longest run of cells Or-opt relocates
+#define CELL_ORDER_MIN_GAIN 1e-6        // Metres; smaller improvements are rounding noise
+#define CELL_ORDER_CLOCK_INTERVAL 64    // Tour positions between deadline checks
+#define CELL_ROUTES_MIN_CAPACITY 64     // Slots of the route table to begin with
+
+// Chains of cells between pairs of cells, from the router, each asked for once. Both
+// directions are stored from one search, so a reversed stretch of the tour is driven
+// back along the same cells. The transits between the sweep corners of the two cells
+// are traced along the chain when first needed and kept with it.
+typedef struct
+{
+    const cvector_vector_type(bcd_cell_t) * cell_list;
+    bcd_cell_router_t router;
+    int cell_count;
+
+    int64_t *keys;              // from * cell_count + to, -1 for a free slot
+    int *first;                 // Per slot: where its chain starts in cells
+    int *length;                // Per slot: cells in the chain, both ends included
+    int *transit;               // Per slot: where its corner-to-corner lengths start in transits
+    int capacity;               // Power of two, at most half full
+    int count;
+    cvector_vector_type(int) cells;
+    cvector_vector_type(double) transits; // BCD_SWEEP_VARIANT_COUNT^2 per slot, negative until traced
+    bool out_of_memory;
+} cell_routes_t;
+
+// Tour over the cells: order[k] is swept k-th, the way variant[k] says. The first cell is fixed.
+typedef struct
+{
+    int cell_count;
+    cell_routes_t *routes;
+    const point_t *entry;       // cell_count x BCD_SWEEP_VARIANT_COUNT
+    const point_t *exit;
+    const int *neighbors;       // cell_count x CELL_ORDER_NEIGHBORS, nearest first, -1 padded
+
+    int *order;
+    unsigned char *variant;
+    int *position;              // Inverse of order
+    unsigned char *back;        // choose_tour_variants scratch, cell_count x BCD_SWEEP_VARIANT_COUNT
+    bool *settled;              // Per cell: no move started from it helped, and its transits did not change since
+
+    double deadline;            // monotonic_ms() after which the search winds down
+    bool out_of_time;
+} cell_tour_t;
+
+// Uniform grid over the cell centers, for nearest-neighbor queries. Points can be
+// taken out again, as the nearest-neighbor tour places their cells.
+typedef struct
+{
+    const point_t *points;
+    float min_x;
+    float min_y;
+    float bucket_width;
+    float bucket_height;
+    int columns;
+    int rows;
+    int *bucket_start;          // columns x rows + 1
+    int *bucket_size;           // Points still in each bucket
+    int *bucket_points;         // Bucket b: [bucket_start[b], bucket_start[b] + bucket_size[b])
+    int *point_bucket;
+    int *point_slot;            // Index into bucket_points
+} point_grid_t;
+
+// --- OPTIMIZE_BCD_CELL_ORDER
+
+static void compute_cell_endpoints(const cvector_vector_type(bcd_cell_t) * cell_list,
+                                  const bcd_edge_pool_t *edge_pool,
+                                  float step_size,
+                                  point_t *entry,
+                                  point_t *exit);
+static int take_first_visits(const cvector_vector_type(int) * path_list, cell_tour_t *tour);
+static double visit_list_length(const cvector_vector_type(int) * path_list, const cell_tour_t *tour);
+static void build_nearest_neighbor_tour(cell_tour_t *tour, point_grid_t *grid, int starting_cell);
+static double choose_tour_variants(cell_tour_t *tour);
+static double tour_length(const cell_tour_t *tour);
+static bool improve_by_two_opt(cell_tour_t *tour, int position);
+static bool improve_by_or_opt(cell_tour_t *tour, int position);
+
+// --- --- IMPROVE_BY_TWO_OPT / IMPROVE_BY_OR_OPT
+
+static void reverse_tour_segment(cell_tour_t *tour, int first, int last);
+static void move_tour_segment(cell_tour_t *tour, int first, int last, int after, bool reversed);
+static void wake_tour_position(cell_tour_t *tour, int position);
+static bool check_deadline(cell_tour_t *tour, int position);
+
+// --- ---
+
+static void copy_tour(cell_tour_t *to, const cell_tour_t *from);
+static double transit_length(const cell_tour_t *tour, int from_cell, point_t from, int to_cell, point_t to);
+static int find_sweep_corner(const cell_tour_t *tour, int cell, point_t point);
+static double point_distance(point_t a, point_t b);
+static double monotonic_ms(void);
+
+// --- CELL_ROUTES
+
+static int init_cell_routes(cell_routes_t *routes,
+                            const cvector_vector_type(bcd_cell_t) * cell_list,
+                            const bcd_cell_graph_t *cell_graph);
+static const int *find_cell_route(cell_routes_t *routes, int from_cell, int to_cell, int *length, double **transits);
+static int add_cell_routes(cell_routes_t *routes, int from_cell, int to_cell);
+static int find_route_slot(const cell_routes_t *routes, int64_t key);
+static int grow_cell_routes(cell_routes_t *routes);
+static void free_cell_routes(cell_routes_t *routes);
+
+// --- POINT_GRID
+
+static int init_point_grid(point_grid_t *grid, const point_t *points, int point_count);
+static int find_nearest_points(const point_grid_t *grid, point_t query, int skipped, int k, int *nearest);
+static void remove_grid_point(point_grid_t *grid, int point_index);
+static void locate_grid_bucket(const point_grid_t *grid, point_t p, int *column, int *row);
+static void free_point_grid(point_grid_t *grid);
+
+static inline point_t tour_entry(const cell_tour_t *tour, int position)
+{
+    return tour->entry[tour->order[position] * BCD_SWEEP_VARIANT_COUNT + tour->variant[position]];
+}
+
+static inline point_t tour_exit(const cell_tour_t *tour, int position)
+{
+    return tour->exit[tour->order[position] * BCD_SWEEP_VARIANT_COUNT + tour->variant[position]];
+}
+
+// IMPLEMENTATION --- optimize_bcd_cell_order -----------------------
+
+int optimize_bcd_cell_order(const cvector_vector_type(bcd_cell_t) * cell_list,
+                            const bcd_edge_pool_t *edge_pool,
+                            const bcd_cell_graph_t *cell_graph,
+                            float step_size,
+                            cvector_vector_type(int) * path_list,
+                            int *sweep_order,
+                            unsigned char *sweep_variants,
+                            bcd_cell_order_report_t *report)
+{
+    if (cell_list == NULL || cell_graph == NULL || path_list == NULL || *path_list == NULL ||
+        sweep_order == NULL || sweep_variants == NULL || report == NULL)
+    {
+        LOG_ERROR("optimize_bcd_cell_order: Invalid input parameters");
+        return -1;
+    }
+
+    int cell_count = (int)cvector_size(*cell_list);
+    if (cell_count == 0 || cell_graph->cell_count != cell_count)
+    {
+        LOG_ERROR("optimize_bcd_cell_order: Cell graph does not match cell list");
+        return -1;
+    }
+
+    size_t variant_slots = (size_t)cell_count * BCD_SWEEP_VARIANT_COUNT;
+    point_t *entries = (point_t *)planning_malloc(variant_slots * sizeof(point_t));
+    point_t *exits = (point_t *)planning_malloc(variant_slots * sizeof(point_t));
+    int *neighbors = (int *)planning_malloc((size_t)cell_count * CELL_ORDER_NEIGHBORS * sizeof(int));
+
+    cell_tour_t tour = {0};
+    cell_tour_t baseline = {0};
+    point_grid_t grid = {0};
+    cell_routes_t routes = {0};
+    int rc = -2;
+
+    if (!entries || !exits || !neighbors)
+        goto cleanup;
+    if (init_cell_routes(&routes, cell_list, cell_graph) != 0)
+        goto cleanup;
+
+    tour.cell_count = baseline.cell_count = cell_count;
+    tour.routes = baseline.routes = &routes;
+    tour.entry = baseline.entry = entries;
+    tour.exit = baseline.exit = exits;
+    tour.neighbors = baseline.neighbors = neighbors;
+    tour.order = (int *)planning_malloc((size_t)cell_count * sizeof(int));
+    tour.variant = (unsigned char *)planning_malloc((size_t)cell_count);
+    tour.position = (int *)planning_malloc((size_t)cell_count * sizeof(int));
+    tour.back = (unsigned char *)planning_malloc(variant_slots);
+    tour.settled = (bool *)planning_calloc((size_t)cell_count, sizeof(bool));
+    baseline.order = (int *)planning_malloc((size_t)cell_count * sizeof(int));
+    baseline.variant = (unsigned char *)planning_malloc((size_t)cell_count);
+    baseline.position = (int *)planning_malloc((size_t)cell_count * sizeof(int));
+    baseline.back = tour.back;
+    if (!tour.order || !tour.variant || !tour.position || !tour.back || !tour.settled ||
+        !baseline.order || !baseline.variant || !baseline.position)
+        goto cleanup;
+
+    tour.deadline = monotonic_ms() + BCD_CELL_ORDER_TIME_BUDGET_MS;
+
+    compute_cell_endpoints(cell_list, edge_pool, step_size, entries, exits);
+    if (init_point_grid(&grid, cell_graph->centers, cell_count) != 0)
+        goto cleanup;
+    for (int i = 0; i < cell_count; i++)
+    {
+        find_nearest_points(&grid, cell_graph->centers[i], i, CELL_ORDER_NEIGHBORS, neighbors + (size_t)i * CELL_ORDER_NEIGHBORS);
+    }
+
+    // The order as given is the baseline, and the first starting point
+    rc = take_first_visits((const cvector_vector_type(int) *)path_list, &tour);
+    if (rc != 0)
+    {
+        LOG_ERROR("optimize_bcd_cell_order: Path list does not cover every cell once");
+        goto cleanup;
+    }
+    report->initial_transit_length = visit_list_length((const cvector_vector_type(int) *)path_list, &tour);
+    double baseline_length = choose_tour_variants(&tour);
+    copy_tour(&baseline, &tour);
+
+    // A nearest-neighbor tour is usually the better place to start from
+    build_nearest_neighbor_tour(&tour, &grid, baseline.order[0]);
+    if (choose_tour_variants(&tour) >= baseline_length)
+        copy_tour(&tour, &baseline);
+
+    // Rounds over the positions whose surroundings changed, until none of them has a move
+    // left. Moves elsewhere (and new variants) can open up moves at settled positions,
+    // so that is confirmed by a round over all of them.
+    bool improved = true;
+    bool full_round = false;
+    while (!tour.out_of_time && !routes.out_of_memory && (improved || !full_round))
+    {
+        if (!improved)
+            memset(tour.settled, 0, (size_t)cell_count * sizeof(bool));
+        full_round = !improved;
+        improved = false;
+
+        for (int k = 1; k < cell_count && !check_deadline(&tour, k); k++)
+        {
+            if (tour.settled[tour.order[k]])
+                continue;
+
+            if (improve_by_two_opt(&tour, k) || improve_by_or_opt(&tour, k))
+                improved = true;
+            else
+                tour.settled[tour.order[k]] = true;
+        }
+        choose_tour_variants(&tour);
+    }
+    report->transit_length = tour_length(&tour);
+    if (tour.out_of_time)
+        LOG_DEBUG("optimize_bcd_cell_order: Stopped after %d ms", BCD_CELL_ORDER_TIME_BUDGET_MS);
+
+    // Tour back into a visit list along the routes it was measured on, returning to
+    // the start like compute_bcd_path_list
+    cvector_clear(*path_list);
+    cvector_push_back(*path_list, tour.order[0]);
+    for (int k = 0; k <= cell_count; k++)
+    {
+        int route_length;
+        const int *route = k == 0 ? NULL
+                                  : find_cell_route(&routes, tour.order[k - 1], tour.order[k % cell_count], &route_length, NULL);
+        for (int i = 1; route && i < route_length; i++)
+        {
+            cvector_push_back(*path_list, route[i]);
+        }
+        if (k < cell_count)
+        {
+            sweep_order[k] = tour.order[k];
+            sweep_variants[tour.order[k]] = tour.variant[k];
+        }
+    }
+    rc = routes.out_of_memory ? -2 : 0;
+
+cleanup:
+    free_cell_routes(&routes);
+    free_point_grid(&grid);
+    planning_free(entries);
+    planning_free(exits);
+    planning_free(neighbors);
+    planning_free(tour.order);
+    planning_free(tour.variant);
+    planning_free(tour.position);
+    planning_free(tour.back);
+    planning_free(tour.settled);
+    planning_free(baseline.order);
+    planning_free(baseline.variant);
+    planning_free(baseline.position);
+    return rc;
+}
+
+// --- OPTIMIZE_BCD_CELL_ORDER
+
+// Cells that cannot be swept keep their ceiling corner for every variant; compute_bcd_motion
+// rejects them later anyway.
+static void compute_cell_endpoints(const cvector_vector_type(bcd_cell_t) * cell_list,
+                                  const bcd_edge_pool_t *edge_pool,
+                                  float step_size,
+                                  point_t *entry,
+                                  point_t *exit)
+{
+    int cell_count = (int)cvector_size(*cell_list);
+
+    for (int i = 0; i < cell_count; i++)
+    {
+        const bcd_cell_t *cell = &(*cell_list)[i];
+        for (int v = 0; v < BCD_SWEEP_VARIANT_COUNT; v++)
+        {
+            point_t *cell_entry = &entry[i * BCD_SWEEP_VARIANT_COUNT + v];
+            point_t *cell_exit = &exit[i * BCD_SWEEP_VARIANT_COUNT + v];
+            if (compute_bcd_sweep_endpoints(cell, edge_pool, v, step_size, cell_entry, cell_exit) != 0)
+            {
+                *cell_entry = cell->c_begin;
+                *cell_exit = cell->c_begin;
+            }
+        }
+    }
+}
+
+// Cells in order of their first visit, default sweeps. -1 unless every cell is visited.
+static int take_first_visits(const cvector_vector_type(int) * path_list, cell_tour_t *tour)
+{
+    int count = 0;
+    for (int i = 0; i < tour->cell_count; i++)
+    {
+        tour->position[i] = -1;
+    }
+
+    for (size_t i = 0; i < cvector_size(*path_list); i++)
+    {
+        int cell = (*path_list)[i];
+        if (cell < 0 || cell >= tour->cell_count)
+            return -1;
+        if (tour->position[cell] != -1)
+            continue;
+
+        tour->order[count] = cell;
+        tour->variant[count] = BCD_SWEEP_DEFAULT;
+        tour->position[cell] = count++;
+    }
+
+    return count == tour->cell_count ? 0 : -1;
+}
+
+// Transit of path_list as compute_bcd_motion drives it: each cell swept the default way
+// on its first visit, through the cells visited in between. The tour must hold the
+// first visits (take_first_visits).
+static double visit_list_length(const cvector_vector_type(int) * path_list, const cell_tour_t *tour)
+{
+    double length = 0.0;
+    size_t last_sweep = 0;
+    int next = 1;
+
+    for (size_t i = 1; i < cvector_size(*path_list) && next < tour->cell_count; i++)
+    {
+        if ((*path_list)[i] != tour->order[next])
+            continue;
+
+        length += trace_bcd_cell_corridor(tour->routes->cell_list,
+                                          *path_list + last_sweep,
+                                          (int)(i - last_sweep + 1),
+                                          tour_exit(tour, next - 1),
+                                          tour_entry(tour, next),
+                                          NULL);
+        last_sweep = i;
+        next++;
+    }
+    return length;
+}
+
+// From the starting cell, always on to the closest entry corner of a cell not swept yet:
+// among the current cell's neighbors while any is left, otherwise among the cells with
+// the closest centers. Placed cells are taken out of grid.
+static void build_nearest_neighbor_tour(cell_tour_t *tour, point_grid_t *grid, int starting_cell)
+{
+    int cell_count = tour->cell_count;
+
+    for (int cell = 0; cell < cell_count; cell++)
+    {
+        tour->position[cell] = -1;
+    }
+    tour->order[0] = starting_cell;
+    tour->variant[0] = BCD_SWEEP_DEFAULT;
+    tour->position[starting_cell] = 0;
+    remove_grid_point(grid, starting_cell);
+
+    for (int k = 1; k < cell_count; k++)
+    {
+        point_t from = tour_exit(tour, k - 1);
+        const int *candidates = tour->neighbors + (size_t)tour->order[k - 1] * CELL_ORDER_NEIGHBORS;
+        int nearest_cells[CELL_ORDER_NEIGHBORS];
+        int best_cell = -1;
+        int best_variant = 0;
+        double best_distance = INFINITY;
+
+        for (int pass = 0; pass < 2 && best_cell == -1; pass++)
+        {
+            if (pass == 1)
+            {
+                find_nearest_points(grid, from, -1, CELL_ORDER_NEIGHBORS, nearest_cells);
+                candidates = nearest_cells;
+            }
+
+            for (int i = 0; i < CELL_ORDER_NEIGHBORS; i++)
+            {
+                int cell = candidates[i];
+                if (cell < 0 || tour->position[cell] != -1)
+                    continue;
+
+                for (int v = 0; v < BCD_SWEEP_VARIANT_COUNT; v++)
+                {
+                    double d = transit_length(tour, tour->order[k - 1], from, cell, tour->entry[cell * BCD_SWEEP_VARIANT_COUNT + v]);
+                    if (d < best_distance)
+                    {
+                        best_distance = d;
+                        best_cell = cell;
+                        best_variant = v;
+                    }
+                }
+            }
+        }
+
+        tour->order[k] = best_cell;
+        tour->variant[k] = (unsigned char)best_variant;
+        tour->position[best_cell] = k;
+        remove_grid_point(grid, best_cell);
+    }
+}
+
+// Best variant for every cell of the current order (shortest path through a layered
+// graph of four nodes per cell). Returns the tour length.
+static double choose_tour_variants(cell_tour_t *tour)
+{
+    int cell_count = tour->cell_count;
+    double cost[BCD_SWEEP_VARIANT_COUNT] = {0};
+
+    for (int k = 1; k < cell_count; k++)
+    {
+        double next_cost[BCD_SWEEP_VARIANT_COUNT];
+        int previous_cell = tour->order[k - 1];
+        int cell = tour->order[k];
+
+        for (int v = 0; v < BCD_SWEEP_VARIANT_COUNT; v++)
+        {
+            point_t entry = tour->entry[cell * BCD_SWEEP_VARIANT_COUNT + v];
+            next_cost[v] = INFINITY;
+
+            // The current variant first: ties keep it, so repeated calls do not flip-flop
+            for (int i = 0; i < BCD_SWEEP_VARIANT_COUNT; i++)
+            {
+                int u = (tour->variant[k - 1] + i) % BCD_SWEEP_VARIANT_COUNT;
+                double c = cost[u] + transit_length(tour, previous_cell, tour->exit[previous_cell * BCD_SWEEP_VARIANT_COUNT + u], cell, entry);
+                if (c < next_cost[v])
+                {
+                    next_cost[v] = c;
+                    tour->back[k * BCD_SWEEP_VARIANT_COUNT + v] = (unsigned char)u;
+                }
+            }
+        }
+        memcpy(cost, next_cost, sizeof(cost));
+    }
+
+    // Same for the last cell
+    int v = tour->variant[cell_count - 1];
+    for (int u = 0; u < BCD_SWEEP_VARIANT_COUNT; u++)
+    {
+        if (cost[u] < cost[v])
+            v = u;
+    }
+    double length = cost[v];
+
+    for (int k = cell_count - 1; k >= 0; k--)
+    {
+        if (tour->variant[k] != v && tour->settled)
+            wake_tour_position(tour, k);
+        tour->variant[k] = (unsigned char)v;
+        if (k > 0)
+            v = tour->back[k * BCD_SWEEP_VARIANT_COUNT + v];
+    }
+    return length;
+}
+
+static double tour_length(const cell_tour_t *tour)
+{
+    double length = 0.0;
+    for (int k = 1; k < tour->cell_count; k++)
+    {
+        length += transit_length(tour, tour->order[k - 1], tour_exit(tour, k - 1), tour->order[k], tour_entry(tour, k));
+    }
+    return length;
+}
+
+// Reverses a stretch of the tour that starts or ends next to position, driving each of
+// its cells the other way, when the two transits that change get shorter. Stretches
+// are picked so that one of the new transits joins a cell to one of its neighbors.
+static bool improve_by_two_opt(cell_tour_t *tour, int position)
+{
+    int n = tour->cell_count;
+    int i = position - 1;
+
+    // New transit from position i to the reversed end of the stretch, at j
+    const int *candidates = tour->neighbors + (size_t)tour->order[i] * CELL_ORDER_NEIGHBORS;
+    for (int c = 0; c < CELL_ORDER_NEIGHBORS && candidates[c] >= 0; c++)
+    {
+        int j = tour->position[candidates[c]];
+        if (j <= position)
+            continue;
+
+        int a = tour->order[i];
+        point_t a_exit = tour_exit(tour, i);
+        double delta = transit_length(tour, a, a_exit, tour->order[j], tour_exit(tour, j)) -
+                       transit_length(tour, a, a_exit, tour->order[position], tour_entry(tour, position));
+        if (j < n - 1)
+            delta += transit_length(tour, tour->order[position], tour_entry(tour, position),
+                                    tour->order[j + 1], tour_entry(tour, j + 1)) -
+                     transit_length(tour, tour->order[j], tour_exit(tour, j),
+                                    tour->order[j + 1], tour_entry(tour, j + 1));
+
+        if (delta < -CELL_ORDER_MIN_GAIN)
+        {
+            reverse_tour_segment(tour, position, j);
+            return true;
+        }
+    }
+
+    // New transit from the reversed start of the stretch, at i, to position
+    candidates = tour->neighbors + (size_t)tour->order[position] * CELL_ORDER_NEIGHBORS;
+    for (int c = 0; c < CELL_ORDER_NEIGHBORS && candidates[c] >= 0; c++)
+    {
+        int first = tour->position[candidates[c]];
+        if (first < 1 || first >= i)
+            continue;
+
+        int before = tour->order[first - 1];
+        point_t before_exit = tour_exit(tour, first - 1);
+        double delta = transit_length(tour, before, before_exit, tour->order[i], tour_exit(tour, i)) -
+                       transit_length(tour, before, before_exit, tour->order[first], tour_entry(tour, first)) +
+                       transit_length(tour, tour->order[first], tour_entry(tour, first),
+                                      tour->order[position], tour_entry(tour, position)) -
+                       transit_length(tour, tour->order[i], tour_exit(tour, i),
+                                      tour->order[position], tour_entry(tour, position));
+
+        if (delta < -CELL_ORDER_MIN_GAIN)
+        {
+            reverse_tour_segment(tour, first, i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Moves the run of up to CELL_ORDER_MAX_SEGMENT cells starting at position next to a
+// neighbor of its first or last cell, as is or reversed, when that shortens the tour.
+static bool improve_by_or_opt(cell_tour_t *tour, int position)
+{
+    int n = tour->cell_count;
+    int s = position;
+
+    for (int length = 1; length <= CELL_ORDER_MAX_SEGMENT && s + length - 1 < n; length++)
+    {
+        int e = s + length - 1;
+        int before = tour->order[s - 1];
+        point_t before_exit = tour_exit(tour, s - 1);
+        double removal_gain = transit_length(tour, before, before_exit, tour->order[s], tour_entry(tour, s));
+        if (e < n - 1)
+            removal_gain += transit_length(tour, tour->order[e], tour_exit(tour, e),
+                                           tour->order[e + 1], tour_entry(tour, e + 1)) -
+                            transit_length(tour, before, before_exit, tour->order[e + 1], tour_entry(tour, e + 1));
+
+        int best_after = -1;
+        bool best_reversed = false;
+        double best_delta = -CELL_ORDER_MIN_GAIN;
+
+        for (int end = 0; end < 2; end++)
+        {
+            const int *candidates = tour->neighbors + (size_t)tour->order[end == 0 ? s : e] * CELL_ORDER_NEIGHBORS;
+            for (int c = 0; c < CELL_ORDER_NEIGHBORS && candidates[c] >= 0; c++)
+            {
+                // Right after the neighbor, or right before it
+                for (int side = 0; side < 2; side++)
+                {
+                    int after = tour->position[candidates[c]] - side;
+                    if (after < 0 || (after >= s - 1 && after <= e))
+                        continue;
+
+                    int after_cell = tour->order[after];
+                    point_t after_exit = tour_exit(tour, after);
+                    double forward = transit_length(tour, after_cell, after_exit, tour->order[s], tour_entry(tour, s));
+                    double reversed = transit_length(tour, after_cell, after_exit, tour->order[e], tour_exit(tour, e));
+                    if (after < n - 1)
+                    {
+                        int next_cell = tour->order[after + 1];
+                        point_t next_entry = tour_entry(tour, after + 1);
+                        double replaced = transit_length(tour, after_cell, after_exit, next_cell, next_entry);
+                        forward += transit_length(tour, tour->order[e], tour_exit(tour, e), next_cell, next_entry) - replaced;
+                        reversed += transit_length(tour, tour->order[s], tour_entry(tour, s), next_cell, next_entry) - replaced;
+                    }
+
+                    if (forward - removal_gain < best_delta)
+                    {
+                        best_delta = forward - removal_gain;
+                        best_after = after;
+                        best_reversed = false;
+                    }
+                    if (reversed - removal_gain < best_delta)
+                    {
+                        best_delta = reversed - removal_gain;
+                        best_after = after;
+                        best_reversed = true;
+                    }
+                }
+            }
+        }
+
+        if (best_after >= 0)
+        {
+            move_tour_segment(tour, s, e, best_after, best_reversed);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// --- --- IMPROVE_BY_TWO_OPT / IMPROVE_BY_OR_OPT
+
+static void reverse_tour_segment(cell_tour_t *tour, int first, int last)
+{
+    wake_tour_position(tour, first);
+    wake_tour_position(tour, last);
+
+    for (int k = first; k <= last; k++)
+    {
+        tour->variant[k] ^= BCD_SWEEP_REVERSED;
+    }
+
+    for (; first < last; first++, last--)
+    {
+        int cell = tour->order[first];
+        tour->order[first] = tour->order[last];
+        tour->order[last] = cell;
+
+        unsigned char variant = tour->variant[first];
+        tour->variant[first] = tour->variant[last];
+        tour->variant[last] = variant;
+
+        tour->position[tour->order[first]] = first;
+        tour->position[tour->order[last]] = last;
+    }
+}
+
+// Takes positions first..last out and puts them back right after position after
+// (which is outside them), flipped end to end if reversed
+static void move_tour_segment(cell_tour_t *tour, int first, int last, int after, bool reversed)
+{
+    int length = last - first + 1;
+    wake_tour_position(tour, first - 1);
+    wake_tour_position(tour, last);
+
+    int cells[CELL_ORDER_MAX_SEGMENT];
+    unsigned char variants[CELL_ORDER_MAX_SEGMENT];
+    for (int i = 0; i < length; i++)
+    {
+        int from = reversed ? last - i : first + i;
+        cells[i] = tour->order[from];
+        variants[i] = reversed ? tour->variant[from] ^ BCD_SWEEP_REVERSED : tour->variant[from];
+    }
+
+    // Close the gap by shifting what lies between the old and the new place
+    int insert_at;
+    if (after > last)
+    {
+        memmove(tour->order + first, tour->order + last + 1, (size_t)(after - last) * sizeof(int));
+        memmove(tour->variant + first, tour->variant + last + 1, (size_t)(after - last));
+        insert_at = after - length + 1;
+    }
+    else
+    {
+        memmove(tour->order + after + 1 + length, tour->order + after + 1, (size_t)(first - after - 1) * sizeof(int));
+        memmove(tour->variant + after + 1 + length, tour->variant + after + 1, (size_t)(first - after - 1));
+        insert_at = after + 1;
+    }
+
+    memcpy(tour->order + insert_at, cells, (size_t)length * sizeof(int));
+    memcpy(tour->variant + insert_at, variants, (size_t)length);
+
+    int low = after > last ? first : after + 1;
+    int high = after > last ? after : last;
+    for (int k = low; k <= high; k++)
+    {
+        tour->position[tour->order[k]] = k;
+    }
+
+    wake_tour_position(tour, insert_at);
+    wake_tour_position(tour, insert_at + length - 1);
+}
+
+// Position and the cells on either side of it have new transits
+static void wake_tour_position(cell_tour_t *tour, int position)
+{
+    int first = position > 0 ? position - 1 : 0;
+    int last = position < tour->cell_count - 1 ? position + 1 : tour->cell_count - 1;
+    for (int k = first; k <= last; k++)
+    {
+        tour->settled[tour->order[k]] = false;
+    }
+}
+
+static bool check_deadline(cell_tour_t *tour, int position)
+{
+    if (!tour->out_of_time && position % CELL_ORDER_CLOCK_INTERVAL == 0 && monotonic_ms() > tour->deadline)
+        tour->out_of_time = true;
+    return tour->out_of_time;
+}
+
+// --- ---
+
+static void copy_tour(cell_tour_t *to, const cell_tour_t *from)
+{
+    memcpy(to->order, from->order, (size_t)from->cell_count * sizeof(int));
+    memcpy(to->variant, from->variant, (size_t)from->cell_count);
+    memcpy(to->position, from->position, (size_t)from->cell_count * sizeof(int));
+}
+
+// Along the route between the cells, out of memory as the crow flies. Transits between
+// sweep corners are traced once; other points are traced every time.
+static double transit_length(const cell_tour_t *tour, int from_cell, point_t from, int to_cell, point_t to)
+{
+    int route_length;
+    double *transits;
+    const int *route = find_cell_route(tour->routes, from_cell, to_cell, &route_length, &transits);
+    if (!route)
+        return point_distance(from, to);
+
+    int from_corner = find_sweep_corner(tour, from_cell, from);
+    int to_corner = find_sweep_corner(tour, to_cell, to);
+    double *known = from_corner >= 0 && to_corner >= 0 ? &transits[from_corner * BCD_SWEEP_VARIANT_COUNT + to_corner] : NULL;
+    if (known && *known >= 0.0)
+        return *known;
+
+    double length = trace_bcd_cell_corridor(tour->routes->cell_list, route, route_length, from, to, NULL);
+    if (known)
+        *known = length;
+    return length;
+}
+
+// The variant that enters cell at point, or -1. A sweep leaves where its reversed
+// variant enters, so this also finds exits.
+static int find_sweep_corner(const cell_tour_t *tour, int cell, point_t point)
+{
+    const point_t *entry = tour->entry + (size_t)cell * BCD_SWEEP_VARIANT_COUNT;
+    for (int v = 0; v < BCD_SWEEP_VARIANT_COUNT; v++)
+    {
+        if (entry[v].x == point.x && entry[v].y == point.y)
+            return v;
+    }
+    return -1;
+}
+
+static double point_distance(point_t a, point_t b)
+{
+    double dx = (double)a.x - b.x;
+    double dy = (double)a.y - b.y;
+    return sqrt(dx * dx + dy * dy);
+}
+
+static double monotonic_ms(void)
+{
+#ifdef _WIN32
+    return (double)GetTickCount64();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec * 1000.0 + (double)now.tv_nsec / 1.0e6;
+#endif
+}
+
+// IMPLEMENTATION --- cell routes -----------------------------------
+
+static int init_cell_routes(cell_routes_t *routes,
+                            const cvector_vector_type(bcd_cell_t) * cell_list,
+                            const bcd_cell_graph_t *cell_graph)
+{
+    routes->cell_list = cell_list;
+    routes->cell_count = cell_graph->cell_count;
+    if (init_bcd_cell_router(cell_graph, &routes->router) != 0)
+        return -2;
+    return grow_cell_routes(routes);
+}
+
+// The cells from from_cell to to_cell, both included, or NULL when out of memory
+// (routes->out_of_memory is set then). Cells the router cannot connect, and a cell
+// with itself, get the two-cell chain of just the ends. *transits, unless transits is
+// NULL, receives the chain's corner-to-corner lengths.
+static const int *find_cell_route(cell_routes_t *routes, int from_cell, int to_cell, int *length, double **transits)
+{
+    int64_t key = (int64_t)from_cell * routes->cell_count + to_cell;
+    int slot = find_route_slot(routes, key);
+    if (routes->keys[slot] != key)
+    {
+        if (add_cell_routes(routes, from_cell, to_cell) != 0)
+        {
+            routes->out_of_memory = true;
+            return NULL;
+        }
+        slot = find_route_slot(routes, key);
+    }
+
+    *length = routes->length[slot];
+    if (transits)
+        *transits = routes->transits + routes->transit[slot];
+    return routes->cells + routes->first[slot];
+}
+
+// Searches from_cell -> to_cell once and stores the chain both ways
+static int add_cell_routes(cell_routes_t *routes, int from_cell, int to_cell)
+{
+    if (2 * (routes->count + 2) > routes->capacity && grow_cell_routes(routes) != 0)
+        return -2;
+
+    int first = (int)cvector_size(routes->cells);
+    cvector_push_back(routes->cells, from_cell);
+    if (from_cell != to_cell)
+        bcd_cell_router_append_path(&routes->router, from_cell, to_cell, &routes->cells);
+    cvector_push_back(routes->cells, to_cell);
+    int length = (int)cvector_size(routes->cells) - first;
+
+    // The reverse chain right behind it
+    for (int i = length - 1; i >= 0; i--)
+    {
+        cvector_push_back(routes->cells, routes->cells[first + i]);
+    }
+
+    int64_t keys[2] = {(int64_t)from_cell * routes->cell_count + to_cell,
+                       (int64_t)to_cell * routes->cell_count + from_cell};
+    for (int d = 0; d < 2 && (d == 0 || from_cell != to_cell); d++)
+    {
+        int slot = find_route_slot(routes, keys[d]);
+        if (routes->keys[slot] == keys[d])
+            continue;
+
+        routes->keys[slot] = keys[d];
+        routes->first[slot] = first + d * length;
+        routes->length[slot] = length;
+        routes->transit[slot] = (int)cvector_size(routes->transits);
+        for (int i = 0; i < BCD_SWEEP_VARIANT_COUNT * BCD_SWEEP_VARIANT_COUNT; i++)
+        {
+            cvector_push_back(routes->transits, -1.0);
+        }
+        routes->count++;
+    }
+    return 0;
+}
+
+// Linear probing: the slot holding key, or the free slot where it would go
+static int find_route_slot(const cell_routes_t *routes, int64_t key)
+{
+    int mask = routes->capacity - 1;
+    int slot = (int)((uint32_t)(((uint64_t)key * 0x9E3779B97F4A7C15ull) >> 32) & (uint32_t)mask);
+    while (routes->keys[slot] != -1 && routes->keys[slot] != key)
+    {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+// Doubles the table, or makes the first one
+static int grow_cell_routes(cell_routes_t *routes)
+{
+    int capacity = routes->capacity > 0 ? 2 * routes->capacity : CELL_ROUTES_MIN_CAPACITY;
+    cell_routes_t grown = *routes;
+    grown.capacity = capacity;
+    grown.keys = (int64_t *)planning_malloc((size_t)capacity * sizeof(int64_t));
+    grown.first = (int *)planning_malloc((size_t)capacity * sizeof(int));
+    grown.length = (int *)planning_malloc((size_t)capacity * sizeof(int));
+    grown.transit = (int *)planning_malloc((size_t)capacity * sizeof(int));
+    if (!grown.keys || !grown.first || !grown.length || !grown.transit)
+    {
+        planning_free(grown.keys);
+        planning_free(grown.first);
+        planning_free(grown.length);
+        planning_free(grown.transit);
+        return -2;
+    }
+
+    memset(grown.keys, 0xff, (size_t)capacity * sizeof(int64_t));
+    for (int i = 0; i < routes->capacity; i++)
+    {
+        if (routes->keys[i] == -1)
+            continue;
+
+        int slot = find_route_slot(&grown, routes->keys[i]);
+        grown.keys[slot] = routes->keys[i];
+        grown.first[slot] = routes->first[i];
+        grown.length[slot] = routes->length[i];
+        grown.transit[slot] = routes->transit[i];
+    }
+
+    planning_free(routes->keys);
+    planning_free(routes->first);
+    planning_free(routes->length);
+    planning_free(routes->transit);
+    *routes = grown;
+    return 0;
+}
+
+static void free_cell_routes(cell_routes_t *routes)
+{
+    free_bcd_cell_router(&routes->router);
+    planning_free(routes->keys);
+    planning_free(routes->first);
+    planning_free(routes->length);
+    planning_free(routes->transit);
+    cvector_free(routes->cells);
+    cvector_free(routes->transits);
+    *routes = (cell_routes_t){0};
+}
+
+// IMPLEMENTATION --- point grid ------------------------------------
+
+// About two points per bucket
+static int init_point_grid(point_grid_t *grid, const point_t *points, int point_count)
+{
+    grid->points = points;
+    grid->min_x = grid->min_y = INFINITY;
+    float max_x = -INFINITY;
+    float max_y = -INFINITY;
+    for (int i = 0; i < point_count; i++)
+    {
+        grid->min_x = fminf(grid->min_x, points[i].x);
+        grid->min_y = fminf(grid->min_y, points[i].y);
+        max_x = fmaxf(max_x, points[i].x);
+        max_y = fmaxf(max_y, points[i].y);
+    }
+
+    int side = (int)sqrt(point_count / 2.0);
+    grid->columns = grid->rows = side > 0 ? side : 1;
+    grid->bucket_width = (max_x - grid->min_x) / grid->columns;
+    grid->bucket_height = (max_y - grid->min_y) / grid->rows;
+    if (!(grid->bucket_width > 0.0f))
+        grid->bucket_width = 1.0f;
+    if (!(grid->bucket_height > 0.0f))
+        grid->bucket_height = 1.0f;
+
+    int bucket_count = grid->columns * grid->rows;
+    size_t point_slots = (size_t)(point_count > 0 ? point_count : 1);
+    grid->bucket_start = (int *)planning_calloc((size_t)bucket_count + 1, sizeof(int));
+    grid->bucket_size = (int *)planning_calloc((size_t)bucket_count, sizeof(int));
+    grid->bucket_points = (int *)planning_malloc(point_slots * sizeof(int));
+    grid->point_bucket = (int *)planning_malloc(point_slots * sizeof(int));
+    grid->point_slot = (int *)planning_malloc(point_slots * sizeof(int));
+    if (!grid->bucket_start || !grid->bucket_size || !grid->bucket_points || !grid->point_bucket || !grid->point_slot)
+        return -2;
+
+    // Counting sort of the points by bucket
+    for (int i = 0; i < point_count; i++)
+    {
+        int column;
+        int row;
+        locate_grid_bucket(grid, points[i], &column, &row);
+        grid->point_bucket[i] = row * grid->columns + column;
+        grid->bucket_size[grid->point_bucket[i]]++;
+    }
+    for (int b = 0; b < bucket_count; b++)
+    {
+        grid->bucket_start[b + 1] = grid->bucket_start[b] + grid->bucket_size[b];
+        grid->bucket_size[b] = 0;
+    }
+    for (int i = 0; i < point_count; i++)
+    {
+        int bucket = grid->point_bucket[i];
+        grid->point_slot[i] = grid->bucket_start[bucket] + grid->bucket_size[bucket]++;
+        grid->bucket_points[grid->point_slot[i]] = i;
+    }
+
+    return 0;
+}
+
+// The k points nearest to query, skipped excluded (-1: none), nearest first and padded
+// with -1. Searches rings of buckets outwards until no closer point can be left.
+// Returns how many were found.
+static int find_nearest_points(const point_grid_t *grid, point_t query, int skipped, int k, int *nearest)
+{
+    double distance[CELL_ORDER_NEIGHBORS];
+    int found = 0;
+
+    int column;
+    int row;
+    locate_grid_bucket(grid, query, &column, &row);
+    double ring_step = fmin(grid->bucket_width, grid->bucket_height);
+    int max_ring = grid->columns > grid->rows ? grid->columns : grid->rows;
+
+    for (int ring = 0; ring <= max_ring; ring++)
+    {
+        for (int r = row - ring; r <= row + ring; r++)
+        {
+            if (r < 0 || r >= grid->rows)
+                continue;
+
+            // Only the outline of the ring: every column on its top and bottom row, the ends otherwise
+            int column_step = (r == row - ring || r == row + ring) ? 1 : 2 * ring;
+            for (int c = column - ring; c <= column + ring; c += column_step > 0 ? column_step : 1)
+            {
+                if (c < 0 || c >= grid->columns)
+                    continue;
+
+                int bucket = r * grid->columns + c;
+                int end = grid->bucket_start[bucket] + grid->bucket_size[bucket];
+                for (int b = grid->bucket_start[bucket]; b < end; b++)
+                {
+                    int other = grid->bucket_points[b];
+                    if (other == skipped)
+                        continue;
+
+                    double d = point_distance(query, grid->points[other]);
+                    if (found == k && d >= distance[k - 1])
+                        continue;
+
+                    // Insertion into the sorted list
+                    int slot = found < k ? found++ : k - 1;
+                    while (slot > 0 && distance[slot - 1] > d)
+                    {
+                        distance[slot] = distance[slot - 1];
+                        nearest[slot] = nearest[slot - 1];
+                        slot--;
+                    }
+                    distance[slot] = d;
+                    nearest[slot] = other;
+                }
+            }
+        }
+
+        // Points beyond this ring are at least ring * ring_step away
+        if (found == k && distance[k - 1] <= ring * ring_step)
+            break;
+    }
+
+    for (int i = found; i < k; i++)
+    {
+        nearest[i] = -1;
+    }
+    return found;
+}
+
+// Later queries no longer see the point
+static void remove_grid_point(point_grid_t *grid, int point_index)
+{
+    int bucket = grid->point_bucket[point_index];
+    int last_slot = grid->bucket_start[bucket] + --grid->bucket_size[bucket];
+    int moved = grid->bucket_points[last_slot];
+
+    grid->bucket_points[grid->point_slot[point_index]] = moved;
+    grid->point_slot[moved] = grid->point_slot[point_index];
+    grid->bucket_points[last_slot] = point_index;
+    grid->point_slot[point_index] = last_slot;
+}
+
+// Points outside the grid's bounds go to the nearest edge bucket
+static void locate_grid_bucket(const point_grid_t *grid, point_t p, int *column, int *row)
+{
+    float x = (p.x - grid->min_x) / grid->bucket_width;
+    float y = (p.y - grid->min_y) / grid->bucket_height;
+    *column = x <= 0.0f ? 0 : x >= (float)(grid->columns - 1) ? grid->columns - 1 : (int)x;
+    *row = y <= 0.0f ? 0 : y >= (float)(grid->rows - 1) ? grid->rows - 1 : (int)y;
+}
+
+static void free_point_grid(point_grid_t *grid)
+{
+    planning_free(grid->bucket_start);
+    planning_free(grid->bucket_size);
+    planning_free(grid->bucket_points);
+    planning_free(grid->point_bucket);
+    planning_free(grid->point_slot);
+    *grid = (point_grid_t){0};
+}
@@ -0,0 +1,47 @@
+// Sweep order of the cells, chosen for the least non-working travel. Every cell can be
+// swept four ways (bcd_sweep_variant_t), each entering and leaving at different corners,
+// so picking an order plus one variant per cell is a generalized TSP over the transits
+// between consecutive sweeps. It is solved approximately: a nearest-neighbor tour,
+// improved by 2-opt and Or-opt moves between nearby cells, with the variants of the
+// current order re-chosen exactly between rounds. A transit runs through the cells the
+// router (bcd_cell_router_t) picks between the two, and is measured along the shortest
+// line through the boundaries it crosses, the way compute_bcd_motion navigates it.
+
+#ifndef BCD_CELL_ORDERING_H
+#define BCD_CELL_ORDERING_H
+
+#include "../planning_arena.h"
+#include "../../../../dependencies/cvector/cvector.h"
+#include "bcd_cell_computation.h"
+#include "bcd_cell_graph.h"
+
+// Local search stops after this long and keeps the order it has reached. Fields of up
+// to a few hundred cells converge within it, so their results are reproducible; larger
+// ones usually stop at the budget and can come out differently from run to run.
+#ifndef BCD_CELL_ORDER_TIME_BUDGET_MS
+#define BCD_CELL_ORDER_TIME_BUDGET_MS 100
+#endif
+
+typedef struct
+{
+    double transit_length;          // Of the chosen order and sweeps, along the routes between them
+    double initial_transit_length;  // Of path_list as given, every cell swept the default way on its first visit
+} bcd_cell_order_report_t;
+
+// path_list comes in as a visit list covering every cell (compute_bcd_path_list); its
+// first cell stays first, and the result is never worse than its order. It is replaced
+// by the optimized order with the cells of each transit in between, so consecutive
+// visits are neighbors, followed by the route back to the first cell. sweep_order and
+// sweep_variants (one entry per cell) receive the cells in the order to sweep them and
+// the bcd_sweep_variant_t of each cell, for compute_bcd_motion. Returns 0, -1 for
+// invalid input, -2 when out of memory.
+int optimize_bcd_cell_order(const cvector_vector_type(bcd_cell_t) * cell_list,
+                            const bcd_edge_pool_t *edge_pool,
+                            const bcd_cell_graph_t *cell_graph,
+                            float step_size,
+                            cvector_vector_type(int) * path_list,
+                            int *sweep_order,
+                            unsigned char *sweep_variants,
+                            bcd_cell_order_report_t *report);
+
+#endif // BCD_CELL_ORDERING_H
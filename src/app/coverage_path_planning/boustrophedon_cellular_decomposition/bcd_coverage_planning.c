@@ -1,8 +1,12 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <math.h>
+#include "../planning_arena.h"
 #include "../../../../dependencies/cvector/cvector.h"
 #include "bcd_coverage_planning.h"
+#include "../../logger.h"
+
+#define LOG_MODULE LOG_MODULE_BCD
 
 // COMPUTE_BCD_PATH_LIST
 
@@ -14,68 +18,86 @@ static void add_cell_to_path(cvector_vector_type(int) * path_list,
 static bool all_cells_visited(int visited_count, int total_cells);
 
 int find_unvisited_neighbor(int curr_cell_index,
-                            cvector_vector_type(bcd_cell_t) * cell_list);
+                            const cvector_vector_type(bcd_cell_t) * cell_list,
+                            const bcd_cell_graph_t *cell_graph);
 
 static void add_shortest_path_to_list(cvector_vector_type(int) * path_list,
                                       cvector_vector_type(bcd_cell_t) * cell_list,
+                                      bcd_cell_router_t *router,
                                       int target_cell_index,
                                       int *visited_count);
 
-// --- ADD_SHORTEST_PATH_TO_LIST
-
-cvector_vector_type(int) find_shortest_path(int cell_index_from,
-                                            int cell_index_to,
-                                            cvector_vector_type(bcd_cell_t) * cell_list);
-
-// ---
-
-static bool should_backtrack(int *curr_path_index);
-
-
+static void push_new_path_cells(cvector_vector_type(int) * backtrack_stack,
+                                const cvector_vector_type(int) * path_list,
+                                size_t first_new);
 
 // IMPLEMENTATION --- compute_bcd_path_list -------------------------
 
 int compute_bcd_path_list(cvector_vector_type(bcd_cell_t) * cell_list,
+                          const bcd_cell_graph_t *cell_graph,
                           int starting_cell_index,
                           cvector_vector_type(int) * path_list)
 {
-    if (cell_list == NULL || path_list == NULL)
+    if (cell_list == NULL || cell_graph == NULL || path_list == NULL)
     {
-        printf("compute_bcd_path_list: Invalid input parameters\n");
+        LOG_ERROR("compute_bcd_path_list: Invalid input parameters");
         return -1;
     }
 
     int cell_count = cvector_size(*cell_list);
     if (cell_count == 0)
     {
-        printf("compute_bcd_path_list: No cells to process\n");
+        LOG_ERROR("compute_bcd_path_list: No cells to process");
         return 0;
     }
 
+    if (cell_graph->cell_count != cell_count)
+    {
+        LOG_ERROR("compute_bcd_path_list: Cell graph does not match cell list");
+        return -1;
+    }
+
     if (starting_cell_index == -1)
         starting_cell_index = 0;
 
+    bcd_cell_router_t router;
+    if (init_bcd_cell_router(cell_graph, &router) != 0)
+    {
+        LOG_ERROR("compute_bcd_path_list: Out of memory");
+        return -3;
+    }
+
+    // Path cells that may still have unvisited neighbors, most recent on top. Backtracking
+    // pops the exhausted ones for good (visited cells stay visited), instead of rescanning
+    // the path from its end every time.
+    cvector_vector_type(int) backtrack_stack = NULL;
+
     int visited_count = 0;
     bool search_shortest_path = false;
-    int curr_path_index = 0;
+    int rc = 0;
 
     // Initialize with starting cell
     add_cell_to_path(path_list,
                      cell_list,
                      starting_cell_index,
                      &visited_count);
+    cvector_push_back(backtrack_stack, starting_cell_index);
 
     while (!all_cells_visited(visited_count, cell_count))
     {
-        int current_cell = (*path_list)[curr_path_index];
-        int next_cell = find_unvisited_neighbor(current_cell, cell_list);
+        int current_cell = backtrack_stack[cvector_size(backtrack_stack) - 1];
+        int next_cell = find_unvisited_neighbor(current_cell,
+                                                (const cvector_vector_type(bcd_cell_t) *)cell_list,
+                                                cell_graph);
 
         if (next_cell != -1)
         {
+            size_t first_new = cvector_size(*path_list);
             if (search_shortest_path)
             {
                 add_shortest_path_to_list(path_list,
                                           cell_list,
+                                          &router,
                                           next_cell,
                                           &visited_count);
                 search_shortest_path = false;
@@ -88,23 +110,33 @@ int compute_bcd_path_list(cvector_vector_type(bcd_cell_t) * cell_list,
                                  &visited_count);
             }
 
-            curr_path_index = cvector_size(*path_list) - 1;
+            push_new_path_cells(&backtrack_stack, (const cvector_vector_type(int) *)path_list, first_new);
         }
         else
         {
             search_shortest_path = true;
 
-            if (should_backtrack(&curr_path_index))
-                return -2;
+            cvector_pop_back(backtrack_stack);
+            if (cvector_size(backtrack_stack) == 0)
+            {
+                rc = -2;
+                break;
+            }
         }
     }
 
-    add_shortest_path_to_list(path_list,
-                              cell_list,
-                              starting_cell_index,
-                              &visited_count);
+    if (rc == 0)
+    {
+        add_shortest_path_to_list(path_list,
+                                  cell_list,
+                                  &router,
+                                  starting_cell_index,
+                                  &visited_count);
+    }
 
-    return 0;
+    cvector_free(backtrack_stack);
+    free_bcd_cell_router(&router);
+    return rc;
 }
 
 // --- COMPUTE_BCD_PATH_LIST
@@ -124,33 +156,19 @@ static bool all_cells_visited(int visited_count, int total_cells)
     return visited_count == total_cells;
 }
 
+// First unvisited neighbor in adjacency order, or -1
 int find_unvisited_neighbor(int curr_cell_index,
-                            cvector_vector_type(bcd_cell_t) * cell_list)
+                            const cvector_vector_type(bcd_cell_t) * cell_list,
+                            const bcd_cell_graph_t *cell_graph)
 {
-    bcd_neighbor_node_t curr_neighbor_node;
-    int curr_neighbor_index = -1;
+    const int *neighbors = bcd_cell_graph_neighbors(cell_graph, curr_cell_index);
+    int degree = bcd_cell_graph_degree(cell_graph, curr_cell_index);
 
-    if ((*cell_list)[curr_cell_index].neighbor_list.count == 0)
+    for (int i = 0; i < degree; i++)
     {
-        return -1;
-    }
-
-    curr_neighbor_node = *(*cell_list)[curr_cell_index].neighbor_list.head;
-    curr_neighbor_index = curr_neighbor_node.cell_index;
-
-    if ((*cell_list)[curr_neighbor_index].visited == false)
-    {
-        return curr_neighbor_index;
-    }
-
-    for (int i = 1; i < (*cell_list)[curr_cell_index].neighbor_list.count; i++)
-    {
-        curr_neighbor_node = *curr_neighbor_node.next;
-        curr_neighbor_index = curr_neighbor_node.cell_index;
-
-        if ((*cell_list)[curr_neighbor_index].visited == false)
+        if ((*cell_list)[neighbors[i]].visited == false)
         {
-            return curr_neighbor_index;
+            return neighbors[i];
         }
     }
 
@@ -159,160 +177,54 @@ int find_unvisited_neighbor(int curr_cell_index,
 
 static void add_shortest_path_to_list(cvector_vector_type(int) * path_list,
                                       cvector_vector_type(bcd_cell_t) * cell_list,
+                                      bcd_cell_router_t *router,
                                       int target_cell_index,
                                       int *visited_count)
 {
     int last_cell_index = (*path_list)[cvector_size(*path_list) - 1];
-    cvector_vector_type(int) shortest_path = find_shortest_path(last_cell_index, target_cell_index, cell_list);
-
-    // Add intermediate cells from shortest path (skip first and last)
-    for (size_t i = 1; i < cvector_size(shortest_path) - 1; ++i)
-    {
-        cvector_push_back(*path_list, shortest_path[i]);
-    }
 
-    cvector_free(shortest_path);
+    // Intermediate cells of the shortest route by distance, not by cell count: a large
+    // cell on the way costs its width. The target is added (and marked visited) below.
+    bcd_cell_router_append_path(router, last_cell_index, target_cell_index, path_list);
     add_cell_to_path(path_list, cell_list, target_cell_index, visited_count);
 }
 
-// --- --- ADD_SHORTEST_PATH_TO_LIST
-
-cvector_vector_type(int) find_shortest_path(int cell_index_from,
-                                            int cell_index_to,
-                                            cvector_vector_type(bcd_cell_t) * cell_list)
+static void push_new_path_cells(cvector_vector_type(int) * backtrack_stack,
+                                const cvector_vector_type(int) * path_list,
+                                size_t first_new)
 {
-    cvector_vector_type(int) path = NULL;
-
-    if (cell_list == NULL || cell_index_from < 0 || cell_index_to < 0)
-    {
-        return path;
-    }
-
-    int cell_count = cvector_size(*cell_list);
-    if (cell_index_from >= cell_count || cell_index_to >= cell_count)
-    {
-        return path;
-    }
-
-    // If source and destination are the same
-    if (cell_index_from == cell_index_to)
+    for (size_t i = first_new; i < cvector_size(*path_list); i++)
     {
-        cvector_push_back(path, cell_index_from);
-        return path;
+        cvector_push_back(*backtrack_stack, (*path_list)[i]);
     }
-
-    // BFS data structures
-    cvector_vector_type(int) queue = NULL;
-    cvector_vector_type(int) parent = NULL;
-    cvector_vector_type(bool) visited = NULL;
-
-    // Initialize arrays
-    for (int i = 0; i < cell_count; i++)
-    {
-        cvector_push_back(parent, -1);
-        cvector_push_back(visited, false);
-    }
-
-    // Start BFS
-    cvector_push_back(queue, cell_index_from);
-    visited[cell_index_from] = true;
-
-    bool found = false;
-
-    while (cvector_size(queue) > 0 && !found)
-    {
-        int current_cell = queue[0];
-
-        // Remove first element from queue
-        for (int i = 0; i < cvector_size(queue) - 1; i++)
-        {
-            queue[i] = queue[i + 1];
-        }
-        cvector_pop_back(queue);
-
-        // Check all neighbors
-        bcd_neighbor_node_t *neighbor_node = (*cell_list)[current_cell].neighbor_list.head;
-
-        while (neighbor_node != NULL)
-        {
-            int neighbor_index = neighbor_node->cell_index;
-
-            if (!visited[neighbor_index])
-            {
-                visited[neighbor_index] = true;
-                parent[neighbor_index] = current_cell;
-                cvector_push_back(queue, neighbor_index);
-
-                if (neighbor_index == cell_index_to)
-                {
-                    found = true;
-                    break;
-                }
-            }
-
-            neighbor_node = neighbor_node->next;
-        }
-    }
-
-    // Reconstruct path if found
-    if (found)
-    {
-        cvector_vector_type(int) temp_path = NULL;
-        int current = cell_index_to;
-
-        while (current != -1)
-        {
-            cvector_push_back(temp_path, current);
-            current = parent[current];
-        }
-
-        // Reverse the path
-        int path_length = cvector_size(temp_path);
-        for (int i = path_length - 1; i >= 0; i--)
-        {
-            cvector_push_back(path, temp_path[i]);
-        }
-
-        cvector_free(temp_path);
-    }
-
-    // Cleanup
-    cvector_free(queue);
-    cvector_free(parent);
-    cvector_free(visited);
-
-    return path;
-}
-
-// ---
-
-static bool should_backtrack(int *curr_path_index)
-{
-    (*curr_path_index)--;
-    return (*curr_path_index) < 0;
 }
 
 // PATH_LIST HELPERS
 
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_DEBUG
 void log_bcd_path_list(const cvector_vector_type(int) * path_list)
 {
+    if (!LOG_DEBUG_ENABLED())
+        return;
+
     if (path_list == NULL)
     {
-        printf("BCD Path List: NULL\n");
+        LOG_DEBUG("BCD Path List: NULL");
         return;
     }
 
     int path_count = cvector_size(*path_list);
-    printf("BCD Path List (%d cells):\n", path_count);
+    LOG_DEBUG("BCD Path List (%d cells):", path_count);
 
     if (path_count == 0)
     {
-        printf("  (empty)\n");
+        LOG_DEBUG("  (empty)");
         return;
     }
 
     for (int i = 0; i < path_count; i++)
     {
-        printf("  [%d]: Cell %d\n", i, (*path_list)[i]);
+        LOG_DEBUG("  [%d]: Cell %d", i, (*path_list)[i]);
     }
 }
+#endif
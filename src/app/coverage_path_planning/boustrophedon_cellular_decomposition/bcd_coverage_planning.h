@@ -1,13 +1,20 @@
 #ifndef BCD_COVERAGE_H
 #define BCD_COVERAGE_H
 
+#include "../planning_arena.h"
 #include "../../../../dependencies/cvector/cvector.h"
 #include "bcd_cell_computation.h"
+#include "bcd_cell_graph.h"
 
 int compute_bcd_path_list(cvector_vector_type(bcd_cell_t) * cell_list,
+                          const bcd_cell_graph_t *cell_graph,
                           int starting_cell_index,
                           cvector_vector_type(int) * path_list);
 
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_DEBUG
 void log_bcd_path_list(const cvector_vector_type(int) * path_list);
+#else
+#define log_bcd_path_list(...) ((void)0)
+#endif
 
 #endif // BCD_COVERAGE_H
@@ -1,14 +1,33 @@
 #include <stdio.h>
-#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include "../planning_arena.h"
 #include "../../../../dependencies/cvector/cvector.h"
 #include "bcd_event_list_building.h"
+#include "../../worker_pool.h"
+#include "../../logger.h"
 
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
+#define LOG_MODULE LOG_MODULE_BCD
+
+#define EVENT_SORT_RADIX_BITS 8
+#define EVENT_SORT_RADIX_SIZE (1 << EVENT_SORT_RADIX_BITS)
+#define EVENT_SORT_DIGIT_COUNT 4 // Bytes of the x key
+
+#define EVENT_PARALLEL_MIN_POLYGONS 8 // Below this the thread hand-off costs more than the extraction
+
+typedef struct
+{
+    uint32_t key;   // Order-preserving bits of x
+    uint32_t index;
+} bcd_event_sort_entry_t;
+
+typedef struct
+{
+    const input_environment_t *env;
+    bcd_event_list_t *runs;     // One sorted run per polygon: boundary first, then obstacles
+    int *run_rcs;
+} bcd_event_run_batch_t;
 
 // FORWARD DECLARATIONS ---------------------------------------------
 
@@ -17,35 +36,47 @@
 static int preallocate_event_list(const input_environment_t *env,
                                   bcd_event_list_t *event_list);
 
-static int find_polygon_events(const polygon_t polygon,
+static int find_polygon_events(const input_environment_t *env,
+                               uint32_t polygon_id,
                                bcd_event_list_t *event_list);
 
-// --- --- FIND_POLYGON_EVENTS
+// --- BCD_EVENT_STREAM
 
-static int find_leftmost_event(const polygon_t polygon,
-                               bcd_event_list_t *event_list);
+static void build_polygon_event_run(void *ctx,
+                                    int polygon_index);
 
-static int find_common_event(const polygon_t polygon,
-                             bcd_event_list_t *event_list,
-                             int vertex_index);
+static int init_event_stream_heap(bcd_event_stream_t *stream,
+                                  const input_environment_t *env,
+                                  const bcd_event_list_t *runs,
+                                  bcd_event_list_t *owned_runs,
+                                  int run_count);
 
-// --- --- --- FIND_COMMON_EVENT
+static bool event_run_head_less(const bcd_event_stream_t *stream,
+                                int a,
+                                int b);
 
-static bool in_event(polygon_edge_t floor_edge,
-                     polygon_edge_t ceil_edge);
+static void sift_down_event_runs(bcd_event_stream_t *stream,
+                                 int position);
 
-static bool side_in_event(polygon_edge_t floor_edge,
-                          polygon_edge_t ceil_edge);
+// --- --- FIND_POLYGON_EVENTS
 
-static bool out_event(polygon_edge_t floor_edge,
-                      polygon_edge_t ceil_edge);
+static int find_leftmost_event(const input_environment_t *env,
+                               uint32_t polygon_id,
+                               bcd_event_list_t *event_list);
 
-static bool side_out_event(polygon_edge_t floor_edge,
-                           polygon_edge_t ceil_edge);
+static int find_common_event(const input_environment_t *env,
+                             uint32_t polygon_id,
+                             bcd_event_list_t *event_list,
+                             int vertex_index,
+                             bcd_event_type_t *chain_event_type);
+
+// --- --- --- FIND_COMMON_EVENT
 
-static bcd_event_type_t floor_or_ceiling_event(const bcd_event_list_t *event_list);
+static bcd_event_type_t classify_vertex_event(point_t prev,
+                                              point_t vertex,
+                                              point_t next);
 
-static float compute_vector_angle_degrees(polygon_edge_t poly_edge);
+static bcd_event_type_t floor_or_ceiling_event(bcd_event_type_t chain_event_type);
 
 // EVENT LIST HELPERS
 
@@ -55,21 +86,21 @@ static int push_to_bcd_event_list(bcd_event_list_t *event_list,
 static bcd_event_t fill_bcd_event(polygon_type_t polygon_type,
                                   point_t polygon_vertex,
                                   bcd_event_type_t bcd_event_type,
-                                  polygon_edge_t floor_edge,
-                                  polygon_edge_t ceiling_edge);
+                                  polygon_edge_ref_t floor_edge,
+                                  polygon_edge_ref_t ceiling_edge);
 
-static void log_vertex_with_angles(const polygon_t poly,
-                                   point_t v, int f_e_i,
-                                   float floor_angle,
-                                   int c_e_i,
-                                   float ceil_angle);
-
-static void sort_event_list(bcd_event_list_t *event_list);
+static int sort_event_list(bcd_event_list_t *event_list);
 
 // --- --- SORT_EVENT_LIST
 
-static int compare_events(const void *a,
-                          const void *b);
+static uint32_t float_sort_bits(float value);
+
+static uint32_t event_sort_digit(const bcd_event_sort_entry_t *entry,
+                                 int digit);
+
+static bcd_event_sort_entry_t *radix_sort_event_entries(bcd_event_sort_entry_t *entries,
+                                                        bcd_event_sort_entry_t *scratch,
+                                                        int length);
 
 //
 // IMPLEMENTATION --- build_bcd_event_list --------------------------
@@ -85,28 +116,175 @@ int build_bcd_event_list(const input_environment_t *env,
         return -4;
     }
 
-    rc = find_polygon_events(env->boundary, event_list);
+    for (uint32_t polygon_id = 0; polygon_id < environment_polygon_count(env); polygon_id++)
+    {
+        rc = find_polygon_events(env, polygon_id, event_list);
+        if (rc != 0)
+        {
+            return rc;
+        }
+    }
+
+    if (sort_event_list(event_list) != 0)
+    {
+        free_bcd_event_list(event_list);
+        return -4;
+    }
+
+    // --- BUILD_BCD_EVENT_LIST helpers (order per forward declarations)
+
+    return 0;
+}
+
+// Same result as build_bcd_event_list, drained from a bcd_event_stream_t whose
+// per-polygon runs were built on the pool
+int build_bcd_event_list_parallel(const input_environment_t *env,
+                                  bcd_event_list_t *event_list,
+                                  worker_pool_t *pool)
+{
+    if (!pool || (int)environment_polygon_count(env) < EVENT_PARALLEL_MIN_POLYGONS)
+    {
+        return build_bcd_event_list(env, event_list);
+    }
+
+    event_list->env = env;
+    event_list->bcd_events = NULL;
+    event_list->length = 0;
+    event_list->capacity = 0;
+
+    bcd_event_stream_t stream;
+    int rc = open_bcd_event_stream(env, pool, &stream);
     if (rc != 0)
     {
         return rc;
     }
 
-    for (int i = 0; i < env->obstacle_count; i++)
+    if (stream.length > 0)
     {
-        rc = find_polygon_events(env->obstacles[i], event_list);
-        if (rc != 0)
+        event_list->bcd_events = (bcd_event_t *)malloc((size_t)stream.length * sizeof(bcd_event_t));
+        if (!event_list->bcd_events)
         {
-            return rc;
+            close_bcd_event_stream(&stream);
+            return -4;
         }
+        event_list->capacity = stream.length;
     }
 
-    sort_event_list(event_list);
-
-    // --- BUILD_BCD_EVENT_LIST helpers (order per forward declarations)
+    bcd_event_t event;
+    while (next_bcd_event(&stream, &event))
+    {
+        event_list->bcd_events[event_list->length++] = event;
+    }
 
+    close_bcd_event_stream(&stream);
     return 0;
 }
 
+// IMPLEMENTATION --- bcd_event_stream ------------------------------
+
+// Walks and sorts every polygon as its own run (spread over pool when it is worth it).
+// Ties across runs go to the earlier polygon, which is the order the stable sort of
+// build_bcd_event_list produces.
+int open_bcd_event_stream(const input_environment_t *env,
+                          worker_pool_t *pool,
+                          bcd_event_stream_t *stream)
+{
+    *stream = (bcd_event_stream_t){0};
+
+    int run_count = (int)environment_polygon_count(env);
+
+    bcd_event_list_t *runs = (bcd_event_list_t *)calloc((size_t)run_count, sizeof(bcd_event_list_t));
+    int *run_rcs = (int *)calloc((size_t)run_count, sizeof(int));
+    if (!runs || !run_rcs)
+    {
+        free(runs);
+        free(run_rcs);
+        return -4;
+    }
+
+    bcd_event_run_batch_t batch = {env, runs, run_rcs};
+    int rc = 0;
+
+    if (pool && run_count >= EVENT_PARALLEL_MIN_POLYGONS)
+    {
+        rc = worker_pool_parallel_for(pool, run_count, build_polygon_event_run, &batch) == 0 ? 0 : -4;
+    }
+    else
+    {
+        for (int i = 0; i < run_count; i++)
+        {
+            build_polygon_event_run(&batch, i);
+        }
+    }
+
+    // Report the first failing polygon, as the serial walk would
+    for (int i = 0; i < run_count && rc == 0; i++)
+    {
+        rc = run_rcs[i];
+    }
+    free(run_rcs);
+
+    if (rc != 0)
+    {
+        for (int i = 0; i < run_count; i++)
+        {
+            free_bcd_event_list(&runs[i]);
+        }
+        free(runs);
+        return rc;
+    }
+
+    return init_event_stream_heap(stream, env, runs, runs, run_count);
+}
+
+// Streams an already sorted list as a single run; the list must outlive the stream
+int open_bcd_event_list_stream(const bcd_event_list_t *event_list,
+                               bcd_event_stream_t *stream)
+{
+    *stream = (bcd_event_stream_t){0};
+    return init_event_stream_heap(stream, event_list->env, event_list, NULL, 1);
+}
+
+bool next_bcd_event(bcd_event_stream_t *stream,
+                    bcd_event_t *event)
+{
+    if (stream->heap_size == 0)
+        return false;
+
+    int run = stream->heap[0];
+    *event = stream->runs[run].bcd_events[stream->run_heads[run]++];
+
+    if (stream->run_heads[run] == stream->runs[run].length)
+    {
+        stream->heap[0] = stream->heap[--stream->heap_size];
+
+        // A drained run the stream owns is not read again
+        if (stream->owned_runs)
+            free_bcd_event_list(&stream->owned_runs[run]);
+    }
+    sift_down_event_runs(stream, 0);
+
+    return true;
+}
+
+void close_bcd_event_stream(bcd_event_stream_t *stream)
+{
+    if (!stream)
+        return;
+
+    if (stream->owned_runs)
+    {
+        for (int i = 0; i < stream->run_count; i++)
+        {
+            free_bcd_event_list(&stream->owned_runs[i]);
+        }
+        free(stream->owned_runs);
+    }
+    free(stream->run_heads);
+    free(stream->heap);
+    *stream = (bcd_event_stream_t){0};
+}
+
 // --- BUILD_BCD_EVENT_LIST
 
 static int preallocate_event_list(const input_environment_t *env,
@@ -119,6 +297,7 @@ static int preallocate_event_list(const input_environment_t *env,
     }
     if (total < 0)
         total = 0;
+    event_list->env = env;
     event_list->length = 0;
     event_list->capacity = total;
     if (total > 0)
@@ -137,21 +316,27 @@ static int preallocate_event_list(const input_environment_t *env,
     return 0;
 }
 
-static int find_polygon_events(const polygon_t polygon,
+static int find_polygon_events(const input_environment_t *env,
+                               uint32_t polygon_id,
                                bcd_event_list_t *event_list)
 {
-    int leftmost_index = find_leftmost_event(polygon, event_list);
+    const polygon_t *polygon = environment_polygon(env, polygon_id);
+
+    int leftmost_index = find_leftmost_event(env, polygon_id, event_list);
     if (leftmost_index < 0)
     {
         free_bcd_event_list(event_list);
         return leftmost_index;
     }
 
-    for (int i = (leftmost_index + 1) % (int)polygon.vertex_count;
+    // Last IN/OUT-type event of this walk; FLOOR/CEILING follow from it in O(1)
+    bcd_event_type_t chain_event_type = event_list->bcd_events[event_list->length - 1].bcd_event_type;
+
+    for (int i = (leftmost_index + 1) % (int)polygon->vertex_count;
          i != leftmost_index;
-         i = (i + 1) % (int)polygon.vertex_count)
+         i = (i + 1) % (int)polygon->vertex_count)
     {
-        int rc = find_common_event(polygon, event_list, i);
+        int rc = find_common_event(env, polygon_id, event_list, i, &chain_event_type);
         if (rc != 0)
         {
             free_bcd_event_list(event_list);
@@ -162,22 +347,137 @@ static int find_polygon_events(const polygon_t polygon,
     return 0;
 }
 
+// --- BCD_EVENT_STREAM
+
+// May run on a pool worker; touches only its own run and result slot
+static void build_polygon_event_run(void *ctx,
+                                    int polygon_index)
+{
+    bcd_event_run_batch_t *batch = (bcd_event_run_batch_t *)ctx;
+    const polygon_t *polygon = environment_polygon(batch->env, (uint32_t)polygon_index);
+    bcd_event_list_t *run = &batch->runs[polygon_index];
+
+    run->env = batch->env;
+    run->length = 0;
+    run->capacity = (int)polygon->vertex_count;
+    run->bcd_events = run->capacity > 0 ? (bcd_event_t *)malloc((size_t)run->capacity * sizeof(bcd_event_t)) : NULL;
+    if (run->capacity > 0 && !run->bcd_events)
+    {
+        run->capacity = 0;
+        batch->run_rcs[polygon_index] = -4;
+        return;
+    }
+
+    int rc = find_polygon_events(batch->env, (uint32_t)polygon_index, run);
+    if (rc != 0)
+    {
+        batch->run_rcs[polygon_index] = rc;
+        return;
+    }
+
+    if (sort_event_list(run) != 0)
+    {
+        free_bcd_event_list(run);
+        batch->run_rcs[polygon_index] = -4;
+    }
+}
+
+// Takes ownership of owned_runs (if any), also on failure
+static int init_event_stream_heap(bcd_event_stream_t *stream,
+                                  const input_environment_t *env,
+                                  const bcd_event_list_t *runs,
+                                  bcd_event_list_t *owned_runs,
+                                  int run_count)
+{
+    stream->env = env;
+    stream->runs = runs;
+    stream->owned_runs = owned_runs;
+    stream->run_count = run_count;
+    stream->run_heads = (int *)calloc((size_t)run_count, sizeof(int));
+    stream->heap = (int *)malloc((size_t)run_count * sizeof(int));
+    if (!stream->run_heads || !stream->heap)
+    {
+        close_bcd_event_stream(stream);
+        return -4;
+    }
+
+    for (int i = 0; i < run_count; i++)
+    {
+        stream->length += runs[i].length;
+        if (runs[i].length > 0)
+            stream->heap[stream->heap_size++] = i;
+    }
+    for (int position = stream->heap_size / 2 - 1; position >= 0; position--)
+    {
+        sift_down_event_runs(stream, position);
+    }
+
+    return 0;
+}
+
+// Same order as sort_event_list (x only); equal heads go to the earlier polygon, so the
+// merge yields what a stable sort of the runs laid end to end would
+static bool event_run_head_less(const bcd_event_stream_t *stream,
+                                int a,
+                                int b)
+{
+    const bcd_event_t *event_a = &stream->runs[a].bcd_events[stream->run_heads[a]];
+    const bcd_event_t *event_b = &stream->runs[b].bcd_events[stream->run_heads[b]];
+
+    uint32_t xa = float_sort_bits(event_a->polygon_vertex.x);
+    uint32_t xb = float_sort_bits(event_b->polygon_vertex.x);
+    if (xa != xb)
+        return xa < xb;
+
+    return a < b;
+}
+
+static void sift_down_event_runs(bcd_event_stream_t *stream,
+                                 int position)
+{
+    int *heap = stream->heap;
+
+    for (;;)
+    {
+        int smallest = position;
+        int left = 2 * position + 1;
+        int right = left + 1;
+
+        if (left < stream->heap_size && event_run_head_less(stream, heap[left], heap[smallest]))
+            smallest = left;
+        if (right < stream->heap_size && event_run_head_less(stream, heap[right], heap[smallest]))
+            smallest = right;
+
+        if (smallest == position)
+            return;
+
+        int tmp = heap[position];
+        heap[position] = heap[smallest];
+        heap[smallest] = tmp;
+        position = smallest;
+    }
+}
+
 // --- --- FIND_POLYGON_EVENTS
 
-static int find_leftmost_event(const polygon_t polygon,
+static int find_leftmost_event(const input_environment_t *env,
+                               uint32_t polygon_id,
                                bcd_event_list_t *event_list)
 {
-    if (polygon.vertex_count == 0 || polygon.vertices == NULL)
+    const polygon_t *polygon = environment_polygon(env, polygon_id);
+
+    if (polygon->vertex_count == 0)
     {
         return -1;
     }
 
+    const float *xs = env->vertex_pool.x + polygon->first_vertex;
     int leftmost_index = 0;
-    float min_x = polygon.vertices[0].x;
+    float min_x = xs[0];
 
-    for (int i = 1; i < (int)polygon.vertex_count; i++)
+    for (int i = 1; i < (int)polygon->vertex_count; i++)
     {
-        float x = polygon.vertices[i].x;
+        float x = xs[i];
         if (x < min_x)
         {
             min_x = x;
@@ -188,15 +488,15 @@ static int find_leftmost_event(const polygon_t polygon,
     bcd_event_t leftmost_event;
 
     polygon_type_t polygon_type;
-    polygon_type = polygon.winding == POLYGON_WINDING_CW ? BOUNDARY : OBSTACLE;
+    polygon_type = polygon->winding == POLYGON_WINDING_CW ? BOUNDARY : OBSTACLE;
     bcd_event_type_t event_type;
     event_type = polygon_type == BOUNDARY ? SIDE_IN : IN;
 
     leftmost_event = fill_bcd_event(polygon_type,
-                                    polygon.vertices[leftmost_index],
+                                    polygon_vertex(env, polygon, (uint32_t)leftmost_index),
                                     event_type,
-                                    polygon.edges[(leftmost_index + polygon.vertex_count - 1) % polygon.vertex_count],
-                                    polygon.edges[leftmost_index]);
+                                    polygon_edge_ref(polygon_id, (leftmost_index + polygon->vertex_count - 1) % polygon->vertex_count),
+                                    polygon_edge_ref(polygon_id, (uint32_t)leftmost_index));
 
     if (push_to_bcd_event_list(event_list, leftmost_event) != 0)
     {
@@ -206,11 +506,15 @@ static int find_leftmost_event(const polygon_t polygon,
     return leftmost_index;
 }
 
-static int find_common_event(const polygon_t polygon,
+static int find_common_event(const input_environment_t *env,
+                             uint32_t polygon_id,
                              bcd_event_list_t *event_list,
-                             int vertex_index)
+                             int vertex_index,
+                             bcd_event_type_t *chain_event_type)
 {
-    if (polygon.vertex_count == 0 || polygon.vertices == NULL)
+    const polygon_t *polygon = environment_polygon(env, polygon_id);
+
+    if (polygon->vertex_count == 0)
     {
         return -1;
     }
@@ -220,33 +524,28 @@ static int find_common_event(const polygon_t polygon,
     int ceiling_edge_index = -1;
 
     int emanating = vertex_index;
-    int terminating = (vertex_index + polygon.vertex_count - 1) % polygon.vertex_count;
+    int terminating = (vertex_index + polygon->vertex_count - 1) % polygon->vertex_count;
+    int next_index = (vertex_index + 1) % polygon->vertex_count;
 
-    if (in_event(polygon.edges[terminating], polygon.edges[emanating]))
-    {
-        event_type = IN;
-        floor_edge_index = terminating;
-        ceiling_edge_index = emanating;
-    }
-    else if (side_in_event(polygon.edges[terminating], polygon.edges[emanating]))
+    point_t vertex = polygon_vertex(env, polygon, (uint32_t)vertex_index);
+
+    event_type = classify_vertex_event(polygon_vertex(env, polygon, (uint32_t)terminating),
+                                       vertex,
+                                       polygon_vertex(env, polygon, (uint32_t)next_index));
+
+    if (event_type == IN || event_type == SIDE_IN)
     {
-        event_type = SIDE_IN;
         floor_edge_index = terminating;
         ceiling_edge_index = emanating;
+        *chain_event_type = event_type;
     }
-    else if (out_event(polygon.edges[emanating], polygon.edges[terminating]))
-    {
-        event_type = OUT;
-        floor_edge_index = emanating;
-        ceiling_edge_index = terminating;
-    }
-    else if (side_out_event(polygon.edges[emanating], polygon.edges[terminating]))
+    else if (event_type == OUT || event_type == SIDE_OUT)
     {
-        event_type = SIDE_OUT;
         floor_edge_index = emanating;
         ceiling_edge_index = terminating;
+        *chain_event_type = event_type;
     }
-    else if ((event_type = floor_or_ceiling_event(event_list)) != NONE)
+    else if ((event_type = floor_or_ceiling_event(*chain_event_type)) != NONE)
     {
         if (event_type == FLOOR)
         {
@@ -268,13 +567,13 @@ static int find_common_event(const polygon_t polygon,
     bcd_event_t common_event;
 
     polygon_type_t polygon_type;
-    polygon_type = polygon.winding == POLYGON_WINDING_CW ? BOUNDARY : OBSTACLE;
+    polygon_type = polygon->winding == POLYGON_WINDING_CW ? BOUNDARY : OBSTACLE;
 
     common_event = fill_bcd_event(polygon_type,
-                                  polygon.vertices[vertex_index],
+                                  vertex,
                                   event_type,
-                                  floor_edge_index > -1 ? polygon.edges[floor_edge_index] : (polygon_edge_t){0},
-                                  ceiling_edge_index > -1 ? polygon.edges[ceiling_edge_index] : (polygon_edge_t){0});
+                                  floor_edge_index > -1 ? polygon_edge_ref(polygon_id, (uint32_t)floor_edge_index) : POLYGON_EDGE_REF_NONE,
+                                  ceiling_edge_index > -1 ? polygon_edge_ref(polygon_id, (uint32_t)ceiling_edge_index) : POLYGON_EDGE_REF_NONE);
 
     if (push_to_bcd_event_list(event_list, common_event) != 0)
     {
@@ -285,129 +584,56 @@ static int find_common_event(const polygon_t polygon,
 
 // --- --- --- FIND_COMMON_EVENT
 
-static bool in_event(polygon_edge_t floor_edge,
-                     polygon_edge_t ceil_edge)
-{
-    float floor_angle = compute_vector_angle_degrees(floor_edge);
-    float ceil_angle = compute_vector_angle_degrees(ceil_edge);
-
-    if (90.0f < floor_angle && floor_angle <= 180.0f)
-    {
-        float min_ceil_angle = floor_angle + 180.0f;
-        return ((0.0f <= ceil_angle && ceil_angle < 90.0f) ||
-                (min_ceil_angle < ceil_angle && ceil_angle <= 360.0f));
-    }
-    else if (180.0f < floor_angle && floor_angle < 270.0f)
-    {
-        float min_ceil_angle = floor_angle - 180.0f;
-        return (min_ceil_angle < ceil_angle && ceil_angle < 90.0f);
-    }
-
-    return false;
-}
-
-static bool side_in_event(polygon_edge_t floor_edge,
-                          polygon_edge_t ceil_edge)
+// Classifies a vertex from its neighbours along the polygon using exact orientation tests only.
+// IN/SIDE_IN: the boundary arrives moving left and leaves moving right,
+// OUT/SIDE_OUT: arrives moving right and leaves moving left; the turn direction
+// tells whether the interior lies on the opening/closing side. Anything else is
+// left to floor_or_ceiling_event.
+static bcd_event_type_t classify_vertex_event(point_t prev,
+                                              point_t vertex,
+                                              point_t next)
 {
-    float floor_angle = compute_vector_angle_degrees(floor_edge);
-    float ceil_angle = compute_vector_angle_degrees(ceil_edge);
-
-    if (90.0f < floor_angle && floor_angle <= 180.0f)
-    {
-        float max_ceil_angle = floor_angle + 180.0f;
-        return (270.0f <= ceil_angle && ceil_angle < max_ceil_angle);
-    }
-    if (180.0f <= floor_angle && floor_angle < 270.0f)
+    if (vertex.x < prev.x)
     {
-        float max_ceil_angle = floor_angle - 180.0f;
-        return ((0.0f <= ceil_angle && ceil_angle < max_ceil_angle) ||
-                (270.0f < ceil_angle && ceil_angle <= 360.0f));
-    }
-
-    return false;
-}
-
-static bool out_event(polygon_edge_t floor_edge,
-                      polygon_edge_t ceil_edge)
-{
-    float floor_angle = compute_vector_angle_degrees(floor_edge);
-    float ceil_angle = compute_vector_angle_degrees(ceil_edge);
-
-    if (0.0f <= ceil_angle && ceil_angle < 90.0f)
-    {
-        float min_floor_angle = ceil_angle + 180.0f;
-        return (min_floor_angle < floor_angle && floor_angle < 270.0f);
-    }
-
-    if (270.0f < ceil_angle && ceil_angle <= 360.0f)
-    {
-        float min_floor_angle = ceil_angle - 180.0f;
-        return (min_floor_angle < floor_angle && floor_angle < 270.0f);
-    }
-
-    return false;
-}
+        if (next.x > vertex.x)
+        {
+            int turn = point_orientation(prev, vertex, next);
+            if (turn < 0)
+                return IN;
+            if (turn > 0)
+                return SIDE_IN;
+            return NONE;
+        }
 
-static bool side_out_event(polygon_edge_t floor_edge,
-                           polygon_edge_t ceil_edge)
-{
-    float floor_angle = compute_vector_angle_degrees(floor_edge);
-    float ceil_angle = compute_vector_angle_degrees(ceil_edge);
+        // Leaving straight down still opens a cell, unless the boundary arrived from above
+        if (next.x == vertex.x && next.y < vertex.y && vertex.y >= prev.y)
+            return SIDE_IN;
 
-    if (0.0f <= ceil_angle && ceil_angle < 90.0f)
-    {
-        float max_floor_angle = ceil_angle + 180.0f;
-        return (90.0f < floor_angle && floor_angle < max_floor_angle);
+        return NONE;
     }
 
-    // Fix chained comparison: use logical AND
-    if (270.0f < ceil_angle && ceil_angle <= 360.0f)
+    if (vertex.x > prev.x && next.x < vertex.x)
     {
-        float max_floor_angle = ceil_angle - 180.0f;
-        return (90.0f < floor_angle && floor_angle < max_floor_angle);
-    }
-
-    return false;
-}
-
-static bcd_event_type_t floor_or_ceiling_event(const bcd_event_list_t *event_list)
-{
-    for (int i = event_list->length - 1; i >= 0; i--)
-    {
-        bcd_event_type_t prev_event = event_list->bcd_events[i].bcd_event_type;
-
-        if (prev_event == B_INIT || prev_event == B_IN || prev_event == B_SIDE_IN || prev_event == IN || prev_event == SIDE_IN)
-            return CEILING;
-
-        if (prev_event == B_DEINIT || prev_event == B_OUT || prev_event == B_SIDE_OUT || prev_event == OUT || prev_event == SIDE_OUT)
-            return FLOOR;
+        int turn = point_orientation(prev, vertex, next);
+        if (turn < 0)
+            return OUT;
+        if (turn > 0)
+            return SIDE_OUT;
     }
 
     return NONE;
 }
 
-static float compute_vector_angle_degrees(polygon_edge_t poly_edge)
+// After an IN-type event the walk follows a ceiling chain, after an OUT-type event a floor chain
+static bcd_event_type_t floor_or_ceiling_event(bcd_event_type_t chain_event_type)
 {
-    point_t begin = poly_edge.begin;
-    point_t end = poly_edge.end;
-
-    float dx = end.x - begin.x;
-    float dy = end.y - begin.y;
-
-    float angle_radians = atan2(dy, dx);
+    if (chain_event_type == B_INIT || chain_event_type == B_IN || chain_event_type == B_SIDE_IN || chain_event_type == IN || chain_event_type == SIDE_IN)
+        return CEILING;
 
-    // Convert to degrees and normalize to [0, 360)
-    float angle_degrees = angle_radians * 180.0f / M_PI;
+    if (chain_event_type == B_DEINIT || chain_event_type == B_OUT || chain_event_type == B_SIDE_OUT || chain_event_type == OUT || chain_event_type == SIDE_OUT)
+        return FLOOR;
 
-    while (angle_degrees < 0.0f)
-    {
-        angle_degrees += 360.0f;
-    }
-    while (angle_degrees >= 360.0f)
-    {
-        angle_degrees -= 360.0f;
-    }
-    return angle_degrees;
+    return NONE;
 }
 
 // EVENT LIST HELPERS
@@ -427,8 +653,8 @@ static int push_to_bcd_event_list(bcd_event_list_t *event_list,
 static bcd_event_t fill_bcd_event(polygon_type_t polygon_type,
                                   point_t polygon_vertex,
                                   bcd_event_type_t bcd_event_type,
-                                  polygon_edge_t floor_edge,
-                                  polygon_edge_t ceiling_edge)
+                                  polygon_edge_ref_t floor_edge,
+                                  polygon_edge_ref_t ceiling_edge)
 {
     bcd_event_t bcd_event;
     bcd_event.polygon_type = polygon_type;
@@ -439,42 +665,112 @@ static bcd_event_t fill_bcd_event(polygon_type_t polygon_type,
     return bcd_event;
 }
 
-static void sort_event_list(bcd_event_list_t *event_list)
+// Sorts by x only and keeps events with equal x in walk order: at a vertical edge the
+// event that opens the cell precedes the FLOOR/CEILING that continues it, whatever
+// their y. The records are not compared or moved while sorting: a compact
+// (key, index) array is LSD radix sorted (stable) and the events are gathered into
+// their final order once.
+static int sort_event_list(bcd_event_list_t *event_list)
 {
     if (!event_list || event_list->length <= 1)
-        return;
+        return 0;
+
+    int length = event_list->length;
+
+    bcd_event_sort_entry_t *entries = (bcd_event_sort_entry_t *)malloc(2 * (size_t)length * sizeof(bcd_event_sort_entry_t));
+    bcd_event_t *sorted_events = (bcd_event_t *)malloc((size_t)event_list->capacity * sizeof(bcd_event_t));
+    if (!entries || !sorted_events)
+    {
+        free(entries);
+        free(sorted_events);
+        return -1;
+    }
+
+    for (int i = 0; i < length; i++)
+    {
+        const bcd_event_t *event = &event_list->bcd_events[i];
+        entries[i].key = float_sort_bits(event->polygon_vertex.x);
+        entries[i].index = (uint32_t)i;
+    }
 
-    qsort(event_list->bcd_events, event_list->length, sizeof(bcd_event_t), compare_events);
+    const bcd_event_sort_entry_t *order = radix_sort_event_entries(entries, entries + length, length);
+
+    for (int i = 0; i < length; i++)
+    {
+        sorted_events[i] = event_list->bcd_events[order[i].index];
+    }
+
+    free(entries);
+    free(event_list->bcd_events);
+    event_list->bcd_events = sorted_events;
+    return 0;
 }
 
 // --- --- SORT_EVENT_LIST
 
-static int compare_events(const void *a,
-                          const void *b)
+// Maps a float to an unsigned key with the same ordering (-0.0f folded into 0.0f)
+static uint32_t float_sort_bits(float value)
 {
-    const bcd_event_t *event_a = (const bcd_event_t *)a;
-    const bcd_event_t *event_b = (const bcd_event_t *)b;
+    value += 0.0f;
 
-    if (event_a->polygon_vertex.x < event_b->polygon_vertex.x)
-        return -1;
-    else if (event_a->polygon_vertex.x > event_b->polygon_vertex.x)
-        return 1;
-    else
-        return 0;
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
 }
 
-// log_vertex_with_angles(poly, poly.vertices[vertex_index], floor_edge_index, floor_angle, ceiling_edge_index, ceil_angle);
-static void log_vertex_with_angles(const polygon_t poly,
-                                   point_t v,
-                                   int f_e_i,
-                                   float floor_angle,
-                                   int c_e_i,
-                                   float ceil_angle)
+// Digit 0 is the least significant byte of x, digit 3 the top byte
+static uint32_t event_sort_digit(const bcd_event_sort_entry_t *entry,
+                                 int digit)
 {
-    printf("BCD debug: vertex=(%.3f, %.3f)\n          f_e_b=(%.3f, %.3f), f_e_e=(%.3f, %.3f), f_a=%.2f deg,\n          c_e_b=(%.3f, %.3f), c_e_e=(%.3f, %.3f), c_a=%.2f deg\n",
-           v.x, v.y,
-           poly.edges[f_e_i].begin.x, poly.edges[f_e_i].begin.y, poly.edges[f_e_i].end.x, poly.edges[f_e_i].end.y, floor_angle,
-           poly.edges[c_e_i].begin.x, poly.edges[c_e_i].begin.y, poly.edges[c_e_i].end.x, poly.edges[c_e_i].end.y, ceil_angle);
+    return (entry->key >> (digit * EVENT_SORT_RADIX_BITS)) & (EVENT_SORT_RADIX_SIZE - 1);
+}
+
+// Stable LSD passes, least significant digit first; a pass is skipped when every
+// entry shares the same digit. Returns whichever buffer holds the sorted entries.
+static bcd_event_sort_entry_t *radix_sort_event_entries(bcd_event_sort_entry_t *entries,
+                                                        bcd_event_sort_entry_t *scratch,
+                                                        int length)
+{
+    uint32_t counts[EVENT_SORT_DIGIT_COUNT][EVENT_SORT_RADIX_SIZE];
+    memset(counts, 0, sizeof(counts));
+
+    for (int i = 0; i < length; i++)
+    {
+        for (int digit = 0; digit < EVENT_SORT_DIGIT_COUNT; digit++)
+        {
+            counts[digit][event_sort_digit(&entries[i], digit)]++;
+        }
+    }
+
+    bcd_event_sort_entry_t *src = entries;
+    bcd_event_sort_entry_t *dst = scratch;
+
+    for (int digit = 0; digit < EVENT_SORT_DIGIT_COUNT; digit++)
+    {
+        uint32_t *count = counts[digit];
+
+        if (count[event_sort_digit(&src[0], digit)] == (uint32_t)length)
+            continue;
+
+        uint32_t offset = 0;
+        for (int bucket = 0; bucket < EVENT_SORT_RADIX_SIZE; bucket++)
+        {
+            uint32_t bucket_count = count[bucket];
+            count[bucket] = offset;
+            offset += bucket_count;
+        }
+
+        for (int i = 0; i < length; i++)
+        {
+            dst[count[event_sort_digit(&src[i], digit)]++] = src[i];
+        }
+
+        bcd_event_sort_entry_t *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    return src;
 }
 
 void free_bcd_event_list(bcd_event_list_t *event_list)
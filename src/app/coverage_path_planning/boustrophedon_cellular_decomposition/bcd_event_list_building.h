@@ -4,8 +4,10 @@
 #define BOUSTROPHEDON_CELLULAR_DECOMPOSITION_H
 
 #include <stdbool.h>
+#include "../planning_arena.h"
 #include "../../../../dependencies/cvector/cvector.h"
 #include "../coverage_path_planning.h"
+#include "../../worker_pool.h"
 
 typedef enum {
     B_IN,
@@ -32,24 +34,63 @@ typedef struct {
     polygon_type_t polygon_type;
     point_t polygon_vertex;
     bcd_event_type_t bcd_event_type;
-    polygon_edge_t floor_edge;          // If IN: edge terminating at the event
+    polygon_edge_ref_t floor_edge;      // If IN: edge terminating at the event
                                         // IF OUT: edge emanating from the event
                                         // IF FLOOR: edge terminating at the event
     
-    polygon_edge_t ceiling_edge;        // IF IN: edge emanating from the event 
+    polygon_edge_ref_t ceiling_edge;    // IF IN: edge emanating from the event 
                                         // IF OUT: edge terminating at the event
                                         // IF CEILING: edge emanating from the event
 } bcd_event_t;
 
 typedef struct {
+    const input_environment_t *env;     // Edge references resolve against this environment's vertex pool
     bcd_event_t *bcd_events;
     int length;
     int capacity;
 } bcd_event_list_t;
 
+// Pull-based event source in sweep order, the order build_bcd_event_list produces.
+// Each run is sorted on its own and only the run heads are merged, one event per
+// next_bcd_event call; the merged event array is never built.
+typedef struct {
+    const input_environment_t *env;
+    const bcd_event_list_t *runs;       // One sorted run per polygon, or a single borrowed list
+    bcd_event_list_t *owned_runs;       // Freed by close_bcd_event_stream; NULL when borrowed
+    int run_count;
+    int *run_heads;                     // Next unread event of each run
+    int *heap;                          // Runs with events left, min-heap on their head event
+    int heap_size;
+    int length;                         // Total number of events the stream yields
+} bcd_event_stream_t;
+
+// Events sorted by x only. Equal x keep polygon order (boundary first) and, within a
+// polygon, walk order, which the sweep relies on at vertical edges.
 int build_bcd_event_list(const input_environment_t *env, 
                          bcd_event_list_t *event_list);
 
+// Same output as build_bcd_event_list, with the per-polygon work spread over pool.
+// Small environments (or pool == NULL) take the serial path.
+int build_bcd_event_list_parallel(const input_environment_t *env,
+                                  bcd_event_list_t *event_list,
+                                  worker_pool_t *pool);
+
+// Extracts and sorts every polygon as its own run (on pool when given and worthwhile).
+// Returns the same codes as build_bcd_event_list.
+int open_bcd_event_stream(const input_environment_t *env,
+                          worker_pool_t *pool,
+                          bcd_event_stream_t *stream);
+
+// Streams an already built (sorted) list; the list must outlive the stream.
+int open_bcd_event_list_stream(const bcd_event_list_t *event_list,
+                               bcd_event_stream_t *stream);
+
+// Copies the next event in sweep order into event; false once the stream is exhausted.
+bool next_bcd_event(bcd_event_stream_t *stream,
+                    bcd_event_t *event);
+
+void close_bcd_event_stream(bcd_event_stream_t *stream);
+
 void free_bcd_event_list(bcd_event_list_t *event_list);
 
 #endif // BOUSTROPHEDON_CELLULAR_DECOMPOSITION_H
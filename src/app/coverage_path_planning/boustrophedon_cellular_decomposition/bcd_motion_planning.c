@@ -1,20 +1,30 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <math.h>
+#include "../planning_arena.h"
 #include "../../../../dependencies/cvector/cvector.h"
 
 #include "coverage_path_planning.h"
 #include "bcd_cell_computation.h"
 #include "bcd_motion_planning.h"
+#include "../../logger.h"
+
+#define LOG_MODULE LOG_MODULE_BCD
 
 // --- COMPUTE_BCD_MOTION
 
 static cvector_vector_type(point_t) compute_boustrophedon_motion(const cvector_vector_type(bcd_cell_t) * cell_list,
+                                                                 const bcd_edge_pool_t *edge_pool,
                                                                  int cell_index,
+                                                                 int sweep_variant,
                                                                  float step_size);
 
 // --- --- COMPUTE_BOUSTROPHEDON_MOTION
 
+static int sweep_line_count(const bcd_cell_t *cell, float step_size);
+static float sweep_line_x(const bcd_cell_t *cell, int line_index, float step_size);
+static void reverse_points(cvector_vector_type(point_t) points);
+
 static int find_intersecting_edge_index(float x,
                                         const polygon_edge_t *edge_list,
                                         int edge_count);
@@ -49,23 +59,27 @@ static void add_edge_transition_path(cvector_vector_type(point_t) * path,
 
 static cvector_vector_type(point_t) compute_connection_motion(const cvector_vector_type(bcd_cell_t) * cell_list,
                                                               const cvector_vector_type(int) * path_list,
-                                                              int begin_cell_index,
+                                                              size_t begin_visit,
                                                               point_t begin_point,
-                                                              int end_cell_index,
+                                                              size_t end_visit,
                                                               point_t end_point);
 
 // IMPLEMENTATION --- compute_bcd_motion ----------------------------
 
 int compute_bcd_motion(cvector_vector_type(bcd_cell_t) * cell_list,
+                       const bcd_edge_pool_t *edge_pool,
                        const cvector_vector_type(int) * path_list,
+                       const int *sweep_order,
+                       const unsigned char *sweep_variants,
                        bcd_motion_plan_t *motion_plan,
                        float step_size)
 {
-    int begin_cell_index;
+    size_t begin_visit = 0;
     point_t begin_point = {0};
-    int end_cell_index;
     point_t end_point = {0};
     bool compute_nav = false;
+    size_t cell_count = cvector_size(*cell_list);
+    size_t next_sweep = 0;
 
     size_t i;
     for (i = 0; i < cvector_size(*path_list); ++i)
@@ -74,10 +88,18 @@ int compute_bcd_motion(cvector_vector_type(bcd_cell_t) * cell_list,
         {
             continue;
         }
+        // Cells only driven through on the way to the next one in the sweep order
+        if (sweep_order && (next_sweep >= cell_count || (*path_list)[i] != sweep_order[next_sweep]))
+        {
+            continue;
+        }
+        next_sweep++;
 
         cvector_vector_type(point_t) ox = NULL;
         ox = compute_boustrophedon_motion((const cvector_vector_type(bcd_cell_t) *)cell_list,
+                                          edge_pool,
                                           (*path_list)[i],
+                                          sweep_variants ? sweep_variants[(*path_list)[i]] : BCD_SWEEP_DEFAULT,
                                           step_size);
         if (ox == NULL)
         {
@@ -86,28 +108,29 @@ int compute_bcd_motion(cvector_vector_type(bcd_cell_t) * cell_list,
 
         cvector_vector_type(point_t) nav = NULL;
 
-        if (compute_nav)
+        // Navigation is only planned along a sweep order; sections in plain path_list
+        // order keep none
+        if (compute_nav && sweep_order)
         {
-            end_cell_index = (*path_list)[i];
             end_point = *cvector_front(ox);
 
             nav = compute_connection_motion((const cvector_vector_type(bcd_cell_t) *)cell_list,
-                                            (const cvector_vector_type(int) *)path_list,
-                                            begin_cell_index,
+                                            path_list,
+                                            begin_visit,
                                             begin_point,
-                                            end_cell_index,
+                                            i,
                                             end_point);
         }
 
         cell_motion_plan_t curr_section;
         curr_section.ox = ox;
-        curr_section.nav = nav; // Navigation not implemented yet
+        curr_section.nav = nav;
 
         cvector_push_back(motion_plan->section, curr_section);
 
         (*cell_list)[(*path_list)[i]].cleaned = true;
 
-        begin_cell_index = (*path_list)[i];
+        begin_visit = i;
         begin_point = *cvector_back(ox);
         compute_nav = true;
     }
@@ -115,10 +138,63 @@ int compute_bcd_motion(cvector_vector_type(bcd_cell_t) * cell_list,
     return 0;
 }
 
+int compute_bcd_sweep_endpoints(const bcd_cell_t *cell,
+                                const bcd_edge_pool_t *edge_pool,
+                                int sweep_variant,
+                                float step_size,
+                                point_t *entry,
+                                point_t *exit)
+{
+    int num_lines = sweep_line_count(cell, step_size);
+    if (num_lines == 0)
+        return -1;
+
+    const polygon_edge_t *ceiling_edges = bcd_edge_chain_begin(edge_pool, cell->ceiling_edges);
+    const polygon_edge_t *floor_edges = bcd_edge_chain_begin(edge_pool, cell->floor_edges);
+
+    // Same points compute_boustrophedon_motion starts and ends on: the first line leaves
+    // the ceiling when going down, and lines alternate from there
+    bool first_down = !(sweep_variant & BCD_SWEEP_UP);
+    bool last_down = first_down == ((num_lines - 1) % 2 == 0);
+    float first_x = sweep_line_x(cell, 0, step_size);
+    float last_x = sweep_line_x(cell, num_lines - 1, step_size);
+
+    point_t first = first_down ? find_intersection_point(first_x, ceiling_edges, cell->ceiling_edges.count)
+                               : find_intersection_point(first_x, floor_edges, cell->floor_edges.count);
+    point_t last = last_down ? find_intersection_point(last_x, floor_edges, cell->floor_edges.count)
+                             : find_intersection_point(last_x, ceiling_edges, cell->ceiling_edges.count);
+
+    *entry = (sweep_variant & BCD_SWEEP_REVERSED) ? last : first;
+    *exit = (sweep_variant & BCD_SWEEP_REVERSED) ? first : last;
+    return 0;
+}
+
+double bcd_motion_transit_length(const bcd_motion_plan_t *motion_plan)
+{
+    double length = 0.0;
+    int section_count = motion_plan->section ? (int)cvector_size(motion_plan->section) : 0;
+
+    for (int i = 1; i < section_count; i++)
+    {
+        const cell_motion_plan_t *section = &motion_plan->section[i];
+        point_t from = *cvector_back(motion_plan->section[i - 1].ox);
+        for (size_t k = 0; section->nav && k < cvector_size(section->nav); k++)
+        {
+            length += hypot((double)section->nav[k].x - from.x, (double)section->nav[k].y - from.y);
+            from = section->nav[k];
+        }
+        point_t to = *cvector_front(section->ox);
+        length += hypot((double)to.x - from.x, (double)to.y - from.y);
+    }
+    return length;
+}
+
 // --- COMPUTE_BCD_MOTION
 
 static cvector_vector_type(point_t) compute_boustrophedon_motion(const cvector_vector_type(bcd_cell_t) * cell_list,
+                                                                 const bcd_edge_pool_t *edge_pool,
                                                                  int cell_index,
+                                                                 int sweep_variant,
                                                                  float step_size) // the distance between two parallel line segments
 {
     cvector_vector_type(point_t) ox = NULL;
@@ -130,57 +206,45 @@ static cvector_vector_type(point_t) compute_boustrophedon_motion(const cvector_v
 
     const bcd_cell_t *cell = &(*cell_list)[cell_index];
 
-    // Get cell boundaries
-    point_t ceiling_start = cell->c_begin;
-    point_t ceiling_end = cell->c_end;
-    point_t floor_start = cell->f_begin;
-    point_t floor_end = cell->f_end;
+    // Both chains are contiguous runs of the frozen edge pool
+    const polygon_edge_t *ceiling_edges = bcd_edge_chain_begin(edge_pool, cell->ceiling_edges);
+    int ceiling_edge_count = cell->ceiling_edges.count;
+    const polygon_edge_t *floor_edges = bcd_edge_chain_begin(edge_pool, cell->floor_edges);
+    int floor_edge_count = cell->floor_edges.count;
 
-    // Calculate the sweep direction (perpendicular to the cell)
-    // Assuming cells are oriented vertically, sweep horizontally
-    float cell_width = ceiling_end.x - ceiling_start.x;
-
-    if (cell_width <= 0 || step_size <= 0)
+    // Cells are oriented vertically, so sweep lines are vertical and advance left to right
+    int num_lines = sweep_line_count(cell, step_size);
+    if (num_lines == 0)
     {
         return ox;
     }
 
-    // Calculate number of sweep lines
-    int num_lines = (int)(cell_width / step_size) + 1;
-
     // Generate boustrophedon pattern as a continuous path
-    bool going_down = true; // Start by going from ceiling to floor
+    bool going_down = !(sweep_variant & BCD_SWEEP_UP); // By default start from ceiling to floor
     int last_ceiling_edge_index = -1;
     int last_floor_edge_index = -1;
 
     for (int i = 0; i < num_lines; i++)
     {
-        float x_offset = i * step_size;
-        float current_x = ceiling_start.x + x_offset;
-
-        // Don't exceed the cell boundary
-        if (current_x > ceiling_end.x)
-        {
-            current_x = ceiling_end.x;
-        }
+        float current_x = sweep_line_x(cell, i, step_size);
 
         // Find which edges we're intersecting with
-        int current_ceiling_edge_index = find_intersecting_edge_index(current_x, cell->ceiling_edge_list, cvector_size(cell->ceiling_edge_list));
-        int current_floor_edge_index = find_intersecting_edge_index(current_x, cell->floor_edge_list, cvector_size(cell->floor_edge_list));
+        int current_ceiling_edge_index = find_intersecting_edge_index(current_x, ceiling_edges, ceiling_edge_count);
+        int current_floor_edge_index = find_intersecting_edge_index(current_x, floor_edges, floor_edge_count);
 
         point_t start_point, end_point;
 
         if (going_down)
         {
             // Going from ceiling to floor
-            start_point = find_intersection_point(current_x, cell->ceiling_edge_list, cvector_size(cell->ceiling_edge_list));
-            end_point = find_intersection_point(current_x, cell->floor_edge_list, cvector_size(cell->floor_edge_list));
+            start_point = find_intersection_point(current_x, ceiling_edges, ceiling_edge_count);
+            end_point = find_intersection_point(current_x, floor_edges, floor_edge_count);
         }
         else
         {
             // Going from floor to ceiling
-            start_point = find_intersection_point(current_x, cell->floor_edge_list, cvector_size(cell->floor_edge_list));
-            end_point = find_intersection_point(current_x, cell->ceiling_edge_list, cvector_size(cell->ceiling_edge_list));
+            start_point = find_intersection_point(current_x, floor_edges, floor_edge_count);
+            end_point = find_intersection_point(current_x, ceiling_edges, ceiling_edge_count);
         }
 
         // For the first line, add the start point
@@ -196,18 +260,11 @@ static cvector_vector_type(point_t) compute_boustrophedon_motion(const cvector_v
         if (i < num_lines - 1)
         {
             // Calculate the next line position
-            float next_x_offset = (i + 1) * step_size;
-            float next_x = ceiling_start.x + next_x_offset;
-
-            // Don't exceed the cell boundary
-            if (next_x > ceiling_end.x)
-            {
-                next_x = ceiling_end.x;
-            }
+            float next_x = sweep_line_x(cell, i + 1, step_size);
 
             // Find which edges the next line will intersect with
-            int next_ceiling_edge_index = find_intersecting_edge_index(next_x, cell->ceiling_edge_list, cvector_size(cell->ceiling_edge_list));
-            int next_floor_edge_index = find_intersecting_edge_index(next_x, cell->floor_edge_list, cvector_size(cell->floor_edge_list));
+            int next_ceiling_edge_index = find_intersecting_edge_index(next_x, ceiling_edges, ceiling_edge_count);
+            int next_floor_edge_index = find_intersecting_edge_index(next_x, floor_edges, floor_edge_count);
 
             // Determine which boundary we need to follow for transition
             if (going_down)
@@ -218,7 +275,7 @@ static cvector_vector_type(point_t) compute_boustrophedon_motion(const cvector_v
                     current_floor_edge_index != next_floor_edge_index)
                 {
                     // Add transition path following floor boundary
-                    add_edge_transition_path(&ox, cell->floor_edge_list, cvector_size(cell->floor_edge_list),
+                    add_edge_transition_path(&ox, floor_edges, floor_edge_count,
                                              current_floor_edge_index, next_floor_edge_index, current_x, next_x);
                 }
             }
@@ -230,7 +287,7 @@ static cvector_vector_type(point_t) compute_boustrophedon_motion(const cvector_v
                     current_ceiling_edge_index != next_ceiling_edge_index)
                 {
                     // Add transition path following ceiling boundary
-                    add_edge_transition_path(&ox, cell->ceiling_edge_list, cvector_size(cell->ceiling_edge_list),
+                    add_edge_transition_path(&ox, ceiling_edges, ceiling_edge_count,
                                              current_ceiling_edge_index, next_ceiling_edge_index, current_x, next_x);
                 }
             }
@@ -239,11 +296,11 @@ static cvector_vector_type(point_t) compute_boustrophedon_motion(const cvector_v
             point_t next_start;
             if (!going_down) // Next line will go down (ceiling to floor)
             {
-                next_start = find_intersection_point(next_x, cell->ceiling_edge_list, cvector_size(cell->ceiling_edge_list));
+                next_start = find_intersection_point(next_x, ceiling_edges, ceiling_edge_count);
             }
             else // Next line will go up (floor to ceiling)
             {
-                next_start = find_intersection_point(next_x, cell->floor_edge_list, cvector_size(cell->floor_edge_list));
+                next_start = find_intersection_point(next_x, floor_edges, floor_edge_count);
             }
 
             // Add the start point of next line
@@ -258,11 +315,43 @@ static cvector_vector_type(point_t) compute_boustrophedon_motion(const cvector_v
         going_down = !going_down;
     }
 
+    if (sweep_variant & BCD_SWEEP_REVERSED)
+        reverse_points(ox);
+
     return ox;
 }
 
 // --- --- COMPUTE_BOUSTROPHEDON_MOTION
 
+// Vertical sweep lines across the cell, step_size apart; 0 if it cannot be swept
+static int sweep_line_count(const bcd_cell_t *cell, float step_size)
+{
+    float cell_width = cell->c_end.x - cell->c_begin.x;
+    if (cell_width <= 0 || step_size <= 0)
+        return 0;
+
+    return (int)(cell_width / step_size) + 1;
+}
+
+// The last line is pulled in to the cell's right edge
+static float sweep_line_x(const bcd_cell_t *cell, int line_index, float step_size)
+{
+    float x_offset = line_index * step_size;
+    float x = cell->c_begin.x + x_offset;
+    return x > cell->c_end.x ? cell->c_end.x : x;
+}
+
+static void reverse_points(cvector_vector_type(point_t) points)
+{
+    size_t count = cvector_size(points);
+    for (size_t i = 0; i < count / 2; i++)
+    {
+        point_t tmp = points[i];
+        points[i] = points[count - 1 - i];
+        points[count - 1 - i] = tmp;
+    }
+}
+
 static int find_intersecting_edge_index(float x, const polygon_edge_t *edge_list, int edge_count)
 {
     if (edge_list == NULL || edge_count == 0)
@@ -405,104 +494,115 @@ static void add_edge_transition_path(cvector_vector_type(point_t) * path,
 
 // --- --- COMPUTE_BOUSTROPHEDON_MOTION
 
+// The shortest way from begin_point to end_point through the cells visited from
+// begin_visit to end_visit, both points included
 static cvector_vector_type(point_t) compute_connection_motion(const cvector_vector_type(bcd_cell_t) * cell_list,
                                                               const cvector_vector_type(int) * path_list,
-                                                              int begin_cell_index,
+                                                              size_t begin_visit,
                                                               point_t begin_point,
-                                                              int end_cell_index,
+                                                              size_t end_visit,
                                                               point_t end_point)
 {
-    return NULL;
+    cvector_vector_type(point_t) nav = NULL;
+    cvector_push_back(nav, begin_point);
+    trace_bcd_cell_corridor(cell_list,
+                            *path_list + begin_visit,
+                            (int)(end_visit - begin_visit + 1),
+                            begin_point,
+                            end_point,
+                            &nav);
+    cvector_push_back(nav, end_point);
+    return nav;
 }
 
 // MOTION_PLAN HELPERS
 
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_DEBUG
 void log_bcd_motion(const bcd_motion_plan_t motion_plan)
 {
-    printf("BCD Motion Plan:\n");
+    if (!LOG_DEBUG_ENABLED())
+        return;
+
+    LOG_DEBUG("BCD Motion Plan:");
 
     if (motion_plan.section == NULL)
     {
-        printf("  (NULL motion plan)\n");
+        LOG_DEBUG("  (NULL motion plan)");
         return;
     }
 
     int section_count = cvector_size(motion_plan.section);
-    printf("  Total sections: %d\n", section_count);
+    LOG_DEBUG("  Total sections: %d", section_count);
 
     if (section_count == 0)
     {
-        printf("  (no sections)\n");
+        LOG_DEBUG("  (no sections)");
         return;
     }
 
     for (int i = 0; i < section_count; i++)
     {
         const cell_motion_plan_t *section = &motion_plan.section[i];
-        printf("  Section %d:\n", i);
+        LOG_DEBUG("  Section %d:", i);
 
         // Log coverage motion (ox)
         if (section->ox == NULL)
         {
-            printf("    Coverage: (NULL point list)\n");
+            LOG_DEBUG("    Coverage: (NULL point list)");
         }
         else
         {
             int point_count = cvector_size(section->ox);
-            printf("    Coverage points: %d (continuous path)\n", point_count);
+            LOG_DEBUG("    Coverage points: %d (continuous path)", point_count);
 
             if (point_count == 0)
             {
-                printf("    Coverage: (no points)\n");
+                LOG_DEBUG("    Coverage: (no points)");
             }
             else
             {
-                // Log the continuous path points
-                printf("    Path: ");
-                for (int j = 0; j < point_count; j++)
+                // Log the continuous path points, 4 per line for readability
+                for (int j = 0; j < point_count; j += 4)
                 {
-                    point_t point = section->ox[j];
-                    printf("(%.2f, %.2f)", point.x, point.y);
-                    if (j < point_count - 1)
-                    {
-                        printf(" -> ");
-                    }
-
-                    // Break line every 4 points for readability
-                    if ((j + 1) % 4 == 0 && j < point_count - 1)
+                    char line[160];
+                    int used = 0;
+                    for (int k = j; k < point_count && k < j + 4; k++)
                     {
-                        printf("\n          ");
+                        point_t point = section->ox[k];
+                        used += snprintf(line + used, sizeof(line) - (size_t)used, "(%.2f, %.2f)%s",
+                                         point.x, point.y, k < point_count - 1 ? " -> " : "");
                     }
+                    LOG_DEBUG("    %s%s", j == 0 ? "Path: " : "      ", line);
                 }
-                printf("\n");
             }
         }
 
         // Log navigation motion (nav)
         if (section->nav == NULL)
         {
-            printf("    Navigation: (NULL point list)\n");
+            LOG_DEBUG("    Navigation: (NULL point list)");
         }
         else
         {
             int nav_count = cvector_size(section->nav);
-            printf("    Navigation points: %d\n", nav_count);
+            LOG_DEBUG("    Navigation points: %d", nav_count);
 
             if (nav_count == 0)
             {
-                printf("    Navigation: (no points)\n");
+                LOG_DEBUG("    Navigation: (no points)");
             }
             else
             {
                 for (int j = 0; j < nav_count; j++)
                 {
                     point_t nav_point = section->nav[j];
-                    printf("      Nav %d: (%.2f, %.2f)\n", j, nav_point.x, nav_point.y);
+                    LOG_DEBUG("      Nav %d: (%.2f, %.2f)", j, nav_point.x, nav_point.y);
                 }
             }
         }
     }
 }
+#endif
 
 void free_bcd_motion(bcd_motion_plan_t *motion_plan)
 {
@@ -1,6 +1,7 @@
 #ifndef BCD_MOTION_H
 #define BCD_MOTION_H
 
+#include "../planning_arena.h"
 #include "../../../../dependencies/cvector/cvector.h"
 #include "bcd_cell_computation.h"
 #include "bcd_coverage_planning.h"
@@ -8,7 +9,7 @@
 typedef struct
 {
     cvector_vector_type(point_t) ox;
-    cvector_vector_type(point_t) nav; // navigation to next cell
+    cvector_vector_type(point_t) nav; // Way here from the previous section, both ends included; NULL if not planned
 } cell_motion_plan_t;
 
 typedef struct
@@ -16,12 +17,48 @@ typedef struct
     cvector_vector_type(cell_motion_plan_t) section;
 } bcd_motion_plan_t;
 
+// How a cell is swept. By default the lines run left to right and the first one goes
+// from the ceiling down to the floor. BCD_SWEEP_UP starts at the floor instead, and
+// BCD_SWEEP_REVERSED drives the same path backwards, entering where it would have ended.
+// Together they give the four entry corners of a cell.
+typedef enum {
+    BCD_SWEEP_DEFAULT = 0,
+    BCD_SWEEP_UP = 1 << 0,
+    BCD_SWEEP_REVERSED = 1 << 1,
+    BCD_SWEEP_VARIANT_COUNT = 4
+} bcd_sweep_variant_t;
+
+// Cells are swept in order of their first visit in path_list, or in the order of
+// sweep_order (every cell once) when it is given: path_list then also lists the cells
+// driven through in between, and each section navigates from the previous one through
+// them (trace_bcd_cell_corridor). sweep_variants holds a bcd_sweep_variant_t per cell,
+// or is NULL to sweep every cell the default way.
 int compute_bcd_motion(cvector_vector_type(bcd_cell_t) * cell_list,
+                       const bcd_edge_pool_t *edge_pool,
                        const cvector_vector_type(int) * path_list,
+                       const int *sweep_order,
+                       const unsigned char *sweep_variants,
                        bcd_motion_plan_t *motion_plan,
                        float step_size);
 
+// First and last point of the cell's sweep, without computing the sweep.
+// Returns -1 if the cell is too narrow to be swept.
+int compute_bcd_sweep_endpoints(const bcd_cell_t *cell,
+                                const bcd_edge_pool_t *edge_pool,
+                                int sweep_variant,
+                                float step_size,
+                                point_t *entry,
+                                point_t *exit);
+
+// Length of the travel between consecutive sections (non-working travel): along the
+// navigation where it was planned, straight otherwise
+double bcd_motion_transit_length(const bcd_motion_plan_t *motion_plan);
+
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_DEBUG
 void log_bcd_motion(const bcd_motion_plan_t motion_plan);
+#else
+#define log_bcd_motion(...) ((void)0)
+#endif
 
 void free_bcd_motion(bcd_motion_plan_t *motion_plan);
 
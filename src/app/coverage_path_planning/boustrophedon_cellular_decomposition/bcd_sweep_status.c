@@ -0,0 +1,445 @@
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "../planning_arena.h"
+#include "../../../../dependencies/cvector/cvector.h"
+#include "../coverage_path_planning.h"
+#include "bcd_cell_computation.h"
+#include "bcd_sweep_status.h"
+
+#define VERTEX_MAP_MIN_CAPACITY 16
+
+typedef enum {
+    VERTEX_SLOT_EMPTY = 0,
+    VERTEX_SLOT_USED,
+    VERTEX_SLOT_DELETED
+} vertex_slot_state_t;
+
+// FORWARD DECLARATIONS ---------------------------------------------
+
+// --- ORDERED OPEN CELLS HELPERS
+
+static float edge_y_at(polygon_edge_t edge,
+                       float x);
+
+static float cell_ceiling_y_at(const bcd_sweep_status_t *status,
+                               const cvector_vector_type(bcd_cell_t) * cell_list,
+                               int cell_index,
+                               float x);
+
+static float cell_floor_y_at(const bcd_sweep_status_t *status,
+                             const cvector_vector_type(bcd_cell_t) * cell_list,
+                             int cell_index,
+                             float x);
+
+// --- VERTEX_MAP HELPERS
+
+static int init_vertex_map(bcd_vertex_map_t *map,
+                           uint32_t capacity);
+
+static uint32_t hash_vertex(point_t vertex);
+
+static int rehash_vertex_map(bcd_vertex_map_t *map);
+
+static int get_vertex_map(const bcd_vertex_map_t *map,
+                          point_t vertex);
+
+static int put_vertex_map(bcd_vertex_map_t *map,
+                          point_t vertex,
+                          int cell_index);
+
+static void remove_vertex_map(bcd_vertex_map_t *map,
+                              point_t vertex,
+                              int cell_index);
+
+static void free_vertex_map(bcd_vertex_map_t *map);
+
+// IMPLEMENTATION --- bcd_sweep_status ------------------------------
+
+int init_bcd_sweep_status(bcd_sweep_status_t *status,
+                          const bcd_edge_pool_t *edge_pool)
+{
+    status->edge_pool = edge_pool;
+    status->open_cells = NULL;
+    status->floor_frontier = (bcd_vertex_map_t){0};
+    status->ceiling_frontier = (bcd_vertex_map_t){0};
+
+    if (init_vertex_map(&status->floor_frontier, VERTEX_MAP_MIN_CAPACITY) != 0 ||
+        init_vertex_map(&status->ceiling_frontier, VERTEX_MAP_MIN_CAPACITY) != 0)
+    {
+        free_bcd_sweep_status(status);
+        return -1;
+    }
+
+    return 0;
+}
+
+// Ordered open cells
+
+// Binary search for the open cell whose ceiling/floor span at vertex.x contains vertex.y
+int find_enclosing_open_cell_rank(const bcd_sweep_status_t *status,
+                                  const cvector_vector_type(bcd_cell_t) * cell_list,
+                                  point_t vertex)
+{
+    int lo = 0;
+    int hi = (int)cvector_size(status->open_cells) - 1;
+
+    while (lo <= hi)
+    {
+        int mid = lo + (hi - lo) / 2;
+        int cell_index = status->open_cells[mid];
+
+        if (vertex.y < cell_ceiling_y_at(status, cell_list, cell_index, vertex.x))
+        {
+            hi = mid - 1;
+        }
+        else if (vertex.y > cell_floor_y_at(status, cell_list, cell_index, vertex.x))
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            return mid;
+        }
+    }
+
+    return -1;
+}
+
+// First rank whose cell ceiling lies below vertex.y at vertex.x
+int find_open_cell_insert_rank(const bcd_sweep_status_t *status,
+                               const cvector_vector_type(bcd_cell_t) * cell_list,
+                               point_t vertex)
+{
+    int lo = 0;
+    int hi = (int)cvector_size(status->open_cells);
+
+    while (lo < hi)
+    {
+        int mid = lo + (hi - lo) / 2;
+
+        if (cell_ceiling_y_at(status, cell_list, status->open_cells[mid], vertex.x) > vertex.y)
+        {
+            hi = mid;
+        }
+        else
+        {
+            lo = mid + 1;
+        }
+    }
+
+    return lo;
+}
+
+// Rank of a known open cell touching vertex; falls back to a scan on degenerate geometry
+int find_open_cell_rank(const bcd_sweep_status_t *status,
+                        const cvector_vector_type(bcd_cell_t) * cell_list,
+                        int cell_index,
+                        point_t vertex)
+{
+    int open_count = (int)cvector_size(status->open_cells);
+    int rank = find_enclosing_open_cell_rank(status, cell_list, vertex);
+
+    if (rank >= 0)
+    {
+        for (int r = rank - 1; r <= rank + 1; r++)
+        {
+            if (r >= 0 && r < open_count && status->open_cells[r] == cell_index)
+                return r;
+        }
+    }
+
+    for (int r = 0; r < open_count; r++)
+    {
+        if (status->open_cells[r] == cell_index)
+            return r;
+    }
+
+    return -1;
+}
+
+int open_sweep_cell(bcd_sweep_status_t *status,
+                    const cvector_vector_type(bcd_cell_t) * cell_list,
+                    int cell_index,
+                    int rank)
+{
+    const bcd_cell_t *cell = &(*cell_list)[cell_index];
+
+    cvector_insert(status->open_cells, (size_t)rank, cell_index);
+
+    if (put_vertex_map(&status->floor_frontier, bcd_edge_chain_back(status->edge_pool, cell->floor_edges)->begin, cell_index) != 0 ||
+        put_vertex_map(&status->ceiling_frontier, bcd_edge_chain_back(status->edge_pool, cell->ceiling_edges)->end, cell_index) != 0)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+void close_sweep_cell(bcd_sweep_status_t *status,
+                      const cvector_vector_type(bcd_cell_t) * cell_list,
+                      int cell_index,
+                      int rank)
+{
+    const bcd_cell_t *cell = &(*cell_list)[cell_index];
+
+    if (rank >= 0)
+    {
+        cvector_erase(status->open_cells, (size_t)rank);
+    }
+
+    remove_vertex_map(&status->floor_frontier, bcd_edge_chain_back(status->edge_pool, cell->floor_edges)->begin, cell_index);
+    remove_vertex_map(&status->ceiling_frontier, bcd_edge_chain_back(status->edge_pool, cell->ceiling_edges)->end, cell_index);
+}
+
+// Chain frontiers
+
+int find_cell_by_floor_frontier(const bcd_sweep_status_t *status,
+                                point_t vertex)
+{
+    return get_vertex_map(&status->floor_frontier, vertex);
+}
+
+int find_cell_by_ceiling_frontier(const bcd_sweep_status_t *status,
+                                  point_t vertex)
+{
+    return get_vertex_map(&status->ceiling_frontier, vertex);
+}
+
+int move_floor_frontier(bcd_sweep_status_t *status,
+                        int cell_index,
+                        point_t old_vertex,
+                        point_t new_vertex)
+{
+    remove_vertex_map(&status->floor_frontier, old_vertex, cell_index);
+    return put_vertex_map(&status->floor_frontier, new_vertex, cell_index);
+}
+
+int move_ceiling_frontier(bcd_sweep_status_t *status,
+                          int cell_index,
+                          point_t old_vertex,
+                          point_t new_vertex)
+{
+    remove_vertex_map(&status->ceiling_frontier, old_vertex, cell_index);
+    return put_vertex_map(&status->ceiling_frontier, new_vertex, cell_index);
+}
+
+void free_bcd_sweep_status(bcd_sweep_status_t *status)
+{
+    if (!status)
+        return;
+
+    cvector_free(status->open_cells);
+    status->open_cells = NULL;
+    free_vertex_map(&status->floor_frontier);
+    free_vertex_map(&status->ceiling_frontier);
+}
+
+// --- ORDERED OPEN CELLS HELPERS
+
+// Same interpolation as calc_evt_to_edge_dist, extrapolated past the edge ends
+static float edge_y_at(polygon_edge_t edge,
+                       float x)
+{
+    float dx = edge.end.x - edge.begin.x;
+
+    if (fabsf(dx) < 1e-9f)
+    {
+        return edge.begin.y;
+    }
+
+    float t = (x - edge.begin.x) / dx;
+    return edge.begin.y + t * (edge.end.y - edge.begin.y);
+}
+
+static float cell_ceiling_y_at(const bcd_sweep_status_t *status,
+                               const cvector_vector_type(bcd_cell_t) * cell_list,
+                               int cell_index,
+                               float x)
+{
+    return edge_y_at(*bcd_edge_chain_back(status->edge_pool, (*cell_list)[cell_index].ceiling_edges), x);
+}
+
+static float cell_floor_y_at(const bcd_sweep_status_t *status,
+                             const cvector_vector_type(bcd_cell_t) * cell_list,
+                             int cell_index,
+                             float x)
+{
+    return edge_y_at(*bcd_edge_chain_back(status->edge_pool, (*cell_list)[cell_index].floor_edges), x);
+}
+
+// --- VERTEX_MAP HELPERS
+
+static int init_vertex_map(bcd_vertex_map_t *map,
+                           uint32_t capacity)
+{
+    map->slots = (bcd_vertex_slot_t *)calloc(capacity, sizeof(bcd_vertex_slot_t));
+    if (!map->slots)
+    {
+        map->capacity = 0;
+        return -1;
+    }
+    map->capacity = capacity;
+    map->count = 0;
+    map->occupied = 0;
+    return 0;
+}
+
+static uint32_t hash_vertex(point_t vertex)
+{
+    // +0.0f folds -0.0f into 0.0f so hashing agrees with are_equal_points
+    float x = vertex.x + 0.0f;
+    float y = vertex.y + 0.0f;
+    uint32_t hx;
+    uint32_t hy;
+    memcpy(&hx, &x, sizeof(hx));
+    memcpy(&hy, &y, sizeof(hy));
+
+    uint32_t h = hx * 0x9E3779B1u;
+    h ^= hy * 0x85EBCA77u;
+    h ^= h >> 15;
+    h *= 0xC2B2AE3Du;
+    h ^= h >> 13;
+    return h;
+}
+
+// Moves the live keys into a table four times their number, dropping the tombstones
+static int rehash_vertex_map(bcd_vertex_map_t *map)
+{
+    uint32_t capacity = VERTEX_MAP_MIN_CAPACITY;
+    while (capacity < 4u * (map->count + 1))
+    {
+        capacity <<= 1;
+    }
+
+    bcd_vertex_map_t rehashed;
+    if (init_vertex_map(&rehashed, capacity) != 0)
+        return -1;
+
+    uint32_t mask = capacity - 1;
+    for (uint32_t i = 0; i < map->capacity; i++)
+    {
+        const bcd_vertex_slot_t *s = &map->slots[i];
+        if (s->state != VERTEX_SLOT_USED)
+            continue;
+
+        uint32_t slot = hash_vertex(s->vertex) & mask;
+        while (rehashed.slots[slot].state != VERTEX_SLOT_EMPTY)
+        {
+            slot = (slot + 1) & mask;
+        }
+        rehashed.slots[slot] = *s;
+    }
+    rehashed.count = rehashed.occupied = map->count;
+
+    free_vertex_map(map);
+    *map = rehashed;
+    return 0;
+}
+
+static int get_vertex_map(const bcd_vertex_map_t *map,
+                          point_t vertex)
+{
+    uint32_t mask = map->capacity - 1;
+    uint32_t slot = hash_vertex(vertex) & mask;
+
+    for (uint32_t probe = 0; probe < map->capacity; probe++)
+    {
+        const bcd_vertex_slot_t *s = &map->slots[slot];
+
+        if (s->state == VERTEX_SLOT_EMPTY)
+            return -1;
+
+        if (s->state == VERTEX_SLOT_USED && are_equal_points(s->vertex, vertex))
+            return s->cell_index;
+
+        slot = (slot + 1) & mask;
+    }
+
+    return -1;
+}
+
+static int put_vertex_map(bcd_vertex_map_t *map,
+                          point_t vertex,
+                          int cell_index)
+{
+    if (2u * (map->occupied + 1) > map->capacity && rehash_vertex_map(map) != 0)
+        return -1;
+
+    uint32_t mask = map->capacity - 1;
+    uint32_t slot = hash_vertex(vertex) & mask;
+    bcd_vertex_slot_t *free_slot = NULL;
+
+    for (uint32_t probe = 0; probe < map->capacity; probe++)
+    {
+        bcd_vertex_slot_t *s = &map->slots[slot];
+
+        if (s->state == VERTEX_SLOT_USED && are_equal_points(s->vertex, vertex))
+        {
+            s->cell_index = cell_index;
+            return 0;
+        }
+
+        if (s->state != VERTEX_SLOT_USED && !free_slot)
+            free_slot = s;
+
+        if (s->state == VERTEX_SLOT_EMPTY)
+            break;
+
+        slot = (slot + 1) & mask;
+    }
+
+    if (!free_slot)
+        return -1;
+
+    if (free_slot->state == VERTEX_SLOT_EMPTY)
+        map->occupied++;
+    map->count++;
+    free_slot->vertex = vertex;
+    free_slot->cell_index = cell_index;
+    free_slot->state = VERTEX_SLOT_USED;
+    return 0;
+}
+
+// Only removes the key while it still belongs to cell_index
+static void remove_vertex_map(bcd_vertex_map_t *map,
+                              point_t vertex,
+                              int cell_index)
+{
+    uint32_t mask = map->capacity - 1;
+    uint32_t slot = hash_vertex(vertex) & mask;
+
+    for (uint32_t probe = 0; probe < map->capacity; probe++)
+    {
+        bcd_vertex_slot_t *s = &map->slots[slot];
+
+        if (s->state == VERTEX_SLOT_EMPTY)
+            return;
+
+        if (s->state == VERTEX_SLOT_USED && are_equal_points(s->vertex, vertex))
+        {
+            if (s->cell_index == cell_index)
+            {
+                s->state = VERTEX_SLOT_DELETED;
+                map->count--;
+            }
+            return;
+        }
+
+        slot = (slot + 1) & mask;
+    }
+}
+
+static void free_vertex_map(bcd_vertex_map_t *map)
+{
+    if (map->slots)
+    {
+        free(map->slots);
+    }
+    map->slots = NULL;
+    map->capacity = 0;
+    map->count = 0;
+    map->occupied = 0;
+}
@@ -0,0 +1,86 @@
+// Sweep-line status for compute_bcd_cells: open cells ordered along the sweep line
+// and vertex -> open cell lookups for the frontiers of their floor/ceiling chains
+
+#ifndef BCD_SWEEP_STATUS_H
+#define BCD_SWEEP_STATUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../planning_arena.h"
+#include "../../../../dependencies/cvector/cvector.h"
+#include "bcd_cell_computation.h"
+
+typedef struct
+{
+    point_t vertex;
+    int cell_index;
+    uint8_t state;
+} bcd_vertex_slot_t;
+
+// Open addressing; rehashed before an insert would take the load (tombstones included)
+// above 1/2, so its size follows the live frontier rather than the events swept so far
+typedef struct
+{
+    bcd_vertex_slot_t *slots;
+    uint32_t capacity;                      // Power of two
+    uint32_t count;                         // Live keys
+    uint32_t occupied;                      // Live keys plus tombstones
+} bcd_vertex_map_t;
+
+typedef struct
+{
+    const bcd_edge_pool_t *edge_pool;       // Holds the chains whose frontiers are tracked
+    cvector_vector_type(int) open_cells;    // Open cell indices, ordered by y of their ceiling at the sweep x
+    bcd_vertex_map_t floor_frontier;        // Begin of an open cell's last floor edge -> cell index
+    bcd_vertex_map_t ceiling_frontier;      // End of an open cell's last ceiling edge -> cell index
+} bcd_sweep_status_t;
+
+int init_bcd_sweep_status(bcd_sweep_status_t *status,
+                          const bcd_edge_pool_t *edge_pool);
+
+// Ordered open cells
+
+int find_enclosing_open_cell_rank(const bcd_sweep_status_t *status,
+                                  const cvector_vector_type(bcd_cell_t) * cell_list,
+                                  point_t vertex);
+
+int find_open_cell_insert_rank(const bcd_sweep_status_t *status,
+                               const cvector_vector_type(bcd_cell_t) * cell_list,
+                               point_t vertex);
+
+int find_open_cell_rank(const bcd_sweep_status_t *status,
+                        const cvector_vector_type(bcd_cell_t) * cell_list,
+                        int cell_index,
+                        point_t vertex);
+
+int open_sweep_cell(bcd_sweep_status_t *status,
+                    const cvector_vector_type(bcd_cell_t) * cell_list,
+                    int cell_index,
+                    int rank);
+
+void close_sweep_cell(bcd_sweep_status_t *status,
+                      const cvector_vector_type(bcd_cell_t) * cell_list,
+                      int cell_index,
+                      int rank);
+
+// Chain frontiers
+
+int find_cell_by_floor_frontier(const bcd_sweep_status_t *status,
+                                point_t vertex);
+
+int find_cell_by_ceiling_frontier(const bcd_sweep_status_t *status,
+                                  point_t vertex);
+
+int move_floor_frontier(bcd_sweep_status_t *status,
+                        int cell_index,
+                        point_t old_vertex,
+                        point_t new_vertex);
+
+int move_ceiling_frontier(bcd_sweep_status_t *status,
+                          int cell_index,
+                          point_t old_vertex,
+                          point_t new_vertex);
+
+void free_bcd_sweep_status(bcd_sweep_status_t *status);
+
+#endif // BCD_SWEEP_STATUS_H
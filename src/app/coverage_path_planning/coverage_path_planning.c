@@ -1,176 +1,674 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include "coverage_path_planning.h"
-#include "../../../dependencies/cJSON/cJSON.h"
+#include "polygon_simplification.h"
+#include "planning_arena.h"
+#include "json_reader.h"
+#include "json_writer.h"
+#include "float_format.h"
+#include "plan_binary.h"
+#include "../logger.h"
 #include "../../../dependencies/cvector/cvector.h"
 #include "boustrophedon_cellular_decomposition/bcd_event_list_building.h"
 #include "boustrophedon_cellular_decomposition/bcd_cell_computation.h"
+#include "boustrophedon_cellular_decomposition/bcd_cell_graph.h"
 #include "boustrophedon_cellular_decomposition/bcd_coverage_planning.h"
 #include "boustrophedon_cellular_decomposition/bcd_motion_planning.h"
+#include "boustrophedon_cellular_decomposition/bcd_cell_ordering.h"
+
+#define LOG_MODULE LOG_MODULE_PLANNER
+
+#define COORDINATE_QUANTIZE_LIMIT 9.0e15        // Keeps quantized coordinates exact in a double
+#define INPUT_KEY_SIZE 32                       // Longer member names match nothing the parser looks for
+#define INPUT_MIN_VERTEX_JSON_SIZE 13           // {"x":0,"y":0}
+#define MOTION_STEP_SIZE 0.25f                  // Metres between sweep lines
+
+// Top-level members of the input environment
+typedef enum {
+	INPUT_MEMBER_ID = 1u << 0,
+	INPUT_MEMBER_PATH_WIDTH = 1u << 1,
+	INPUT_MEMBER_PATH_OVERLAP = 1u << 2,
+	INPUT_MEMBER_SIMPLIFY_TOLERANCE = 1u << 3,
+	INPUT_MEMBER_OUTPUT_PRECISION = 1u << 4,
+	INPUT_MEMBER_OUTPUT_SECTIONS = 1u << 5,
+	INPUT_MEMBER_COORDINATE_FORMAT = 1u << 6,
+	INPUT_MEMBER_COORDINATE_SCALE = 1u << 7,
+	INPUT_MEMBER_COORDINATE_DELTA = 1u << 8,
+	INPUT_MEMBER_BOUNDARY = 1u << 9,
+	INPUT_MEMBER_OBSTACLES = 1u << 10,
+	INPUT_MEMBER_CELL_ORDER = 1u << 11,
+	INPUT_MEMBERS_REQUIRED = INPUT_MEMBER_ID | INPUT_MEMBER_PATH_WIDTH | INPUT_MEMBER_PATH_OVERLAP
+} input_member_t;
+
+// What the single pass found, turned into one error code once the text is read
+typedef struct
+{
+	uint32_t seen;              // input_member_t bits; like cJSON_GetObjectItemCaseSensitive, the first occurrence wins
+	bool invalid;               // A field is malformed (-3)
+	int boundary_status;        // parse_polygon_vertices code, -1 while no boundary array was read
+	int obstacles_status;
+} input_parse_state_t;
 
 static int parse_input_environment_json(const char *json,
+										size_t json_length,
 										input_environment_t *env);
-static int parse_polygon_vertices_from_array(const cJSON *arr,
-											 polygon_t *polygon,
-											 polygon_winding_t winding);
-static int polygon_build_edges(polygon_t *polygon);
-
+static void parse_input_member(json_reader_t *reader,
+							   uint32_t member,
+							   input_environment_t *env,
+							   input_parse_state_t *state);
+static uint32_t input_member_from_key(const char *key);
+static bool read_number_member(json_reader_t *reader, double *value);
+static bool read_integer_member(json_reader_t *reader, int min, int max, int *value);
+static bool read_string_member(json_reader_t *reader, char *buffer, size_t size);
+static int parse_polygon_vertices(json_reader_t *reader,
+								  vertex_pool_t *vertex_pool,
+								  polygon_t *polygon,
+								  polygon_winding_t winding);
+static int parse_vertex(json_reader_t *reader, vertex_pool_t *vertex_pool);
+static int parse_obstacle_list(json_reader_t *reader, input_environment_t *env);
+static void move_boundary_to_front(input_environment_t *env);
+static void reverse_floats(float *values, uint32_t begin, uint32_t end);
+static int init_vertex_pool(vertex_pool_t *vertex_pool,
+							uint32_t capacity);
+static void free_vertex_pool(vertex_pool_t *vertex_pool);
+
+static int exact_point_orientation(const point_t a,
+								   const point_t b,
+								   const point_t c);
+static void two_sum(double a, double b, double *sum, double *err);
+
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_DEBUG
 static void log_event_list(const bcd_event_list_t *event_list);
+#else
+#define log_event_list(...) ((void)0)
+#endif
 static const char *event_type_to_string(bcd_event_type_t t);
 static const char *polygon_type_to_string(polygon_type_t t);
+static uint32_t output_section_from_string(const char *name);
+static int check_coordinate_encoding(const coordinate_encoding_t *encoding);
 static char *serialize_event_list_json(const bcd_event_list_t *event_list);
-static char *serialize_result_json(const bcd_event_list_t *event_list,
+static char *serialize_result_json(uint32_t output_sections,
+								   int output_precision,
+								   const coordinate_encoding_t *encoding,
+								   const simplification_report_t *simplification,
+								   const bcd_cell_order_report_t *cell_order,
+								   const bcd_event_list_t *event_list,
 								   cvector_vector_type(bcd_cell_t) * cell_list,
+								   const bcd_edge_pool_t *edge_pool,
+								   const bcd_cell_graph_t *cell_graph,
 								   cvector_vector_type(int) * path_list,
 								   const bcd_motion_plan_t *motion_plan);
+static char *planning_error(size_t *length, char *error_json);
 static char *err_cleanup(input_environment_t *env,
 						 bcd_event_list_t *event_list,
 						 cvector_vector_type(bcd_cell_t) * cell_list,
+						 bcd_edge_pool_t *edge_pool,
+						 bcd_cell_graph_t *cell_graph,
 						 cvector_vector_type(int) * path_list,
 						 bcd_motion_plan_t *motion_plan,
 						 int rc);
 
+static size_t estimate_result_json_size(const bcd_event_list_t *event_list,
+										cvector_vector_type(bcd_cell_t) * cell_list,
+										const bcd_edge_pool_t *edge_pool,
+										const bcd_motion_plan_t *motion_plan);
+static void write_cell_list_json(json_writer_t *w,
+								 const coordinate_encoding_t *encoding,
+								 cvector_vector_type(bcd_cell_t) * cell_list,
+								 const bcd_edge_pool_t *edge_pool);
+static void write_cell_graph_json(json_writer_t *w, const bcd_cell_graph_t *cell_graph);
+static void write_motion_plan_json(json_writer_t *w,
+								   const coordinate_encoding_t *encoding,
+								   const bcd_motion_plan_t *motion_plan);
+static void write_point_json(json_writer_t *w, const coordinate_encoding_t *encoding, const point_t point);
+static void write_edge_json(json_writer_t *w, const coordinate_encoding_t *encoding, const polygon_edge_t *edge);
+static void write_edge_chain_json(json_writer_t *w,
+								  const coordinate_encoding_t *encoding,
+								  const bcd_edge_pool_t *edge_pool,
+								  bcd_edge_chain_t chain);
+static void write_point_list_json(json_writer_t *w,
+								  const coordinate_encoding_t *encoding,
+								  const cvector_vector_type(point_t) points);
+static void write_flat_point_json(json_writer_t *w,
+								  const coordinate_encoding_t *encoding,
+								  const point_t point,
+								  int64_t previous[2]);
+static int64_t quantize_coordinate(float value, uint32_t scale);
+static void write_event_list_json(json_writer_t *w,
+								  const coordinate_encoding_t *encoding,
+								  const bcd_event_list_t *event_list);
+static char *serialize_result_binary(uint32_t output_sections,
+									 const simplification_report_t *simplification,
+									 const bcd_cell_order_report_t *cell_order,
+									 const bcd_event_list_t *event_list,
+									 cvector_vector_type(bcd_cell_t) * cell_list,
+									 const bcd_edge_pool_t *edge_pool,
+									 const bcd_cell_graph_t *cell_graph,
+									 cvector_vector_type(int) * path_list,
+									 const bcd_motion_plan_t *motion_plan,
+									 size_t *length);
+static void write_event_list_binary(plan_binary_writer_t *w, const bcd_event_list_t *event_list);
+static void write_cell_list_binary(plan_binary_writer_t *w,
+								   cvector_vector_type(bcd_cell_t) * cell_list,
+								   const bcd_edge_pool_t *edge_pool);
+static void write_cell_graph_binary(plan_binary_writer_t *w, const bcd_cell_graph_t *cell_graph);
+static void write_motion_plan_binary(plan_binary_writer_t *w, const bcd_motion_plan_t *motion_plan);
+
+static char *run_coverage_path_planning(const char *input_environment_json,
+										size_t json_length,
+										plan_format_t format,
+										size_t *length);
+
+static void fingerprint_input_environment(const input_environment_t *env,
+										  plan_format_t format,
+										  planning_fingerprint_t *fingerprint);
+static void fingerprint_word(planning_fingerprint_t *fingerprint, uint32_t word);
+static void fingerprint_float(planning_fingerprint_t *fingerprint, float value);
+static uint64_t fingerprint_finalize(uint64_t h);
+
+static worker_pool_t *planning_worker_pool = NULL;
+
+void coverage_path_planning_set_worker_pool(worker_pool_t *pool)
+{
+	planning_worker_pool = pool;
+}
+
+void coverage_path_planning_init(void)
+{
+	planning_arena_install_hooks();
+}
+
 char *coverage_path_planning_process(const char *input_environment_json)
 {
+	size_t json_length = input_environment_json ? strlen(input_environment_json) : 0;
+	return coverage_path_planning_process_as(input_environment_json, json_length, PLAN_FORMAT_JSON, NULL);
+}
+
+char *coverage_path_planning_process_as(const char *input_environment_json,
+										size_t json_length,
+										plan_format_t format,
+										size_t *length)
+{
+	// Everything the pipeline allocates on this thread lands in one arena, released
+	// in one go at the end. The result writers' buffers come from malloc() and survive it.
+	planning_arena_t arena;
+	planning_arena_init(&arena);
+	planning_arena_bind(&arena);
+
+	size_t result_length = 0;
+	char *result = run_coverage_path_planning(input_environment_json, json_length, format, &result_length);
+	if (length)
+		*length = result_length;
+
+	planning_arena_bind(NULL);
+	planning_arena_release(&arena);
+
+	return result;
+}
+
+int coverage_path_planning_fingerprint(const char *input_environment_json,
+									   size_t json_length,
+									   plan_format_t format,
+									   planning_fingerprint_t *fingerprint)
+{
+	if (!input_environment_json || !fingerprint)
+		return -1;
+
+	planning_arena_t arena;
+	planning_arena_init(&arena);
+	planning_arena_bind(&arena);
+
 	input_environment_t env;
+	int rc = parse_input_environment_json(input_environment_json, json_length, &env);
+	if (rc == 0)
+		fingerprint_input_environment(&env, format, fingerprint);
+	free_input_environment(&env);
 
-	int rc = parse_input_environment_json(input_environment_json, &env);
-	if (rc != 0)
-	{
-		printf("coverage_path_planning: parse failed (code %d)\n", rc);
-		return err_cleanup(&env, NULL, NULL, NULL, NULL, rc);
-	}
+	planning_arena_bind(NULL);
+	planning_arena_release(&arena);
+
+	return rc;
+}
 
+// *length receives the size of the result, which is only binary for successful
+// PLAN_FORMAT_BINARY runs; errors are always JSON
+static char *run_coverage_path_planning(const char *input_environment_json,
+										size_t json_length,
+										plan_format_t format,
+										size_t *length)
+{
+	input_environment_t env;
+	simplification_report_t simplification = {0};
 	bcd_event_list_t event_list;
+	event_list.env = &env;
 	event_list.bcd_events = NULL;
 	event_list.length = 0;
+	cvector_vector_type(bcd_cell_t) cell_list = NULL;
+	bcd_edge_pool_t edge_pool = {0};
+	bcd_cell_graph_t cell_graph = {0};
+	cvector_vector_type(int) path_list = NULL;
+	bcd_motion_plan_t motion_plan = {0};
+	int *sweep_order = NULL;
+	unsigned char *sweep_variants = NULL;
+	bcd_cell_order_report_t cell_order = {0};
+	bool cell_order_ran = false;
 
-	rc = build_bcd_event_list(&env, &event_list);
+	int rc = parse_input_environment_json(input_environment_json, json_length, &env);
 	if (rc != 0)
 	{
-		printf("coverage_path_planning: BCD event list generation failed (code %d)\n", rc);
-		return err_cleanup(&env, &event_list, NULL, NULL, NULL, rc);
+		LOG_WARN("parse failed (code %d)", rc);
+		return planning_error(length, err_cleanup(&env, NULL, NULL, NULL, NULL, NULL, NULL, rc));
 	}
-	printf("coverage_path_planning: successfully generated %d events\n", event_list.length);
 
-	cvector_vector_type(bcd_cell_t) cell_list = NULL;
-	rc = compute_bcd_cells(&event_list, &cell_list);
+	if (env.simplify_tolerance >= 0.0f)
+	{
+		rc = simplify_input_environment(&env, env.simplify_tolerance * env.path_width, &simplification);
+		if (rc != 0)
+		{
+			LOG_ERROR("simplification failed (code %d)", rc);
+			return planning_error(length, err_cleanup(&env, NULL, NULL, NULL, NULL, NULL, NULL, rc));
+		}
+		LOG_INFO("simplification kept %u of %u vertices",
+				 simplification.output_vertex_count, simplification.input_vertex_count);
+	}
+
+	// The merged event list is only built when the response carries it; otherwise the
+	// sweep pulls events straight from the sorted per-polygon runs
+	if (!(env.output_sections & OUTPUT_SECTION_EVENT_LIST) && (env.output_sections & OUTPUT_SECTIONS_AFTER_EVENTS))
+	{
+		bcd_event_stream_t event_stream;
+		rc = open_bcd_event_stream(&env, planning_worker_pool, &event_stream);
+		if (rc != 0)
+		{
+			LOG_ERROR("BCD event list generation failed (code %d)", rc);
+			return planning_error(length, err_cleanup(&env, NULL, NULL, NULL, NULL, NULL, NULL, rc));
+		}
+		LOG_INFO("streaming %d events", event_stream.length);
+
+		rc = compute_bcd_cells_from_stream(&event_stream, &cell_list, &edge_pool);
+		close_bcd_event_stream(&event_stream);
+	}
+	else
+	{
+		rc = build_bcd_event_list_parallel(&env, &event_list, planning_worker_pool);
+		if (rc != 0)
+		{
+			LOG_ERROR("BCD event list generation failed (code %d)", rc);
+			return planning_error(length, err_cleanup(&env, &event_list, NULL, NULL, NULL, NULL, NULL, rc));
+		}
+		LOG_INFO("generated %d events", event_list.length);
+		log_event_list(&event_list);
+
+		// Later stages only run while a section that needs them was requested
+		if (!(env.output_sections & OUTPUT_SECTIONS_AFTER_EVENTS))
+			goto serialize;
+
+		rc = compute_bcd_cells(&event_list, &cell_list, &edge_pool);
+	}
 	if (rc != 0)
 	{
-		printf("coverage_path_planning: BCD cell computation failed (code %d)\n", rc);
-		return err_cleanup(&env, &event_list, &cell_list, NULL, NULL, rc);
+		LOG_ERROR("BCD cell computation failed (code %d)", rc);
+		return planning_error(length, err_cleanup(&env, &event_list, &cell_list, &edge_pool, NULL, NULL, NULL, rc));
 	}
-	printf("coverage_path_planning: successfully generated %d cells\n", cvector_size(cell_list));
-	// log_bcd_cell_list((const cvector_vector_type(bcd_cell_t) *) &cell_list);
+	LOG_INFO("generated %d cells", (int)cvector_size(cell_list));
+	log_bcd_cell_list((const cvector_vector_type(bcd_cell_t) *)&cell_list, &edge_pool);
 
-	cvector_vector_type(int) path_list = NULL;
-	rc = compute_bcd_path_list(&cell_list, -1, &path_list);
+	if (!(env.output_sections & OUTPUT_SECTIONS_AFTER_CELLS))
+		goto serialize;
+
+	rc = build_bcd_cell_graph((const cvector_vector_type(bcd_cell_t) *)&cell_list, &cell_graph);
 	if (rc != 0)
 	{
-		printf("coverage_path_planning: BCD path computation failed (code %d)\n", rc);
-		return err_cleanup(&env, &event_list, &cell_list, &path_list, NULL, rc);
+		LOG_ERROR("BCD cell graph construction failed (code %d)", rc);
+		return planning_error(length, err_cleanup(&env, &event_list, &cell_list, &edge_pool, &cell_graph, NULL, NULL, rc));
 	}
-	printf("coverage_path_planning: successfully generated path with %d visits\n", cvector_size(path_list));
-	// log_bcd_path_list((const cvector_vector_type(int) *)&path_list);
+	log_bcd_cell_graph(&cell_graph);
+
+	if (!(env.output_sections & OUTPUT_SECTIONS_AFTER_CELL_GRAPH))
+		goto serialize;
+
+	rc = compute_bcd_path_list(&cell_list, &cell_graph, -1, &path_list);
+	if (rc != 0)
+	{
+		LOG_ERROR("BCD path computation failed (code %d)", rc);
+		return planning_error(length, err_cleanup(&env, &event_list, &cell_list, &edge_pool, &cell_graph, &path_list, NULL, rc));
+	}
+
+	if (env.cell_order == CELL_ORDER_TRAVEL)
+	{
+		sweep_order = (int *)planning_malloc(cvector_size(cell_list) * sizeof(int));
+		sweep_variants = (unsigned char *)planning_malloc(cvector_size(cell_list));
+		rc = sweep_order && sweep_variants ? optimize_bcd_cell_order((const cvector_vector_type(bcd_cell_t) *)&cell_list,
+																	 &edge_pool,
+																	 &cell_graph,
+																	 MOTION_STEP_SIZE,
+																	 &path_list,
+																	 sweep_order,
+																	 sweep_variants,
+																	 &cell_order)
+										   : -2;
+		if (rc != 0)
+		{
+			LOG_ERROR("BCD cell ordering failed (code %d)", rc);
+			planning_free(sweep_order);
+			planning_free(sweep_variants);
+			return planning_error(length, err_cleanup(&env, &event_list, &cell_list, &edge_pool, &cell_graph, &path_list, NULL, rc));
+		}
+		LOG_INFO("cell order cut transit from %.1f m to %.1f m",
+				 cell_order.initial_transit_length, cell_order.transit_length);
+	}
+	LOG_INFO("generated path with %d visits", (int)cvector_size(path_list));
+	log_bcd_path_list((const cvector_vector_type(int) *)&path_list);
+
+	if (!(env.output_sections & OUTPUT_SECTIONS_AFTER_PATH))
+		goto serialize;
 
-	bcd_motion_plan_t motion_plan = {0};
 	rc = compute_bcd_motion(&cell_list,
+							&edge_pool,
 							(const cvector_vector_type(int) *)&path_list,
+							sweep_order,
+							sweep_variants,
 							&motion_plan, 
-							0.25);
+							MOTION_STEP_SIZE);
 	if (rc != 0)
 	{
-		printf("coverage_path_planning: BCD motion computation failed (code %d)\n", rc);
-		return err_cleanup(&env, &event_list, &cell_list, &path_list, &motion_plan, rc);
+		LOG_ERROR("BCD motion computation failed (code %d)", rc);
+		planning_free(sweep_order);
+		planning_free(sweep_variants);
+		return planning_error(length, err_cleanup(&env, &event_list, &cell_list, &edge_pool, &cell_graph, &path_list, &motion_plan, rc));
 	}
+	LOG_INFO("generated motion plan with %d sections", (int)cvector_size(motion_plan.section));
 	log_bcd_motion(motion_plan);
 
-	char *json_out = serialize_result_json(&event_list, &cell_list, &path_list, &motion_plan);
+	// What the robot actually drives between sweeps
+	if (sweep_variants)
+	{
+		cell_order.transit_length = bcd_motion_transit_length(&motion_plan);
+		cell_order_ran = true;
+	}
+
+serialize:;
+	char *result = NULL;
+	if (format == PLAN_FORMAT_BINARY)
+	{
+		result = serialize_result_binary(env.output_sections,
+										 env.simplify_tolerance >= 0.0f ? &simplification : NULL,
+										 cell_order_ran ? &cell_order : NULL,
+										 &event_list, &cell_list, &edge_pool, &cell_graph, &path_list, &motion_plan,
+										 length);
+	}
+	else
+	{
+		result = serialize_result_json(env.output_sections,
+									   env.output_precision,
+									   &env.coordinate_encoding,
+									   env.simplify_tolerance >= 0.0f ? &simplification : NULL,
+									   cell_order_ran ? &cell_order : NULL,
+									   &event_list, &cell_list, &edge_pool, &cell_graph, &path_list, &motion_plan);
+		*length = result ? strlen(result) : 0;
+	}
 
-	err_cleanup(&env, &event_list, &cell_list, &path_list, &motion_plan, rc);
+	planning_free(sweep_order);
+	planning_free(sweep_variants);
+	err_cleanup(&env, &event_list, &cell_list, &edge_pool, &cell_graph, &path_list, &motion_plan, rc);
 
-	return json_out;
+	return result;
 }
 
+// One pass over the text: members are handled as they come and vertices go straight
+// into the pool. Error codes do not depend on member order: -2 for invalid JSON, -3 for
+// missing or malformed fields, -4 when out of memory, then the boundary's and the
+// obstacles' parse_polygon_vertices codes (-1: no boundary array).
 static int parse_input_environment_json(const char *json,
+										size_t json_length,
 										input_environment_t *env)
 {
-	if (!json || !env)
+	if (!env)
 		return -1;
 
 	env->id = 0;
 	env->path_width = 0.0f;
 	env->path_overlap = 0.0f;
+	env->simplify_tolerance = -1.0f;
+	env->output_precision = FLOAT_FORMAT_SHORTEST;
+	env->output_sections = OUTPUT_SECTION_ALL;
+	env->coordinate_encoding = (coordinate_encoding_t){0};
+	env->cell_order = CELL_ORDER_ADJACENCY;
+	env->vertex_pool = (vertex_pool_t){0};
 	env->boundary.winding = POLYGON_WINDING_CW;
-	env->boundary.vertices = NULL;
+	env->boundary.first_vertex = 0;
 	env->boundary.vertex_count = 0;
-	env->boundary.edges = NULL;
-	env->boundary.edge_count = 0;
 	env->obstacles = NULL;
 	env->obstacle_count = 0;
 
-	cJSON *root = cJSON_Parse(json);
-	if (!root)
-		return -2;
+	if (!json)
+		return -1;
 
-	int status = 0;
+	json_reader_t reader;
+	json_reader_init(&reader, json, json_length);
+
+	// The text bounds the vertex count, so the pool is sized once and never moves
+	size_t max_vertices = (size_t)(reader.end - reader.cursor) / INPUT_MIN_VERTEX_JSON_SIZE + 1;
+	bool out_of_memory = max_vertices > UINT32_MAX ||
+						 init_vertex_pool(&env->vertex_pool, (uint32_t)max_vertices) != 0;
 
-	const cJSON *jid = cJSON_GetObjectItemCaseSensitive(root, "id");
-	const cJSON *jpw = cJSON_GetObjectItemCaseSensitive(root, "pathWidth");
-	const cJSON *jpo = cJSON_GetObjectItemCaseSensitive(root, "pathOverlap");
-	if (!cJSON_IsNumber(jid) || !cJSON_IsNumber(jpw) || !cJSON_IsNumber(jpo))
+	input_parse_state_t state = {0};
+	state.boundary_status = -1;
+
+	if (json_reader_peek(&reader) == JSON_READER_OBJECT)
 	{
-		status = -3;
-		goto done;
+		char key[INPUT_KEY_SIZE];
+		json_reader_begin_object(&reader);
+		while (json_reader_next_member(&reader, key, sizeof(key)))
+		{
+			uint32_t member = input_member_from_key(key);
+			if (member == 0 || (state.seen & member))
+			{
+				json_reader_skip(&reader);
+				continue;
+			}
+			state.seen |= member;
+			parse_input_member(&reader, member, env, &state);
+		}
+	}
+	else
+	{
+		json_reader_skip(&reader);
 	}
-	env->id = (uint32_t)jid->valuedouble;
-	env->path_width = (float)jpw->valuedouble;
-	env->path_overlap = (float)jpo->valuedouble;
 
-	const cJSON *jboundary = cJSON_GetObjectItemCaseSensitive(root, "boundary");
-	status = parse_polygon_vertices_from_array(jboundary, &env->boundary, POLYGON_WINDING_CW);
-	if (status)
-		goto done;
-	status = polygon_build_edges(&env->boundary);
-	if (status)
-		goto done;
+	int status = 0;
+	if (reader.failed)
+		status = -2;
+	else if (state.invalid || (state.seen & INPUT_MEMBERS_REQUIRED) != INPUT_MEMBERS_REQUIRED ||
+			 check_coordinate_encoding(&env->coordinate_encoding) != 0)
+		status = -3;
+	else if (out_of_memory)
+		status = -4;
+	else if (state.boundary_status != 0)
+		status = state.boundary_status;
+	else
+		status = state.obstacles_status;
 
-	const cJSON *jobstacles = cJSON_GetObjectItemCaseSensitive(root, "obstacles");
-	int obs_count = 0;
-	if (cJSON_IsArray(jobstacles))
+	if (status != 0)
 	{
-		obs_count = cJSON_GetArraySize(jobstacles);
+		free_input_environment(env);
+		return status;
 	}
-	if (obs_count > 0)
+
+	move_boundary_to_front(env);
+	return 0;
+}
+
+// Reads the value of a member seen for the first time
+static void parse_input_member(json_reader_t *reader,
+							   uint32_t member,
+							   input_environment_t *env,
+							   input_parse_state_t *state)
+{
+	double number = 0.0;
+	int integer = 0;
+	char name[INPUT_KEY_SIZE];
+	bool valid = true;
+
+	switch (member)
+	{
+	case INPUT_MEMBER_ID:
+		valid = read_number_member(reader, &number);
+		env->id = (uint32_t)number;
+		break;
+	case INPUT_MEMBER_PATH_WIDTH:
+		valid = read_number_member(reader, &number);
+		env->path_width = (float)number;
+		break;
+	case INPUT_MEMBER_PATH_OVERLAP:
+		valid = read_number_member(reader, &number);
+		env->path_overlap = (float)number;
+		break;
+	case INPUT_MEMBER_SIMPLIFY_TOLERANCE:
+		valid = read_number_member(reader, &number);
+		if (valid)
+			env->simplify_tolerance = (float)number;
+		break;
+	case INPUT_MEMBER_OUTPUT_PRECISION:
+		valid = read_integer_member(reader, 0, FLOAT_FORMAT_MAX_DECIMALS, &integer);
+		if (valid)
+			env->output_precision = integer;
+		break;
+	case INPUT_MEMBER_OUTPUT_SECTIONS:
+		if (json_reader_peek(reader) != JSON_READER_ARRAY)
+		{
+			json_reader_skip(reader);
+			valid = false;
+			break;
+		}
+		env->output_sections = 0;
+		json_reader_begin_array(reader);
+		while (json_reader_next_element(reader))
+		{
+			uint32_t section = read_string_member(reader, name, sizeof(name)) ? output_section_from_string(name) : 0;
+			if (section == 0)
+				valid = false;
+			env->output_sections |= section;
+		}
+		break;
+	case INPUT_MEMBER_COORDINATE_FORMAT:
+		valid = read_string_member(reader, name, sizeof(name)) &&
+				(strcmp(name, "flat") == 0 || strcmp(name, "objects") == 0);
+		env->coordinate_encoding.flat = valid && strcmp(name, "flat") == 0;
+		break;
+	case INPUT_MEMBER_COORDINATE_SCALE:
+		valid = read_integer_member(reader, 1, COORDINATE_MAX_SCALE, &integer);
+		if (valid)
+			env->coordinate_encoding.scale = (uint32_t)integer;
+		break;
+	case INPUT_MEMBER_CELL_ORDER:
+		valid = read_string_member(reader, name, sizeof(name)) &&
+				(strcmp(name, "adjacency") == 0 || strcmp(name, "travel") == 0);
+		env->cell_order = valid && strcmp(name, "travel") == 0 ? CELL_ORDER_TRAVEL : CELL_ORDER_ADJACENCY;
+		break;
+	case INPUT_MEMBER_COORDINATE_DELTA:
 	{
-		env->obstacles = (polygon_t *)calloc((size_t)obs_count, sizeof(polygon_t));
-		if (!env->obstacles)
+		json_reader_type_t type = json_reader_peek(reader);
+		if (type == JSON_READER_TRUE || type == JSON_READER_FALSE)
 		{
-			status = -4;
-			goto done;
+			json_reader_bool(reader, &env->coordinate_encoding.delta);
 		}
-		env->obstacle_count = (uint32_t)obs_count;
-		for (int i = 0; i < obs_count; ++i)
+		else
 		{
-			cJSON *one = cJSON_GetArrayItem(jobstacles, i);
-			status = parse_polygon_vertices_from_array(one, &env->obstacles[i], POLYGON_WINDING_CCW);
-			if (status)
-				goto done;
-			status = polygon_build_edges(&env->obstacles[i]);
-			if (status)
-				goto done;
+			json_reader_skip(reader);
+			valid = false;
 		}
+		break;
+	}
+	case INPUT_MEMBER_BOUNDARY:
+		if (json_reader_peek(reader) == JSON_READER_ARRAY)
+			state->boundary_status = parse_polygon_vertices(reader, &env->vertex_pool, &env->boundary, POLYGON_WINDING_CW);
+		else
+			json_reader_skip(reader);
+		break;
+	case INPUT_MEMBER_OBSTACLES:
+		// Anything but an array means no obstacles
+		if (json_reader_peek(reader) == JSON_READER_ARRAY)
+			state->obstacles_status = parse_obstacle_list(reader, env);
+		else
+			json_reader_skip(reader);
+		break;
+	default:
+		json_reader_skip(reader);
+		break;
 	}
 
-done:
-	cJSON_Delete(root);
-	if (status != 0)
+	if (!valid)
+		state->invalid = true;
+}
+
+// 0 for members the parser does not read
+static uint32_t input_member_from_key(const char *key)
+{
+	static const struct
 	{
-		free_input_environment(env);
+		const char *key;
+		input_member_t member;
+	} members[] = {
+		{"id", INPUT_MEMBER_ID},
+		{"pathWidth", INPUT_MEMBER_PATH_WIDTH},
+		{"pathOverlap", INPUT_MEMBER_PATH_OVERLAP},
+		{"simplifyTolerance", INPUT_MEMBER_SIMPLIFY_TOLERANCE},
+		{"outputPrecision", INPUT_MEMBER_OUTPUT_PRECISION},
+		{"outputSections", INPUT_MEMBER_OUTPUT_SECTIONS},
+		{"coordinateFormat", INPUT_MEMBER_COORDINATE_FORMAT},
+		{"coordinateScale", INPUT_MEMBER_COORDINATE_SCALE},
+		{"coordinateDelta", INPUT_MEMBER_COORDINATE_DELTA},
+		{"boundary", INPUT_MEMBER_BOUNDARY},
+		{"obstacles", INPUT_MEMBER_OBSTACLES},
+		{"cellOrder", INPUT_MEMBER_CELL_ORDER},
+	};
+
+	for (size_t i = 0; i < sizeof(members) / sizeof(members[0]); ++i)
+	{
+		if (strcmp(key, members[i].key) == 0)
+			return members[i].member;
 	}
-	return status;
+	return 0;
+}
+
+// The read_*_member helpers consume the next value whatever it is, and return false
+// when it is not of the expected kind
+
+static bool read_number_member(json_reader_t *reader, double *value)
+{
+	if (json_reader_peek(reader) != JSON_READER_NUMBER)
+	{
+		json_reader_skip(reader);
+		return false;
+	}
+	return json_reader_number(reader, value);
+}
+
+// Integral numbers within [min, max]
+static bool read_integer_member(json_reader_t *reader, int min, int max, int *value)
+{
+	double number;
+	if (!read_number_member(reader, &number) || number != floor(number) || number < min || number > max)
+		return false;
+
+	*value = (int)number;
+	return true;
+}
+
+// Strings that fit buffer
+static bool read_string_member(json_reader_t *reader, char *buffer, size_t size)
+{
+	if (json_reader_peek(reader) != JSON_READER_STRING)
+	{
+		json_reader_skip(reader);
+		return false;
+	}
+	return json_reader_string(reader, buffer, size);
 }
 
 static const char *event_type_to_string(bcd_event_type_t t)
@@ -206,6 +704,22 @@ static const char *event_type_to_string(bcd_event_type_t t)
 	}
 }
 
+// 0 for names that are not a section
+static uint32_t output_section_from_string(const char *name)
+{
+	if (strcmp(name, "event_list") == 0)
+		return OUTPUT_SECTION_EVENT_LIST;
+	if (strcmp(name, "cell_list") == 0)
+		return OUTPUT_SECTION_CELL_LIST;
+	if (strcmp(name, "cell_graph") == 0)
+		return OUTPUT_SECTION_CELL_GRAPH;
+	if (strcmp(name, "path_list") == 0)
+		return OUTPUT_SECTION_PATH_LIST;
+	if (strcmp(name, "motion_plan") == 0)
+		return OUTPUT_SECTION_MOTION_PLAN;
+	return 0;
+}
+
 static const char *polygon_type_to_string(polygon_type_t t)
 {
 	switch (t)
@@ -221,113 +735,133 @@ static const char *polygon_type_to_string(polygon_type_t t)
 
 static char *serialize_event_list_json(const bcd_event_list_t *event_list)
 {
-	cJSON *root = cJSON_CreateObject();
-	cJSON_AddStringToObject(root, "status", "ok");
-	cJSON *arr = cJSON_CreateArray();
-	cJSON_AddItemToObject(root, "event_list", arr);
-
-	if (event_list && event_list->bcd_events && event_list->length > 0)
-	{
-		for (int i = 0; i < event_list->length; ++i)
-		{
-			const bcd_event_t *ev = &event_list->bcd_events[i];
-			cJSON *jev = cJSON_CreateObject();
-			cJSON_AddStringToObject(jev, "polygon_type", polygon_type_to_string(ev->polygon_type));
-			cJSON *jv = cJSON_CreateObject();
-			cJSON_AddNumberToObject(jv, "x", ev->polygon_vertex.x);
-			cJSON_AddNumberToObject(jv, "y", ev->polygon_vertex.y);
-			cJSON_AddItemToObject(jev, "vertex", jv);
-			cJSON_AddStringToObject(jev, "event_type", event_type_to_string(ev->bcd_event_type));
-
-			// floor edge
-			cJSON *jfloor = cJSON_CreateObject();
-			cJSON *jfb = cJSON_CreateObject();
-			cJSON_AddNumberToObject(jfb, "x", ev->floor_edge.begin.x);
-			cJSON_AddNumberToObject(jfb, "y", ev->floor_edge.begin.y);
-			cJSON_AddItemToObject(jfloor, "begin", jfb);
-			cJSON *jfe = cJSON_CreateObject();
-			cJSON_AddNumberToObject(jfe, "x", ev->floor_edge.end.x);
-			cJSON_AddNumberToObject(jfe, "y", ev->floor_edge.end.y);
-			cJSON_AddItemToObject(jfloor, "end", jfe);
-			cJSON_AddItemToObject(jev, "floor_edge", jfloor);
-
-			// ceiling edge
-			cJSON *jceil = cJSON_CreateObject();
-			cJSON *jcb = cJSON_CreateObject();
-			cJSON_AddNumberToObject(jcb, "x", ev->ceiling_edge.begin.x);
-			cJSON_AddNumberToObject(jcb, "y", ev->ceiling_edge.begin.y);
-			cJSON_AddItemToObject(jceil, "begin", jcb);
-			cJSON *jce = cJSON_CreateObject();
-			cJSON_AddNumberToObject(jce, "x", ev->ceiling_edge.end.x);
-			cJSON_AddNumberToObject(jce, "y", ev->ceiling_edge.end.y);
-			cJSON_AddItemToObject(jceil, "end", jce);
-			cJSON_AddItemToObject(jev, "ceiling_edge", jceil);
-
-			cJSON_AddItemToArray(arr, jev);
-		}
-	}
-
-	char *json = cJSON_PrintUnformatted(root);
-	cJSON_Delete(root);
-	return json; // caller must free
+	json_writer_t w;
+	if (json_writer_init(&w, estimate_result_json_size(event_list, NULL, NULL, NULL)) != 0)
+		return NULL;
+
+	json_writer_begin_object(&w);
+	json_writer_key(&w, "status");
+	json_writer_string(&w, "ok");
+	json_writer_key(&w, "event_list");
+	write_event_list_json(&w, &(coordinate_encoding_t){0}, event_list);
+	json_writer_end_object(&w);
+
+	return json_writer_finish(&w); // caller must free
 }
 
-static char *serialize_result_json(const bcd_event_list_t *event_list,
+static char *serialize_result_json(uint32_t output_sections,
+								   int output_precision,
+								   const coordinate_encoding_t *encoding,
+								   const simplification_report_t *simplification,
+								   const bcd_cell_order_report_t *cell_order,
+								   const bcd_event_list_t *event_list,
 								   cvector_vector_type(bcd_cell_t) * cell_list,
+								   const bcd_edge_pool_t *edge_pool,
+								   const bcd_cell_graph_t *cell_graph,
 								   cvector_vector_type(int) * path_list,
 								   const bcd_motion_plan_t *motion_plan)
 {
-	cJSON *root = cJSON_CreateObject();
-	cJSON_AddStringToObject(root, "status", "ok");
+	json_writer_t w;
+	size_t estimate = estimate_result_json_size((output_sections & OUTPUT_SECTION_EVENT_LIST) ? event_list : NULL,
+												(output_sections & OUTPUT_SECTION_CELL_LIST) ? cell_list : NULL,
+												(output_sections & OUTPUT_SECTION_CELL_LIST) ? edge_pool : NULL,
+												(output_sections & OUTPUT_SECTION_MOTION_PLAN) ? motion_plan : NULL);
+	if (json_writer_init(&w, estimate) != 0)
+		return NULL;
+	w.float_decimals = output_precision;
+
+	json_writer_begin_object(&w);
+	json_writer_key(&w, "status");
+	json_writer_string(&w, "ok");
+
+	// Flat coordinates declare how to read them back
+	if (encoding->flat)
+	{
+		json_writer_key(&w, "coordinates");
+		json_writer_begin_object(&w);
+		json_writer_key(&w, "format");
+		json_writer_string(&w, "flat");
+		json_writer_key(&w, "scale");
+		json_writer_int64(&w, encoding->scale);
+		json_writer_key(&w, "delta");
+		json_writer_bool(&w, encoding->delta);
+		json_writer_end_object(&w);
+	}
+
+	// Only present when the simplification pre-pass ran
+	if (simplification)
+	{
+		json_writer_key(&w, "simplification");
+		json_writer_begin_object(&w);
+		json_writer_key(&w, "input_vertices");
+		json_writer_number(&w, simplification->input_vertex_count);
+		json_writer_key(&w, "output_vertices");
+		json_writer_number(&w, simplification->output_vertex_count);
+		json_writer_end_object(&w);
+	}
+
+	// Only present when "cellOrder" is "travel" and the motion plan was computed
+	if (cell_order)
+	{
+		json_writer_key(&w, "cell_order");
+		json_writer_begin_object(&w);
+		json_writer_key(&w, "transit_length");
+		json_writer_number(&w, cell_order->transit_length);
+		json_writer_key(&w, "adjacency_transit_length");
+		json_writer_number(&w, cell_order->initial_transit_length);
+		json_writer_end_object(&w);
+	}
 
 	// Add event list
-	cJSON *event_arr = cJSON_CreateArray();
-	cJSON_AddItemToObject(root, "event_list", event_arr);
+	if (output_sections & OUTPUT_SECTION_EVENT_LIST)
+	{
+		json_writer_key(&w, "event_list");
+		write_event_list_json(&w, encoding, event_list);
+	}
 
-	if (event_list && event_list->bcd_events && event_list->length > 0)
+	// Add cell list
+	if (output_sections & OUTPUT_SECTION_CELL_LIST)
+		write_cell_list_json(&w, encoding, cell_list, edge_pool);
+
+	// Add cell adjacency
+	if (output_sections & OUTPUT_SECTION_CELL_GRAPH)
+		write_cell_graph_json(&w, cell_graph);
+
+	// Add path list
+	if (output_sections & OUTPUT_SECTION_PATH_LIST)
 	{
-		for (int i = 0; i < event_list->length; ++i)
+		json_writer_key(&w, "path_list");
+		json_writer_begin_array(&w);
+
+		if (path_list && *path_list)
 		{
-			const bcd_event_t *ev = &event_list->bcd_events[i];
-			cJSON *jev = cJSON_CreateObject();
-			cJSON_AddStringToObject(jev, "polygon_type", polygon_type_to_string(ev->polygon_type));
-			cJSON *jv = cJSON_CreateObject();
-			cJSON_AddNumberToObject(jv, "x", ev->polygon_vertex.x);
-			cJSON_AddNumberToObject(jv, "y", ev->polygon_vertex.y);
-			cJSON_AddItemToObject(jev, "vertex", jv);
-			cJSON_AddStringToObject(jev, "event_type", event_type_to_string(ev->bcd_event_type));
-
-			// floor edge
-			cJSON *jfloor = cJSON_CreateObject();
-			cJSON *jfb = cJSON_CreateObject();
-			cJSON_AddNumberToObject(jfb, "x", ev->floor_edge.begin.x);
-			cJSON_AddNumberToObject(jfb, "y", ev->floor_edge.begin.y);
-			cJSON_AddItemToObject(jfloor, "begin", jfb);
-			cJSON *jfe = cJSON_CreateObject();
-			cJSON_AddNumberToObject(jfe, "x", ev->floor_edge.end.x);
-			cJSON_AddNumberToObject(jfe, "y", ev->floor_edge.end.y);
-			cJSON_AddItemToObject(jfloor, "end", jfe);
-			cJSON_AddItemToObject(jev, "floor_edge", jfloor);
-
-			// ceiling edge
-			cJSON *jceil = cJSON_CreateObject();
-			cJSON *jcb = cJSON_CreateObject();
-			cJSON_AddNumberToObject(jcb, "x", ev->ceiling_edge.begin.x);
-			cJSON_AddNumberToObject(jcb, "y", ev->ceiling_edge.begin.y);
-			cJSON_AddItemToObject(jceil, "begin", jcb);
-			cJSON *jce = cJSON_CreateObject();
-			cJSON_AddNumberToObject(jce, "x", ev->ceiling_edge.end.x);
-			cJSON_AddNumberToObject(jce, "y", ev->ceiling_edge.end.y);
-			cJSON_AddItemToObject(jceil, "end", jce);
-			cJSON_AddItemToObject(jev, "ceiling_edge", jceil);
-
-			cJSON_AddItemToArray(event_arr, jev);
+			int path_count = cvector_size(*path_list);
+			for (int i = 0; i < path_count; ++i)
+			{
+				json_writer_int(&w, (*path_list)[i]);
+			}
 		}
+		json_writer_end_array(&w);
 	}
 
-	// Add cell list
-	cJSON *cell_arr = cJSON_CreateArray();
-	cJSON_AddItemToObject(root, "cell_list", cell_arr);
+	// Add motion plan
+	if (output_sections & OUTPUT_SECTION_MOTION_PLAN)
+		write_motion_plan_json(&w, encoding, motion_plan);
+
+	json_writer_end_object(&w);
+
+	return json_writer_finish(&w); // caller must free
+}
+
+// --- JSON WRITER HELPERS
+
+static void write_cell_list_json(json_writer_t *w,
+								 const coordinate_encoding_t *encoding,
+								 cvector_vector_type(bcd_cell_t) * cell_list,
+								 const bcd_edge_pool_t *edge_pool)
+{
+	json_writer_key(w, "cell_list");
+	json_writer_begin_array(w);
 
 	if (cell_list && *cell_list)
 	{
@@ -335,105 +869,83 @@ static char *serialize_result_json(const bcd_event_list_t *event_list,
 		for (int i = 0; i < cell_count; ++i)
 		{
 			const bcd_cell_t *cell = &(*cell_list)[i];
-			cJSON *jcell = cJSON_CreateObject();
+			json_writer_begin_object(w);
 
 			// Add cell number
-			cJSON_AddNumberToObject(jcell, "cell_number", i);
+			json_writer_key(w, "cell_number");
+			json_writer_int(w, i);
 
 			// Add ceiling boundary
-			cJSON *jc_begin = cJSON_CreateObject();
-			cJSON_AddNumberToObject(jc_begin, "x", cell->c_begin.x);
-			cJSON_AddNumberToObject(jc_begin, "y", cell->c_begin.y);
-			cJSON_AddItemToObject(jcell, "c_begin", jc_begin);
-
-			cJSON *jc_end = cJSON_CreateObject();
-			cJSON_AddNumberToObject(jc_end, "x", cell->c_end.x);
-			cJSON_AddNumberToObject(jc_end, "y", cell->c_end.y);
-			cJSON_AddItemToObject(jcell, "c_end", jc_end);
+			json_writer_key(w, "c_begin");
+			write_point_json(w, encoding, cell->c_begin);
+			json_writer_key(w, "c_end");
+			write_point_json(w, encoding, cell->c_end);
 
 			// Add floor boundary
-			cJSON *jf_begin = cJSON_CreateObject();
-			cJSON_AddNumberToObject(jf_begin, "x", cell->f_begin.x);
-			cJSON_AddNumberToObject(jf_begin, "y", cell->f_begin.y);
-			cJSON_AddItemToObject(jcell, "f_begin", jf_begin);
-
-			cJSON *jf_end = cJSON_CreateObject();
-			cJSON_AddNumberToObject(jf_end, "x", cell->f_end.x);
-			cJSON_AddNumberToObject(jf_end, "y", cell->f_end.y);
-			cJSON_AddItemToObject(jcell, "f_end", jf_end);
-
-			// Add ceiling edges
-			cJSON *ceiling_edges = cJSON_CreateArray();
-			if (cell->ceiling_edge_list)
-			{
-				int ceiling_edge_count = cvector_size(cell->ceiling_edge_list);
-				for (int j = 0; j < ceiling_edge_count; ++j)
-				{
-					const polygon_edge_t *edge = &cell->ceiling_edge_list[j];
-					cJSON *jedge = cJSON_CreateObject();
-					cJSON *jbegin = cJSON_CreateObject();
-					cJSON_AddNumberToObject(jbegin, "x", edge->begin.x);
-					cJSON_AddNumberToObject(jbegin, "y", edge->begin.y);
-					cJSON_AddItemToObject(jedge, "begin", jbegin);
-					cJSON *jend = cJSON_CreateObject();
-					cJSON_AddNumberToObject(jend, "x", edge->end.x);
-					cJSON_AddNumberToObject(jend, "y", edge->end.y);
-					cJSON_AddItemToObject(jedge, "end", jend);
-					cJSON_AddItemToArray(ceiling_edges, jedge);
-				}
-			}
-			cJSON_AddItemToObject(jcell, "ceiling_edges", ceiling_edges);
+			json_writer_key(w, "f_begin");
+			write_point_json(w, encoding, cell->f_begin);
+			json_writer_key(w, "f_end");
+			write_point_json(w, encoding, cell->f_end);
 
-			// Add floor edges
-			cJSON *floor_edges = cJSON_CreateArray();
-			if (cell->floor_edge_list)
-			{
-				int floor_edge_count = cvector_size(cell->floor_edge_list);
-				for (int j = 0; j < floor_edge_count; ++j)
-				{
-					const polygon_edge_t *edge = &cell->floor_edge_list[j];
-					cJSON *jedge = cJSON_CreateObject();
-					cJSON *jbegin = cJSON_CreateObject();
-					cJSON_AddNumberToObject(jbegin, "x", edge->begin.x);
-					cJSON_AddNumberToObject(jbegin, "y", edge->begin.y);
-					cJSON_AddItemToObject(jedge, "begin", jbegin);
-					cJSON *jend = cJSON_CreateObject();
-					cJSON_AddNumberToObject(jend, "x", edge->end.x);
-					cJSON_AddNumberToObject(jend, "y", edge->end.y);
-					cJSON_AddItemToObject(jedge, "end", jend);
-					cJSON_AddItemToArray(floor_edges, jedge);
-				}
-			}
-			cJSON_AddItemToObject(jcell, "floor_edges", floor_edges);
+			// Add ceiling and floor edges
+			json_writer_key(w, "ceiling_edges");
+			write_edge_chain_json(w, encoding, edge_pool, cell->ceiling_edges);
+			json_writer_key(w, "floor_edges");
+			write_edge_chain_json(w, encoding, edge_pool, cell->floor_edges);
 
 			// Add cell properties
-			cJSON_AddBoolToObject(jcell, "open", cell->open);
-			cJSON_AddBoolToObject(jcell, "visited", cell->visited);
-			cJSON_AddBoolToObject(jcell, "cleaned", cell->cleaned);
-
-			cJSON_AddItemToArray(cell_arr, jcell);
+			json_writer_key(w, "open");
+			json_writer_bool(w, cell->open);
+			json_writer_key(w, "visited");
+			json_writer_bool(w, cell->visited);
+			json_writer_key(w, "cleaned");
+			json_writer_bool(w, cell->cleaned);
+
+			json_writer_end_object(w);
 		}
 	}
+	json_writer_end_array(w);
+}
 
-	// Add path list
-	cJSON *path_arr = cJSON_CreateArray();
-	cJSON_AddItemToObject(root, "path_list", path_arr);
+// CSR adjacency: neighbors of cell i are neighbors[offsets[i] .. offsets[i + 1])
+static void write_cell_graph_json(json_writer_t *w, const bcd_cell_graph_t *cell_graph)
+{
+	json_writer_key(w, "cell_graph");
+	json_writer_begin_object(w);
 
-	if (path_list && *path_list)
+	json_writer_key(w, "offsets");
+	json_writer_begin_array(w);
+	if (cell_graph && cell_graph->offsets)
 	{
-		int path_count = cvector_size(*path_list);
-		for (int i = 0; i < path_count; ++i)
+		for (int i = 0; i <= cell_graph->cell_count; ++i)
 		{
-			cJSON_AddItemToArray(path_arr, cJSON_CreateNumber((*path_list)[i]));
+			json_writer_int(w, cell_graph->offsets[i]);
 		}
 	}
+	json_writer_end_array(w);
 
-	// Add motion plan
-	cJSON *motion_plan_obj = cJSON_CreateObject();
-	cJSON_AddItemToObject(root, "motion_plan", motion_plan_obj);
+	json_writer_key(w, "neighbors");
+	json_writer_begin_array(w);
+	if (cell_graph && cell_graph->offsets)
+	{
+		for (int i = 0; i < cell_graph->offsets[cell_graph->cell_count]; ++i)
+		{
+			json_writer_int(w, cell_graph->neighbors[i]);
+		}
+	}
+	json_writer_end_array(w);
 
-	cJSON *sections_arr = cJSON_CreateArray();
-	cJSON_AddItemToObject(motion_plan_obj, "sections", sections_arr);
+	json_writer_end_object(w);
+}
+
+static void write_motion_plan_json(json_writer_t *w,
+								   const coordinate_encoding_t *encoding,
+								   const bcd_motion_plan_t *motion_plan)
+{
+	json_writer_key(w, "motion_plan");
+	json_writer_begin_object(w);
+	json_writer_key(w, "sections");
+	json_writer_begin_array(w);
 
 	if (motion_plan && motion_plan->section)
 	{
@@ -441,213 +953,712 @@ static char *serialize_result_json(const bcd_event_list_t *event_list,
 		for (int i = 0; i < section_count; ++i)
 		{
 			const cell_motion_plan_t *section = &motion_plan->section[i];
-			cJSON *jsection = cJSON_CreateObject();
-			cJSON_AddNumberToObject(jsection, "section_id", i);
+			json_writer_begin_object(w);
+			json_writer_key(w, "section_id");
+			json_writer_int(w, i);
 
 			// Add coverage points (ox)
-			cJSON *coverage_arr = cJSON_CreateArray();
-			cJSON_AddItemToObject(jsection, "coverage", coverage_arr);
-
-			if (section->ox)
-			{
-				int point_count = cvector_size(section->ox);
-				for (int j = 0; j < point_count; ++j)
-				{
-					const point_t *point = &section->ox[j];
-					cJSON *jpoint = cJSON_CreateObject();
-					cJSON_AddNumberToObject(jpoint, "x", point->x);
-					cJSON_AddNumberToObject(jpoint, "y", point->y);
-					cJSON_AddItemToArray(coverage_arr, jpoint);
-				}
-			}
+			json_writer_key(w, "coverage");
+			write_point_list_json(w, encoding, section->ox);
 
 			// Add navigation points (nav)
-			cJSON *nav_arr = cJSON_CreateArray();
-			cJSON_AddItemToObject(jsection, "navigation", nav_arr);
+			json_writer_key(w, "navigation");
+			write_point_list_json(w, encoding, section->nav);
+
+			json_writer_end_object(w);
+		}
+	}
+
+	json_writer_end_array(w);
+	json_writer_end_object(w);
+}
+
+// Rough upper bound so the writer seldom has to grow
+static size_t estimate_result_json_size(const bcd_event_list_t *event_list,
+										cvector_vector_type(bcd_cell_t) * cell_list,
+										const bcd_edge_pool_t *edge_pool,
+										const bcd_motion_plan_t *motion_plan)
+{
+	size_t size = 256;
 
-			if (section->nav)
+	if (event_list)
+		size += (size_t)event_list->length * 320;
+	if (cell_list && *cell_list)
+		size += cvector_size(*cell_list) * 320;
+	if (edge_pool)
+		size += (size_t)edge_pool->count * 80;
+	if (motion_plan && motion_plan->section)
+	{
+		int section_count = cvector_size(motion_plan->section);
+		for (int i = 0; i < section_count; ++i)
+		{
+			size += 64;
+			if (motion_plan->section[i].ox)
+				size += cvector_size(motion_plan->section[i].ox) * 40;
+			if (motion_plan->section[i].nav)
+				size += cvector_size(motion_plan->section[i].nav) * 40;
+		}
+	}
+	return size;
+}
+
+// {"x":..,"y":..}, or [x,y] with flat coordinates
+static void write_point_json(json_writer_t *w, const coordinate_encoding_t *encoding, const point_t point)
+{
+	if (encoding->flat)
+	{
+		json_writer_begin_array(w);
+		write_flat_point_json(w, encoding, point, NULL);
+		json_writer_end_array(w);
+		return;
+	}
+
+	json_writer_begin_object(w);
+	json_writer_key(w, "x");
+	json_writer_float(w, point.x);
+	json_writer_key(w, "y");
+	json_writer_float(w, point.y);
+	json_writer_end_object(w);
+}
+
+// {"begin":..,"end":..}, or [bx,by,ex,ey] with flat coordinates
+static void write_edge_json(json_writer_t *w, const coordinate_encoding_t *encoding, const polygon_edge_t *edge)
+{
+	if (encoding->flat)
+	{
+		json_writer_begin_array(w);
+		write_flat_point_json(w, encoding, edge->begin, NULL);
+		write_flat_point_json(w, encoding, edge->end, NULL);
+		json_writer_end_array(w);
+		return;
+	}
+
+	json_writer_begin_object(w);
+	json_writer_key(w, "begin");
+	write_point_json(w, encoding, edge->begin);
+	json_writer_key(w, "end");
+	write_point_json(w, encoding, edge->end);
+	json_writer_end_object(w);
+}
+
+// Array of edges, or one flat [bx0,by0,ex0,ey0,bx1,...] polyline
+static void write_edge_chain_json(json_writer_t *w,
+								  const coordinate_encoding_t *encoding,
+								  const bcd_edge_pool_t *edge_pool,
+								  bcd_edge_chain_t chain)
+{
+	json_writer_begin_array(w);
+	if (chain.count > 0)
+	{
+		const polygon_edge_t *edges = bcd_edge_chain_begin(edge_pool, chain);
+		int64_t previous[2] = {0, 0};
+		for (int j = 0; j < (int)chain.count; ++j)
+		{
+			if (encoding->flat)
 			{
-				int nav_count = cvector_size(section->nav);
-				for (int j = 0; j < nav_count; ++j)
-				{
-					const point_t *point = &section->nav[j];
-					cJSON *jpoint = cJSON_CreateObject();
-					cJSON_AddNumberToObject(jpoint, "x", point->x);
-					cJSON_AddNumberToObject(jpoint, "y", point->y);
-					cJSON_AddItemToArray(nav_arr, jpoint);
-				}
+				write_flat_point_json(w, encoding, edges[j].begin, previous);
+				write_flat_point_json(w, encoding, edges[j].end, previous);
 			}
+			else
+			{
+				write_edge_json(w, encoding, &edges[j]);
+			}
+		}
+	}
+	json_writer_end_array(w);
+}
+
+// Array of points, or one flat [x0,y0,x1,y1,...] polyline
+static void write_point_list_json(json_writer_t *w,
+								  const coordinate_encoding_t *encoding,
+								  const cvector_vector_type(point_t) points)
+{
+	json_writer_begin_array(w);
+	if (points)
+	{
+		int point_count = cvector_size(points);
+		int64_t previous[2] = {0, 0};
+		for (int j = 0; j < point_count; ++j)
+		{
+			if (encoding->flat)
+				write_flat_point_json(w, encoding, points[j], previous);
+			else
+				write_point_json(w, encoding, points[j]);
+		}
+	}
+	json_writer_end_array(w);
+}
+
+// x and y inside a flat array: integers at the declared scale when one is set, and
+// relative to the polyline's previous point when delta-encoding (previous non-NULL)
+static void write_flat_point_json(json_writer_t *w,
+								  const coordinate_encoding_t *encoding,
+								  const point_t point,
+								  int64_t previous[2])
+{
+	if (encoding->scale == 0)
+	{
+		json_writer_float(w, point.x);
+		json_writer_float(w, point.y);
+		return;
+	}
+
+	int64_t x = quantize_coordinate(point.x, encoding->scale);
+	int64_t y = quantize_coordinate(point.y, encoding->scale);
+	if (encoding->delta && previous)
+	{
+		json_writer_int64(w, x - previous[0]);
+		json_writer_int64(w, y - previous[1]);
+		previous[0] = x;
+		previous[1] = y;
+	}
+	else
+	{
+		json_writer_int64(w, x);
+		json_writer_int64(w, y);
+	}
+}
+
+static int64_t quantize_coordinate(float value, uint32_t scale)
+{
+	double scaled = (double)value * scale;
+	if (!(scaled > -COORDINATE_QUANTIZE_LIMIT))
+		scaled = -COORDINATE_QUANTIZE_LIMIT;
+	else if (scaled > COORDINATE_QUANTIZE_LIMIT)
+		scaled = COORDINATE_QUANTIZE_LIMIT;
+	return llround(scaled);
+}
+
+static void write_event_list_json(json_writer_t *w,
+								  const coordinate_encoding_t *encoding,
+								  const bcd_event_list_t *event_list)
+{
+	json_writer_begin_array(w);
 
-			cJSON_AddItemToArray(sections_arr, jsection);
+	if (event_list && event_list->bcd_events && event_list->length > 0)
+	{
+		for (int i = 0; i < event_list->length; ++i)
+		{
+			const bcd_event_t *ev = &event_list->bcd_events[i];
+			json_writer_begin_object(w);
+			json_writer_key(w, "polygon_type");
+			json_writer_string(w, polygon_type_to_string(ev->polygon_type));
+			json_writer_key(w, "vertex");
+			write_point_json(w, encoding, ev->polygon_vertex);
+			json_writer_key(w, "event_type");
+			json_writer_string(w, event_type_to_string(ev->bcd_event_type));
+
+			polygon_edge_t floor_edge = resolve_polygon_edge(event_list->env, ev->floor_edge);
+			polygon_edge_t ceiling_edge = resolve_polygon_edge(event_list->env, ev->ceiling_edge);
+
+			json_writer_key(w, "floor_edge");
+			write_edge_json(w, encoding, &floor_edge);
+			json_writer_key(w, "ceiling_edge");
+			write_edge_json(w, encoding, &ceiling_edge);
+
+			json_writer_end_object(w);
 		}
 	}
 
-	char *json = cJSON_PrintUnformatted(root);
-	cJSON_Delete(root);
-	return json; // caller must free
+	json_writer_end_array(w);
+}
+
+// --- BINARY WRITER HELPERS
+
+// Sections are memcpy()ed straight out of the planner's arrays, so their element
+// layout has to be the wire layout (see plan_binary.h)
+_Static_assert(sizeof(point_t) == 2 * sizeof(float), "point_t must be two packed floats");
+_Static_assert(sizeof(polygon_edge_t) == 4 * sizeof(float), "polygon_edge_t must be four packed floats");
+_Static_assert(sizeof(int) == sizeof(int32_t), "cell indices are written as int32");
+_Static_assert(BOUNDARY == 0 && OBSTACLE == 1, "polygon type codes are part of the binary layout");
+_Static_assert(B_IN == 0 && B_DEINIT == 5 && IN == 6 && CEILING == 11, "event type codes are part of the binary layout");
+
+static char *serialize_result_binary(uint32_t output_sections,
+									 const simplification_report_t *simplification,
+									 const bcd_cell_order_report_t *cell_order,
+									 const bcd_event_list_t *event_list,
+									 cvector_vector_type(bcd_cell_t) * cell_list,
+									 const bcd_edge_pool_t *edge_pool,
+									 const bcd_cell_graph_t *cell_graph,
+									 cvector_vector_type(int) * path_list,
+									 const bcd_motion_plan_t *motion_plan,
+									 size_t *length)
+{
+	uint16_t section_count = (simplification ? 1 : 0) + (cell_order ? 1 : 0);
+	if (output_sections & OUTPUT_SECTION_EVENT_LIST)
+		section_count += 3;
+	if (output_sections & OUTPUT_SECTION_CELL_LIST)
+		section_count += 3;
+	if (output_sections & OUTPUT_SECTION_CELL_GRAPH)
+		section_count += 2;
+	if (output_sections & OUTPUT_SECTION_PATH_LIST)
+		section_count += 1;
+	if (output_sections & OUTPUT_SECTION_MOTION_PLAN)
+		section_count += 2;
+
+	// A binary plan is about a third of its JSON; the writer grows if that is short
+	size_t estimate = estimate_result_json_size((output_sections & OUTPUT_SECTION_EVENT_LIST) ? event_list : NULL,
+												(output_sections & OUTPUT_SECTION_CELL_LIST) ? cell_list : NULL,
+												(output_sections & OUTPUT_SECTION_CELL_LIST) ? edge_pool : NULL,
+												(output_sections & OUTPUT_SECTION_MOTION_PLAN) ? motion_plan : NULL) / 3;
+
+	plan_binary_writer_t w;
+	if (plan_binary_writer_init(&w, section_count, estimate) != 0)
+		return NULL;
+
+	if (simplification)
+	{
+		int32_t counts[2] = {(int32_t)simplification->input_vertex_count, (int32_t)simplification->output_vertex_count};
+		plan_binary_begin_section(&w, PLAN_SECTION_SIMPLIFICATION, PLAN_BINARY_INT32);
+		plan_binary_append(&w, counts, 2);
+	}
+
+	if (cell_order)
+	{
+		float lengths[2] = {(float)cell_order->transit_length, (float)cell_order->initial_transit_length};
+		plan_binary_begin_section(&w, PLAN_SECTION_CELL_ORDER, PLAN_BINARY_FLOAT32);
+		plan_binary_append(&w, lengths, 2);
+	}
+
+	if (output_sections & OUTPUT_SECTION_EVENT_LIST)
+		write_event_list_binary(&w, event_list);
+
+	if (output_sections & OUTPUT_SECTION_CELL_LIST)
+		write_cell_list_binary(&w, cell_list, edge_pool);
+
+	if (output_sections & OUTPUT_SECTION_CELL_GRAPH)
+		write_cell_graph_binary(&w, cell_graph);
+
+	if (output_sections & OUTPUT_SECTION_PATH_LIST)
+	{
+		plan_binary_begin_section(&w, PLAN_SECTION_PATH, PLAN_BINARY_INT32);
+		if (path_list && *path_list)
+			plan_binary_append(&w, *path_list, cvector_size(*path_list));
+	}
+
+	if (output_sections & OUTPUT_SECTION_MOTION_PLAN)
+		write_motion_plan_binary(&w, motion_plan);
+
+	return (char *)plan_binary_finish(&w, length); // caller must free
+}
+
+static void write_event_list_binary(plan_binary_writer_t *w, const bcd_event_list_t *event_list)
+{
+	int event_count = event_list && event_list->bcd_events ? event_list->length : 0;
+
+	plan_binary_begin_section(w, PLAN_SECTION_EVENT_INFO, PLAN_BINARY_INT32);
+	for (int i = 0; i < event_count; ++i)
+	{
+		const bcd_event_t *ev = &event_list->bcd_events[i];
+		int32_t info[2] = {(int32_t)ev->polygon_type, (int32_t)ev->bcd_event_type};
+		plan_binary_append(w, info, 2);
+	}
+
+	plan_binary_begin_section(w, PLAN_SECTION_EVENT_VERTICES, PLAN_BINARY_FLOAT32);
+	for (int i = 0; i < event_count; ++i)
+	{
+		plan_binary_append(w, &event_list->bcd_events[i].polygon_vertex, 2);
+	}
+
+	// Edges are stored as references; resolve them like the JSON does
+	plan_binary_begin_section(w, PLAN_SECTION_EVENT_EDGES, PLAN_BINARY_FLOAT32);
+	for (int i = 0; i < event_count; ++i)
+	{
+		const bcd_event_t *ev = &event_list->bcd_events[i];
+		polygon_edge_t edges[2] = {resolve_polygon_edge(event_list->env, ev->floor_edge),
+								   resolve_polygon_edge(event_list->env, ev->ceiling_edge)};
+		plan_binary_append(w, edges, 8);
+	}
+}
+
+// Cells point into CELL_EDGES, which is the frozen edge pool copied as a whole
+static void write_cell_list_binary(plan_binary_writer_t *w,
+								   cvector_vector_type(bcd_cell_t) * cell_list,
+								   const bcd_edge_pool_t *edge_pool)
+{
+	int cell_count = cell_list && *cell_list ? (int)cvector_size(*cell_list) : 0;
+
+	plan_binary_begin_section(w, PLAN_SECTION_CELL_INFO, PLAN_BINARY_INT32);
+	for (int i = 0; i < cell_count; ++i)
+	{
+		const bcd_cell_t *cell = &(*cell_list)[i];
+		int32_t info[8] = {cell->ceiling_edges.count > 0 ? cell->ceiling_edges.first : 0,
+						   cell->ceiling_edges.count,
+						   cell->floor_edges.count > 0 ? cell->floor_edges.first : 0,
+						   cell->floor_edges.count,
+						   cell->open,
+						   cell->visited,
+						   cell->cleaned,
+						   0};
+		plan_binary_append(w, info, 8);
+	}
+
+	plan_binary_begin_section(w, PLAN_SECTION_CELL_CORNERS, PLAN_BINARY_FLOAT32);
+	for (int i = 0; i < cell_count; ++i)
+	{
+		const bcd_cell_t *cell = &(*cell_list)[i];
+		point_t corners[4] = {cell->c_begin, cell->c_end, cell->f_begin, cell->f_end};
+		plan_binary_append(w, corners, 8);
+	}
+
+	plan_binary_begin_section(w, PLAN_SECTION_CELL_EDGES, PLAN_BINARY_FLOAT32);
+	if (edge_pool && edge_pool->edges)
+		plan_binary_append(w, edge_pool->edges, (size_t)edge_pool->count * 4);
+}
+
+static void write_cell_graph_binary(plan_binary_writer_t *w, const bcd_cell_graph_t *cell_graph)
+{
+	bool has_graph = cell_graph && cell_graph->offsets;
+
+	plan_binary_begin_section(w, PLAN_SECTION_CELL_GRAPH_OFFSETS, PLAN_BINARY_INT32);
+	if (has_graph)
+		plan_binary_append(w, cell_graph->offsets, (size_t)cell_graph->cell_count + 1);
+
+	plan_binary_begin_section(w, PLAN_SECTION_CELL_GRAPH_NEIGHBORS, PLAN_BINARY_INT32);
+	if (has_graph)
+		plan_binary_append(w, cell_graph->neighbors, (size_t)cell_graph->offsets[cell_graph->cell_count]);
+}
+
+// Coverage then navigation points of each section, back to back in MOTION_POINTS
+static void write_motion_plan_binary(plan_binary_writer_t *w, const bcd_motion_plan_t *motion_plan)
+{
+	int section_count = motion_plan && motion_plan->section ? (int)cvector_size(motion_plan->section) : 0;
+
+	plan_binary_begin_section(w, PLAN_SECTION_MOTION_INFO, PLAN_BINARY_INT32);
+	int32_t first_point = 0;
+	for (int i = 0; i < section_count; ++i)
+	{
+		const cell_motion_plan_t *section = &motion_plan->section[i];
+		int32_t coverage_count = section->ox ? (int32_t)cvector_size(section->ox) : 0;
+		int32_t navigation_count = section->nav ? (int32_t)cvector_size(section->nav) : 0;
+		int32_t info[4] = {first_point, coverage_count, first_point + coverage_count, navigation_count};
+		plan_binary_append(w, info, 4);
+		first_point += coverage_count + navigation_count;
+	}
+
+	plan_binary_begin_section(w, PLAN_SECTION_MOTION_POINTS, PLAN_BINARY_FLOAT32);
+	for (int i = 0; i < section_count; ++i)
+	{
+		const cell_motion_plan_t *section = &motion_plan->section[i];
+		if (section->ox)
+			plan_binary_append(w, section->ox, cvector_size(section->ox) * 2);
+		if (section->nav)
+			plan_binary_append(w, section->nav, cvector_size(section->nav) * 2);
+	}
+}
+
+// Error results are JSON whatever format was asked for
+static char *planning_error(size_t *length, char *error_json)
+{
+	*length = error_json ? strlen(error_json) : 0;
+	return error_json;
 }
 
 static char *err_cleanup(input_environment_t *env,
 						 bcd_event_list_t *event_list,
 						 cvector_vector_type(bcd_cell_t) * cell_list,
+						 bcd_edge_pool_t *edge_pool,
+						 bcd_cell_graph_t *cell_graph,
 						 cvector_vector_type(int) * path_list,
 						 bcd_motion_plan_t *motion_plan,
 						 int rc)
 {
 	free_input_environment(env);
 	free_bcd_event_list(event_list);
-	free_bcd_cell_list(cell_list);
-	cvector_free(*path_list);
-	free_bcd_motion(motion_plan);
 
-	cJSON *err = cJSON_CreateObject();
-	cJSON_AddStringToObject(err, "status", "error");
-	cJSON_AddNumberToObject(err, "code", rc);
-	cJSON_AddStringToObject(err, "message", "event list generation failed");
-	char *out = cJSON_PrintUnformatted(err);
-	cJSON_Delete(err);
-	return out;
+	// Cells, paths and motion sections live in the request arena and go with it
+	if (!planning_arena_is_bound())
+	{
+		free_bcd_cell_list(cell_list);
+		free_bcd_edge_pool(edge_pool);
+		free_bcd_cell_graph(cell_graph);
+		if (path_list)
+			cvector_free(*path_list);
+		free_bcd_motion(motion_plan);
+	}
+
+	if (rc == 0)
+		return NULL;
+
+	json_writer_t w;
+	if (json_writer_init(&w, 128) != 0)
+		return NULL;
+
+	json_writer_begin_object(&w);
+	json_writer_key(&w, "status");
+	json_writer_string(&w, "error");
+	json_writer_key(&w, "code");
+	json_writer_int(&w, rc);
+	json_writer_key(&w, "message");
+	json_writer_string(&w, "event list generation failed");
+	json_writer_end_object(&w);
+
+	return json_writer_finish(&w);
 }
 
-static int parse_polygon_vertices_from_array(const cJSON *arr,
-											 polygon_t *polygon,
-											 polygon_winding_t winding)
+// Two independent 64-bit lanes over 32-bit words: FNV-1a and a multiply-rotate mix
+static void fingerprint_input_environment(const input_environment_t *env,
+										  plan_format_t format,
+										  planning_fingerprint_t *fingerprint)
 {
-	if (!cJSON_IsArray(arr) || !polygon)
-		return -1;
+	fingerprint->hi = 0xcbf29ce484222325ULL;
+	fingerprint->lo = 0x9e3779b97f4a7c15ULL;
+
+	uint32_t polygon_count = environment_polygon_count(env);
+	fingerprint_word(fingerprint, polygon_count);
 
-	int n = cJSON_GetArraySize(arr);
-	if (n <= 0)
+	for (uint32_t i = 0; i < polygon_count; ++i)
 	{
-		polygon->winding = winding;
-		polygon->vertices = NULL;
-		polygon->vertex_count = 0;
-		polygon->edges = NULL;
-		polygon->edge_count = 0;
-		return 0;
+		const polygon_t *polygon = environment_polygon(env, i);
+		fingerprint_word(fingerprint, polygon->vertex_count);
+
+		for (uint32_t v = 0; v < polygon->vertex_count; ++v)
+		{
+			fingerprint_float(fingerprint, env->vertex_pool.x[polygon->first_vertex + v]);
+			fingerprint_float(fingerprint, env->vertex_pool.y[polygon->first_vertex + v]);
+		}
 	}
 
-	point_t *vertices = (point_t *)malloc((size_t)n * sizeof(point_t));
-	if (!vertices)
-		return -2;
+	fingerprint_float(fingerprint, env->path_width);
+	fingerprint_float(fingerprint, env->path_overlap);
+	fingerprint_float(fingerprint, env->simplify_tolerance < 0.0f ? -1.0f : env->simplify_tolerance);
+	fingerprint_word(fingerprint, (uint32_t)env->cell_order);
+	fingerprint_word(fingerprint, env->output_sections);
 
-	for (int i = 0; i < n; ++i)
+	// Precision and coordinate encoding only shape JSON; binary plans are always float32
+	fingerprint_word(fingerprint, (uint32_t)format);
+	if (format == PLAN_FORMAT_JSON)
 	{
-		const cJSON *pt = cJSON_GetArrayItem(arr, i);
-		if (!cJSON_IsObject(pt))
+		fingerprint_word(fingerprint, (uint32_t)env->output_precision);
+		fingerprint_word(fingerprint, env->coordinate_encoding.flat);
+		fingerprint_word(fingerprint, env->coordinate_encoding.scale);
+		fingerprint_word(fingerprint, env->coordinate_encoding.delta);
+	}
+
+	fingerprint->hi = fingerprint_finalize(fingerprint->hi);
+	fingerprint->lo = fingerprint_finalize(fingerprint->lo);
+}
+
+static void fingerprint_word(planning_fingerprint_t *fingerprint, uint32_t word)
+{
+	fingerprint->hi = (fingerprint->hi ^ word) * 0x100000001b3ULL;
+
+	uint64_t lo = (fingerprint->lo ^ word) * 0xbf58476d1ce4e5b9ULL;
+	fingerprint->lo = (lo << 31) | (lo >> 33);
+}
+
+// -0.0f and 0.0f plan the same, so they hash the same
+static void fingerprint_float(planning_fingerprint_t *fingerprint, float value)
+{
+	uint32_t bits = 0;
+	if (value != 0.0f)
+		memcpy(&bits, &value, sizeof(bits));
+	fingerprint_word(fingerprint, bits);
+}
+
+// splitmix64 finalizer
+static uint64_t fingerprint_finalize(uint64_t h)
+{
+	h ^= h >> 30;
+	h *= 0xbf58476d1ce4e5b9ULL;
+	h ^= h >> 27;
+	h *= 0x94d049bb133111ebULL;
+	h ^= h >> 31;
+	return h;
+}
+
+// Scale and delta only apply to flat coordinates, and deltas need integer coordinates
+static int check_coordinate_encoding(const coordinate_encoding_t *encoding)
+{
+	if (!encoding->flat && (encoding->scale != 0 || encoding->delta))
+		return -3;
+	if (encoding->delta && encoding->scale == 0)
+		return -3;
+
+	return 0;
+}
+
+// Reads a vertex array into the pool: -3 for an element that is not an object, -4 for
+// a missing or non-number "x" or "y", -2 once the pool is full. After an error the
+// rest of the array is only checked for syntax.
+static int parse_polygon_vertices(json_reader_t *reader,
+								  vertex_pool_t *vertex_pool,
+								  polygon_t *polygon,
+								  polygon_winding_t winding)
+{
+	polygon->winding = winding;
+	polygon->first_vertex = vertex_pool->count;
+	polygon->vertex_count = 0;
+
+	int status = 0;
+	json_reader_begin_array(reader);
+	while (json_reader_next_element(reader))
+	{
+		if (status != 0 || json_reader_peek(reader) != JSON_READER_OBJECT)
 		{
-			free(vertices);
-			return -3;
+			if (status == 0)
+				status = -3;
+			json_reader_skip(reader);
+			continue;
 		}
-		const cJSON *jx = cJSON_GetObjectItemCaseSensitive(pt, "x");
-		const cJSON *jy = cJSON_GetObjectItemCaseSensitive(pt, "y");
-		if (!cJSON_IsNumber(jx) || !cJSON_IsNumber(jy))
+		status = parse_vertex(reader, vertex_pool);
+	}
+
+	polygon->vertex_count = vertex_pool->count - polygon->first_vertex;
+	return status;
+}
+
+static int parse_vertex(json_reader_t *reader, vertex_pool_t *vertex_pool)
+{
+	double coordinates[2] = {0.0, 0.0};
+	bool seen[2] = {false, false};
+	bool valid[2] = {false, false};
+	char key[INPUT_KEY_SIZE];
+
+	json_reader_begin_object(reader);
+	while (json_reader_next_member(reader, key, sizeof(key)))
+	{
+		int axis = strcmp(key, "x") == 0 ? 0 : strcmp(key, "y") == 0 ? 1 : -1;
+		if (axis < 0 || seen[axis])
 		{
-			free(vertices);
-			return -4;
+			json_reader_skip(reader);
+			continue;
 		}
-		vertices[i].x = (float)jx->valuedouble;
-		vertices[i].y = (float)jy->valuedouble;
+		seen[axis] = true;
+		valid[axis] = read_number_member(reader, &coordinates[axis]);
 	}
 
-	polygon->winding = winding;
-	polygon->vertices = vertices;
-	polygon->vertex_count = (uint32_t)n;
-	polygon->edges = NULL;
-	polygon->edge_count = 0;
+	if (!valid[0] || !valid[1])
+		return -4;
+	if (vertex_pool->count == vertex_pool->capacity)
+		return -2;
+
+	vertex_pool->x[vertex_pool->count] = (float)coordinates[0];
+	vertex_pool->y[vertex_pool->count] = (float)coordinates[1];
+	vertex_pool->count++;
 	return 0;
 }
 
-static int polygon_build_edges(polygon_t *polygon)
+// The obstacle count is only known at the closing bracket, so the array grows
+static int parse_obstacle_list(json_reader_t *reader, input_environment_t *env)
 {
-	if (!polygon)
-		return -1;
-	if (polygon->edges)
+	uint32_t capacity = 0;
+	int status = 0;
+
+	json_reader_begin_array(reader);
+	while (json_reader_next_element(reader))
+	{
+		if (status == 0 && env->obstacle_count == capacity)
+		{
+			uint32_t grown = capacity > 0 ? capacity * 2 : 8;
+			polygon_t *obstacles = (polygon_t *)planning_realloc(env->obstacles, (size_t)grown * sizeof(polygon_t));
+			if (obstacles)
+			{
+				env->obstacles = obstacles;
+				capacity = grown;
+			}
+			else
+			{
+				status = -4;
+			}
+		}
+
+		if (status != 0 || json_reader_peek(reader) != JSON_READER_ARRAY)
+		{
+			if (status == 0)
+				status = -1;
+			json_reader_skip(reader);
+			continue;
+		}
+		polygon_t *obstacle = &env->obstacles[env->obstacle_count++];
+		status = parse_polygon_vertices(reader, &env->vertex_pool, obstacle, POLYGON_WINDING_CCW);
+	}
+	return status;
+}
+
+// Simplification compacts the pool in polygon order, so the boundary's vertices have to
+// come first even when "obstacles" preceded "boundary" in the text. The pool is then
+// the obstacles' vertices followed by the boundary's: rotate it by three reversals.
+static void move_boundary_to_front(input_environment_t *env)
+{
+	vertex_pool_t *pool = &env->vertex_pool;
+	uint32_t shift = env->boundary.first_vertex;
+	if (shift == 0)
+		return;
+
+	reverse_floats(pool->x, 0, shift);
+	reverse_floats(pool->x, shift, pool->count);
+	reverse_floats(pool->x, 0, pool->count);
+	reverse_floats(pool->y, 0, shift);
+	reverse_floats(pool->y, shift, pool->count);
+	reverse_floats(pool->y, 0, pool->count);
+
+	env->boundary.first_vertex = 0;
+	for (uint32_t i = 0; i < env->obstacle_count; ++i)
 	{
-		free(polygon->edges);
-		polygon->edges = NULL;
-		polygon->edge_count = 0;
+		env->obstacles[i].first_vertex += env->boundary.vertex_count;
 	}
+}
 
-	if (!polygon->vertices || polygon->vertex_count < 2)
+static void reverse_floats(float *values, uint32_t begin, uint32_t end)
+{
+	while (end - begin > 1)
 	{
-		polygon->edges = NULL;
-		polygon->edge_count = 0;
-		return 0;
+		float value = values[begin];
+		values[begin++] = values[--end];
+		values[end] = value;
 	}
+}
 
-	uint32_t n = polygon->vertex_count;
-	polygon_edge_t *edges = (polygon_edge_t *)malloc((size_t)n * sizeof(polygon_edge_t));
-	if (!edges)
-		return -2;
+static int init_vertex_pool(vertex_pool_t *vertex_pool,
+							uint32_t capacity)
+{
+	vertex_pool->x = NULL;
+	vertex_pool->y = NULL;
+	vertex_pool->count = 0;
+	vertex_pool->capacity = 0;
+
+	if (capacity == 0)
+		return 0;
 
-	for (uint32_t i = 0; i < n; ++i)
+	vertex_pool->x = (float *)planning_malloc((size_t)capacity * sizeof(float));
+	vertex_pool->y = (float *)planning_malloc((size_t)capacity * sizeof(float));
+	if (!vertex_pool->x || !vertex_pool->y)
 	{
-		uint32_t j = (i + 1u) % n;
-		edges[i].begin = polygon->vertices[i];
-		edges[i].end = polygon->vertices[j];
+		free_vertex_pool(vertex_pool);
+		return -1;
 	}
 
-	polygon->edges = edges;
-	polygon->edge_count = n;
+	vertex_pool->capacity = capacity;
 	return 0;
 }
 
+static void free_vertex_pool(vertex_pool_t *vertex_pool)
+{
+	planning_free(vertex_pool->x);
+	planning_free(vertex_pool->y);
+	vertex_pool->x = NULL;
+	vertex_pool->y = NULL;
+	vertex_pool->count = 0;
+	vertex_pool->capacity = 0;
+}
+
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_DEBUG
 static void log_event_list(const bcd_event_list_t *event_list)
 {
-	// printf("coverage_path_planning: successfully generated %d events\n", event_list->length);
+	if (!LOG_DEBUG_ENABLED() || event_list->bcd_events == NULL || event_list->length <= 0)
+		return;
 
-	if (event_list->bcd_events != NULL && event_list->length > 0)
+	LOG_DEBUG("event list preview:");
+	for (int i = 0; i < event_list->length; i++)
 	{
-		printf("coverage_path_planning: event list preview:\n");
-		for (int i = 0; i < event_list->length; i++)
-		{
-			const char *type_str = "UNKNOWN";
-			switch (event_list->bcd_events[i].bcd_event_type)
-			{
-			case B_INIT:
-				type_str = "B_INIT";
-				break;
-			case B_DEINIT:
-				type_str = "B_DEINIT";
-				break;
-			case B_IN:
-				type_str = "B_IN";
-				break;
-			case B_OUT:
-				type_str = "B_OUT";
-				break;
-			case B_SIDE_IN:
-				type_str = "B_SIDE_IN";
-				break;
-			case B_SIDE_OUT:
-				type_str = "B_SIDE_OUT";
-				break;
-			case IN:
-				type_str = "IN";
-				break;
-			case SIDE_IN:
-				type_str = "SIDE_IN";
-				break;
-			case OUT:
-				type_str = "OUT";
-				break;
-			case SIDE_OUT:
-				type_str = "SIDE_OUT";
-				break;
-			case FLOOR:
-				type_str = "FLOOR";
-				break;
-			case CEILING:
-				type_str = "CEILING";
-				break;
-			}
-			printf("  Event %d: (%.2f, %.2f) type=%s polygon=%s\n",
-				   i, event_list->bcd_events[i].polygon_vertex.x, event_list->bcd_events[i].polygon_vertex.y,
-				   type_str, event_list->bcd_events[i].polygon_type == BOUNDARY ? "BOUNDARY" : "OBSTACLE");
-		}
+		const bcd_event_t *event = &event_list->bcd_events[i];
+		LOG_DEBUG("  Event %d: (%.2f, %.2f) type=%s polygon=%s",
+				  i, event->polygon_vertex.x, event->polygon_vertex.y,
+				  event_type_to_string(event->bcd_event_type), polygon_type_to_string(event->polygon_type));
 	}
 }
+#endif
 
 // POINT_T helpers
 
@@ -657,24 +1668,133 @@ bool are_equal_points(point_t a,
 	return a.x == b.x && a.y == b.y;
 }
 
-// 'Destructors'
+// Relative error bound of the double-precision determinant (Shewchuk's ccwerrboundA)
+#define POINT_ORIENTATION_ERRBOUND ((3.0 + 16.0 * 1.1102230246251565e-16) * 1.1102230246251565e-16)
 
-void free_polygon(polygon_t *polygon)
+int point_orientation(const point_t a,
+					  const point_t b,
+					  const point_t c)
 {
-	if (!polygon)
-		return;
-	if (polygon->vertices)
+	double detleft = ((double)a.x - (double)c.x) * ((double)b.y - (double)c.y);
+	double detright = ((double)a.y - (double)c.y) * ((double)b.x - (double)c.x);
+	double det = detleft - detright;
+	double errbound = POINT_ORIENTATION_ERRBOUND * (fabs(detleft) + fabs(detright));
+
+	if (det > errbound)
+		return 1;
+	if (-det > errbound)
+		return -1;
+
+	return exact_point_orientation(a, b, c);
+}
+
+// Products of two floats are exact in double, so the determinant is an exact sum of
+// six doubles; accumulate it as a non-overlapping expansion and take the sign of its
+// most significant component.
+static int exact_point_orientation(const point_t a,
+								   const point_t b,
+								   const point_t c)
+{
+	const double terms[6] = {
+		(double)a.x * (double)b.y,
+		-((double)a.x * (double)c.y),
+		-((double)c.x * (double)b.y),
+		-((double)a.y * (double)b.x),
+		(double)a.y * (double)c.x,
+		(double)c.y * (double)b.x};
+
+	double expansion[6];
+	int length = 0;
+
+	for (int i = 0; i < 6; i++)
 	{
-		free(polygon->vertices);
-		polygon->vertices = NULL;
+		double q = terms[i];
+		for (int j = 0; j < length; j++)
+		{
+			double sum;
+			double err;
+			two_sum(q, expansion[j], &sum, &err);
+			expansion[j] = err;
+			q = sum;
+		}
+		expansion[length++] = q;
 	}
-	if (polygon->edges)
+
+	for (int i = length - 1; i >= 0; i--)
 	{
-		free(polygon->edges);
-		polygon->edges = NULL;
+		if (expansion[i] > 0.0)
+			return 1;
+		if (expansion[i] < 0.0)
+			return -1;
 	}
+	return 0;
+}
+
+static void two_sum(double a, double b, double *sum, double *err)
+{
+	double s = a + b;
+	double b_virtual = s - a;
+	double a_virtual = s - b_virtual;
+	*sum = s;
+	*err = (a - a_virtual) + (b - b_virtual);
+}
+
+// POLYGON_T helpers
+
+uint32_t environment_polygon_count(const input_environment_t *env)
+{
+	return 1u + env->obstacle_count;
+}
+
+const polygon_t *environment_polygon(const input_environment_t *env,
+									 uint32_t polygon_id)
+{
+	return polygon_id == 0 ? &env->boundary : &env->obstacles[polygon_id - 1];
+}
+
+point_t polygon_vertex(const input_environment_t *env,
+					   const polygon_t *polygon,
+					   uint32_t vertex_index)
+{
+	uint32_t i = polygon->first_vertex + vertex_index;
+	return (point_t){env->vertex_pool.x[i], env->vertex_pool.y[i]};
+}
+
+polygon_edge_ref_t polygon_edge_ref(uint32_t polygon_id,
+									uint32_t vertex_index)
+{
+	return (polygon_edge_ref_t){polygon_id, vertex_index};
+}
+
+bool is_polygon_edge_ref_none(const polygon_edge_ref_t ref)
+{
+	return ref.vertex_index == UINT32_MAX;
+}
+
+polygon_edge_t resolve_polygon_edge(const input_environment_t *env,
+									const polygon_edge_ref_t ref)
+{
+	if (is_polygon_edge_ref_none(ref))
+		return (polygon_edge_t){0};
+
+	const polygon_t *polygon = environment_polygon(env, ref.polygon_id);
+	uint32_t next = ref.vertex_index + 1 == polygon->vertex_count ? 0 : ref.vertex_index + 1;
+
+	polygon_edge_t edge;
+	edge.begin = polygon_vertex(env, polygon, ref.vertex_index);
+	edge.end = polygon_vertex(env, polygon, next);
+	return edge;
+}
+
+// 'Destructors'
+
+// Vertices live in the environment's vertex pool; this only resets the view
+void free_polygon(polygon_t *polygon)
+{
+	if (!polygon)
+		return;
+	polygon->first_vertex = 0;
 	polygon->vertex_count = 0;
-	polygon->edge_count = 0;
 	polygon->winding = POLYGON_WINDING_UNKNOWN;
 }
 
@@ -691,8 +1811,10 @@ void free_input_environment(input_environment_t *env)
 		{
 			free_polygon(&env->obstacles[i]);
 		}
-		free(env->obstacles);
+		planning_free(env->obstacles);
 	}
 	env->obstacles = NULL;
 	env->obstacle_count = 0;
+
+	free_vertex_pool(&env->vertex_pool);
 }
@@ -3,8 +3,10 @@
 #ifndef COVERAGE_PATH_PLANNING_H
 #define COVERAGE_PATH_PLANNING_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include "../worker_pool.h"
 
 typedef struct
 {
@@ -29,22 +31,79 @@ typedef enum {
     OBSTACLE
 } polygon_type_t;
 
+// Every polygon vertex of an environment, stored as structure of arrays
 typedef struct
 {
-    polygon_winding_t winding;
+    float *x;
+    float *y;
+    uint32_t count;
+    uint32_t capacity;
+} vertex_pool_t;
 
-    point_t *vertices;
-    uint32_t vertex_count;
+typedef struct
+{
+    polygon_winding_t winding;
 
-    polygon_edge_t *edges;
-    uint32_t edge_count;   
+    uint32_t first_vertex;      // Offset of the polygon's vertices in the vertex pool
+    uint32_t vertex_count;      // Edge i runs from vertex i to vertex (i + 1) % vertex_count
 } polygon_t;
 
+// Edge of an environment polygon, by position instead of by value
+typedef struct
+{
+    uint32_t polygon_id;        // 0: boundary, i + 1: obstacle i
+    uint32_t vertex_index;      // Index of the edge's begin vertex within the polygon
+} polygon_edge_ref_t;
+
+#define POLYGON_EDGE_REF_NONE ((polygon_edge_ref_t){UINT32_MAX, UINT32_MAX})
+
+// Response sections, selected with the optional "outputSections" array of names
+typedef enum {
+    OUTPUT_SECTION_EVENT_LIST = 1u << 0,
+    OUTPUT_SECTION_CELL_LIST = 1u << 1,
+    OUTPUT_SECTION_CELL_GRAPH = 1u << 2,
+    OUTPUT_SECTION_PATH_LIST = 1u << 3,
+    OUTPUT_SECTION_MOTION_PLAN = 1u << 4,
+    OUTPUT_SECTION_ALL = 0x1f
+} output_section_t;
+
+// Sections that need the pipeline to go past a stage: cells, the cell graph, the path
+#define OUTPUT_SECTIONS_AFTER_EVENTS (OUTPUT_SECTION_CELL_LIST | OUTPUT_SECTIONS_AFTER_CELLS)
+#define OUTPUT_SECTIONS_AFTER_CELLS (OUTPUT_SECTION_CELL_GRAPH | OUTPUT_SECTIONS_AFTER_CELL_GRAPH)
+#define OUTPUT_SECTIONS_AFTER_CELL_GRAPH (OUTPUT_SECTION_PATH_LIST | OUTPUT_SECTIONS_AFTER_PATH)
+#define OUTPUT_SECTIONS_AFTER_PATH (OUTPUT_SECTION_MOTION_PLAN)
+
+// How response coordinates are spelled. Objects ({"x":..,"y":..}) by default; flat
+// turns points into [x,y] and every polyline (coverage, navigation, cell edge chains)
+// into one [x0,y0,x1,y1,...] array, optionally as integers at scale units per metre
+// and delta-encoded against the previous point of the same polyline.
+typedef struct
+{
+    bool flat;
+    uint32_t scale;             // 0: plain floats
+    bool delta;                 // Needs a scale
+} coordinate_encoding_t;
+
+#define COORDINATE_MAX_SCALE 1000000
+
+// Order the cells are swept in, selected with the optional "cellOrder" name
+typedef enum {
+    CELL_ORDER_ADJACENCY = 0,   // "adjacency": depth-first over the cell graph, every cell swept the default way
+    CELL_ORDER_TRAVEL = 1       // "travel": least transit between sweeps (bcd_cell_ordering.h)
+} cell_order_t;
+
 typedef struct
 {
     uint32_t id;
     float path_width;
     float path_overlap;
+    float simplify_tolerance;   // Optional "simplifyTolerance", as a fraction of path_width; negative skips the pre-pass
+    int output_precision;       // Optional "outputPrecision", decimal places of emitted coordinates; -1 (default) prints the shortest exact form
+    uint32_t output_sections;   // output_section_t mask; the pipeline stops after the last stage a section needs
+    coordinate_encoding_t coordinate_encoding; // Optional "coordinateFormat", "coordinateScale", "coordinateDelta"
+    cell_order_t cell_order;    // Optional "cellOrder"
+
+    vertex_pool_t vertex_pool;
 
     polygon_t boundary;
 
@@ -52,15 +111,71 @@ typedef struct
     uint32_t obstacle_count;
 } input_environment_t;
 
+// Result encodings; binary is laid out as documented in plan_binary.h
+typedef enum {
+    PLAN_FORMAT_JSON = 0,
+    PLAN_FORMAT_BINARY = 1
+} plan_format_t;
+
+// Canonical 128-bit identity of an environment
+typedef struct
+{
+    uint64_t hi;
+    uint64_t lo;
+} planning_fingerprint_t;
+
+// Installs the allocator hooks the planner relies on; call once at start-up.
+void coverage_path_planning_init(void);
+
 // Processes the input environment JSON and returns a newly allocated JSON string
 // with shape: { "status": "ok", "event_list": [ ... ], "cell_list": [ ... ], "path_list": [ ... ], "motion_plan": { ... } } on success, or
 // { "status": "error", "message": "..." } on failure. Caller must free().
+// "outputSections" in the input limits the response (and the work) to the named sections;
+// cell flags such as "visited" then only reflect the stages that ran.
 char *coverage_path_planning_process(const char *input_environment_json);
 
+// Same, for json_length bytes of JSON that need not be NUL-terminated (a request body
+// read in place), in the given result format; *length (optional) receives the result
+// size. Only successful runs come back binary, errors are the JSON object above:
+// plan_binary_is_plan tells them apart.
+char *coverage_path_planning_process_as(const char *input_environment_json,
+                                        size_t json_length,
+                                        plan_format_t format,
+                                        size_t *length);
+
+// Hashes the parsed environment: polygon geometry, path width/overlap, the
+// simplification tolerance, the cell order and the output sections, plus the result format and, for
+// JSON, its precision and coordinate encoding. Formatting, key order and "id" do not
+// change it, so equal fingerprints plan to the same result. Returns the parse error
+// code on failure.
+int coverage_path_planning_fingerprint(const char *input_environment_json,
+                                       size_t json_length,
+                                       plan_format_t format,
+                                       planning_fingerprint_t *fingerprint);
+
+// Pool used for the parallel stages of coverage_path_planning_process.
+// NULL (the default) runs everything on the calling thread.
+void coverage_path_planning_set_worker_pool(worker_pool_t *pool);
+
 // POINT_T Helpers
 
 bool are_equal_points(const point_t a, const point_t b);
 
+// Orientation of the turn a -> b -> c: 1 counter-clockwise, -1 clockwise, 0 collinear.
+// Exact for float coordinates (double filter, exact fallback only near zero).
+int point_orientation(const point_t a, const point_t b, const point_t c);
+
+// POLYGON_T Helpers
+
+uint32_t environment_polygon_count(const input_environment_t *env);
+const polygon_t *environment_polygon(const input_environment_t *env, uint32_t polygon_id);
+point_t polygon_vertex(const input_environment_t *env, const polygon_t *polygon, uint32_t vertex_index);
+polygon_edge_ref_t polygon_edge_ref(uint32_t polygon_id, uint32_t vertex_index);
+bool is_polygon_edge_ref_none(const polygon_edge_ref_t ref);
+
+// Coordinates of a referenced edge; POLYGON_EDGE_REF_NONE resolves to a zero edge.
+polygon_edge_t resolve_polygon_edge(const input_environment_t *env, const polygon_edge_ref_t ref);
+
 // 'Destructors'
 
 void free_polygon(polygon_t *polygon);
@@ -0,0 +1,186 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "float_format.h"
+
+#define FLOAT_FORMAT_EXACT_POW10 22         // 10^0 .. 10^22 are exact doubles
+#define FLOAT_FORMAT_MAX_DIGITS 9           // Always enough to round-trip a float
+
+static const double pow10_table[FLOAT_FORMAT_EXACT_POW10 + 1] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+static int format_shortest(float value, char *out);
+static int format_fixed(float value, int decimals, char *out);
+static int format_fallback(float value, char *out);
+static int write_decimal(bool negative, uint64_t mantissa, int exponent, char *out);
+static int write_digits(uint64_t value, char *out);
+
+int format_float(float value, int decimals, char out[FLOAT_FORMAT_BUFFER_SIZE])
+{
+	if (isnan(value) || isinf(value))
+	{
+		memcpy(out, "null", 5);
+		return 4;
+	}
+
+	if (value == 0.0f)
+	{
+		memcpy(out, "0", 2);
+		return 1;
+	}
+
+	if (decimals >= 0 && decimals <= FLOAT_FORMAT_MAX_DECIMALS)
+		return format_fixed(value, decimals, out);
+
+	return format_shortest(value, out);
+}
+
+// Tries 1..9 significant digits and keeps the first that parses back (strtod, then to
+// float, as cJSON and the UI read it) to the same value. All arithmetic stays on exact
+// operands, so each candidate costs one multiply, one divide and no printf.
+static int format_shortest(float value, char *out)
+{
+	double magnitude = fabs((double)value);
+	int leading_exponent = (int)floor(log10(magnitude));
+	if (leading_exponent >= -FLOAT_FORMAT_EXACT_POW10 && leading_exponent <= FLOAT_FORMAT_EXACT_POW10)
+	{
+		// log10 can land one off right at a power of ten
+		double leading = leading_exponent >= 0 ? pow10_table[leading_exponent] : 1.0 / pow10_table[-leading_exponent];
+		if (magnitude < leading)
+			leading_exponent--;
+	}
+
+	for (int digits = 1; digits <= FLOAT_FORMAT_MAX_DIGITS; ++digits)
+	{
+		int scale = digits - 1 - leading_exponent;
+		if (scale < -FLOAT_FORMAT_EXACT_POW10 || scale > FLOAT_FORMAT_EXACT_POW10)
+			break;
+
+		double scaled = scale >= 0 ? magnitude * pow10_table[scale] : magnitude / pow10_table[-scale];
+		uint64_t mantissa = (uint64_t)(scaled + 0.5);
+
+		double back = scale >= 0 ? (double)mantissa / pow10_table[scale] : (double)mantissa * pow10_table[-scale];
+		if ((float)back == fabsf(value))
+			return write_decimal(value < 0.0f, mantissa, scale, out);
+	}
+
+	return format_fallback(value, out);
+}
+
+static int format_fixed(float value, int decimals, char *out)
+{
+	double scaled = (double)value * pow10_table[decimals];
+	if (!(fabs(scaled) < 9.0e15))
+		return format_shortest(value, out);
+
+	int64_t rounded = llround(scaled);
+	if (rounded == 0)
+	{
+		memcpy(out, "0", 2);
+		return 1;
+	}
+
+	uint64_t mantissa = rounded < 0 ? (uint64_t)(-rounded) : (uint64_t)rounded;
+	return write_decimal(rounded < 0, mantissa, decimals, out);
+}
+
+// Values far outside the planner's coordinate range: same search through printf
+static int format_fallback(float value, char *out)
+{
+	int length = 0;
+	for (int digits = 1; digits <= FLOAT_FORMAT_MAX_DIGITS; ++digits)
+	{
+		length = snprintf(out, FLOAT_FORMAT_BUFFER_SIZE, "%.*g", digits, (double)value);
+		if ((float)strtod(out, NULL) == value)
+			break;
+	}
+	return length > 0 && length < FLOAT_FORMAT_BUFFER_SIZE ? length : 0;
+}
+
+// Prints mantissa * 10^-exponent like JavaScript's Number#toString: plain decimals
+// from 1e-7 up to 1e21, exponent notation outside
+static int write_decimal(bool negative, uint64_t mantissa, int exponent, char *out)
+{
+	while (mantissa % 10 == 0 && mantissa != 0)
+	{
+		mantissa /= 10;
+		exponent--;
+	}
+
+	char digits[24];
+	int digit_count = write_digits(mantissa, digits);
+	int leading_exponent = digit_count - 1 - exponent;
+
+	char *p = out;
+	if (negative)
+		*p++ = '-';
+
+	if (leading_exponent < -7 || leading_exponent >= 21)
+	{
+		*p++ = digits[0];
+		if (digit_count > 1)
+		{
+			*p++ = '.';
+			memcpy(p, digits + 1, (size_t)(digit_count - 1));
+			p += digit_count - 1;
+		}
+		*p++ = 'e';
+		if (leading_exponent < 0)
+		{
+			*p++ = '-';
+			leading_exponent = -leading_exponent;
+		}
+		else
+		{
+			*p++ = '+';
+		}
+		p += write_digits((uint64_t)leading_exponent, p);
+	}
+	else if (exponent <= 0)
+	{
+		memcpy(p, digits, (size_t)digit_count);
+		p += digit_count;
+		for (int i = 0; i < -exponent; ++i)
+			*p++ = '0';
+	}
+	else if (exponent < digit_count)
+	{
+		int integer_digits = digit_count - exponent;
+		memcpy(p, digits, (size_t)integer_digits);
+		p += integer_digits;
+		*p++ = '.';
+		memcpy(p, digits + integer_digits, (size_t)exponent);
+		p += exponent;
+	}
+	else
+	{
+		*p++ = '0';
+		*p++ = '.';
+		for (int i = 0; i < exponent - digit_count; ++i)
+			*p++ = '0';
+		memcpy(p, digits, (size_t)digit_count);
+		p += digit_count;
+	}
+
+	*p = '\0';
+	return (int)(p - out);
+}
+
+static int write_digits(uint64_t value, char *out)
+{
+	char reversed[24];
+	int count = 0;
+	do
+	{
+		reversed[count++] = (char)('0' + value % 10);
+		value /= 10;
+	} while (value != 0);
+
+	for (int i = 0; i < count; ++i)
+		out[i] = reversed[count - 1 - i];
+	return count;
+}
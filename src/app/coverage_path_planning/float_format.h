@@ -0,0 +1,16 @@
+// Float to text for every coordinate the planner emits, without going through printf
+
+#ifndef FLOAT_FORMAT_H
+#define FLOAT_FORMAT_H
+
+#define FLOAT_FORMAT_SHORTEST (-1)     // Fewest digits that still read back as the same float
+#define FLOAT_FORMAT_MAX_DECIMALS 9
+#define FLOAT_FORMAT_BUFFER_SIZE 32
+
+// Writes value as a JSON number into out (NUL-terminated) and returns its length.
+// decimals is FLOAT_FORMAT_SHORTEST or 0..FLOAT_FORMAT_MAX_DECIMALS fixed decimal
+// places, e.g. 3 for millimetres; trailing zeros are dropped either way.
+// NaN and infinities come out as null, like cJSON prints them.
+int format_float(float value, int decimals, char out[FLOAT_FORMAT_BUFFER_SIZE]);
+
+#endif // FLOAT_FORMAT_H
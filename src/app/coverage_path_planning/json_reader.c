@@ -0,0 +1,407 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "json_reader.h"
+
+#define JSON_READER_NUMBER_SIZE 64
+
+static void skip_whitespace(json_reader_t *reader);
+static bool consume(json_reader_t *reader, char ch);
+static bool consume_literal(json_reader_t *reader, const char *literal, size_t length);
+static void begin_container(json_reader_t *reader, char open);
+static bool end_container(json_reader_t *reader, char close);
+static bool next_in_container(json_reader_t *reader, char close);
+static bool parse_string(json_reader_t *reader, char *buffer, size_t size);
+static bool parse_hex4(const char *p, uint32_t *value);
+static size_t utf8_encode(uint32_t codepoint, char out[4]);
+static bool fail(json_reader_t *reader);
+
+void json_reader_init(json_reader_t *reader, const char *text, size_t length)
+{
+	memset(reader, 0, sizeof(*reader));
+	if (!text)
+	{
+		reader->failed = true;
+		return;
+	}
+
+	const char *nul = (const char *)memchr(text, '\0', length);
+	reader->cursor = text;
+	reader->end = nul ? nul : text + length;
+}
+
+json_reader_type_t json_reader_peek(json_reader_t *reader)
+{
+	skip_whitespace(reader);
+	if (reader->failed || reader->cursor == reader->end)
+		return JSON_READER_INVALID;
+
+	char ch = *reader->cursor;
+	switch (ch)
+	{
+	case 'n':
+		return JSON_READER_NULL;
+	case 'f':
+		return JSON_READER_FALSE;
+	case 't':
+		return JSON_READER_TRUE;
+	case '\"':
+		return JSON_READER_STRING;
+	case '[':
+		return JSON_READER_ARRAY;
+	case '{':
+		return JSON_READER_OBJECT;
+	default:
+		return (ch == '-' || (ch >= '0' && ch <= '9')) ? JSON_READER_NUMBER : JSON_READER_INVALID;
+	}
+}
+
+void json_reader_begin_object(json_reader_t *reader)
+{
+	begin_container(reader, '{');
+}
+
+void json_reader_begin_array(json_reader_t *reader)
+{
+	begin_container(reader, '[');
+}
+
+bool json_reader_next_member(json_reader_t *reader, char *key, size_t key_size)
+{
+	if (!next_in_container(reader, '}'))
+		return false;
+
+	skip_whitespace(reader);
+	if (!parse_string(reader, key, key_size) && reader->failed)
+		return false;
+
+	skip_whitespace(reader);
+	return consume(reader, ':');
+}
+
+bool json_reader_next_element(json_reader_t *reader)
+{
+	return next_in_container(reader, ']');
+}
+
+// Like cJSON: the longest run of number characters goes through strtod, and the value
+// ends where strtod stopped
+bool json_reader_number(json_reader_t *reader, double *value)
+{
+	if (json_reader_peek(reader) != JSON_READER_NUMBER)
+		return fail(reader);
+
+	size_t length = 0;
+	size_t available = (size_t)(reader->end - reader->cursor);
+	while (length < available && strchr("0123456789+-eE.", reader->cursor[length]) && reader->cursor[length] != '\0')
+		length++;
+
+	char local[JSON_READER_NUMBER_SIZE];
+	char *number = length < sizeof(local) ? local : (char *)malloc(length + 1);
+	if (!number)
+		return fail(reader);
+	memcpy(number, reader->cursor, length);
+	number[length] = '\0';
+
+	char *number_end = NULL;
+	double parsed = strtod(number, &number_end);
+	size_t consumed = (size_t)(number_end - number);
+	if (number != local)
+		free(number);
+
+	if (consumed == 0)
+		return fail(reader);
+
+	reader->cursor += consumed;
+	if (value)
+		*value = parsed;
+	return true;
+}
+
+bool json_reader_bool(json_reader_t *reader, bool *value)
+{
+	json_reader_type_t type = json_reader_peek(reader);
+	if (type == JSON_READER_TRUE && consume_literal(reader, "true", 4))
+	{
+		*value = true;
+		return true;
+	}
+	if (type == JSON_READER_FALSE && consume_literal(reader, "false", 5))
+	{
+		*value = false;
+		return true;
+	}
+	return fail(reader);
+}
+
+bool json_reader_string(json_reader_t *reader, char *buffer, size_t size)
+{
+	skip_whitespace(reader);
+	return parse_string(reader, buffer, size);
+}
+
+void json_reader_skip(json_reader_t *reader)
+{
+	switch (json_reader_peek(reader))
+	{
+	case JSON_READER_NULL:
+		consume_literal(reader, "null", 4);
+		break;
+	case JSON_READER_FALSE:
+		consume_literal(reader, "false", 5);
+		break;
+	case JSON_READER_TRUE:
+		consume_literal(reader, "true", 4);
+		break;
+	case JSON_READER_NUMBER:
+		json_reader_number(reader, NULL);
+		break;
+	case JSON_READER_STRING:
+		parse_string(reader, NULL, 0);
+		break;
+	case JSON_READER_ARRAY:
+		json_reader_begin_array(reader);
+		while (json_reader_next_element(reader))
+			json_reader_skip(reader);
+		break;
+	case JSON_READER_OBJECT:
+		json_reader_begin_object(reader);
+		while (json_reader_next_member(reader, NULL, 0))
+			json_reader_skip(reader);
+		break;
+	default:
+		fail(reader);
+		break;
+	}
+}
+
+// cJSON counts every control byte as whitespace
+static void skip_whitespace(json_reader_t *reader)
+{
+	while (reader->cursor < reader->end && (unsigned char)*reader->cursor <= 32)
+		reader->cursor++;
+}
+
+static bool consume(json_reader_t *reader, char ch)
+{
+	if (reader->failed || reader->cursor == reader->end || *reader->cursor != ch)
+		return fail(reader);
+
+	reader->cursor++;
+	return true;
+}
+
+static bool consume_literal(json_reader_t *reader, const char *literal, size_t length)
+{
+	if (reader->failed || (size_t)(reader->end - reader->cursor) < length ||
+		memcmp(reader->cursor, literal, length) != 0)
+		return fail(reader);
+
+	reader->cursor += length;
+	return true;
+}
+
+static void begin_container(json_reader_t *reader, char open)
+{
+	skip_whitespace(reader);
+	if (reader->depth >= JSON_READER_MAX_DEPTH)
+	{
+		fail(reader);
+		return;
+	}
+	if (!consume(reader, open))
+		return;
+
+	reader->depth++;
+	reader->container_empty = true;
+}
+
+static bool end_container(json_reader_t *reader, char close)
+{
+	if (!consume(reader, close) || reader->depth == 0)
+		return fail(reader);
+
+	// Back in the parent, which now holds at least this container
+	reader->depth--;
+	reader->container_empty = false;
+	return true;
+}
+
+// Steps over the separator before the next member, or over the closing bracket
+static bool next_in_container(json_reader_t *reader, char close)
+{
+	skip_whitespace(reader);
+	if (reader->failed)
+		return false;
+
+	if (reader->cursor < reader->end && *reader->cursor == close)
+	{
+		end_container(reader, close);
+		return false;
+	}
+
+	if (!reader->container_empty && !consume(reader, ','))
+		return false;
+
+	reader->container_empty = false;
+	return true;
+}
+
+// Reads a string token at the cursor. buffer may be NULL to only check and skip it.
+// Escapes and surrogate pairs follow cJSON's parse_string.
+static bool parse_string(json_reader_t *reader, char *buffer, size_t size)
+{
+	if (buffer && size > 0)
+		buffer[0] = '\0';
+	if (!consume(reader, '\"'))
+		return false;
+
+	size_t length = 0;
+	bool fits = buffer != NULL && size > 0;
+	const char *p = reader->cursor;
+	while (true)
+	{
+		if (p == reader->end)
+			return fail(reader);
+
+		char decoded[4];
+		size_t decoded_length = 1;
+		if (*p == '\"')
+		{
+			p++;
+			break;
+		}
+		else if (*p != '\\')
+		{
+			decoded[0] = *p++;
+		}
+		else
+		{
+			if (reader->end - p < 2)
+				return fail(reader);
+
+			switch (p[1])
+			{
+			case 'b':
+				decoded[0] = '\b';
+				break;
+			case 'f':
+				decoded[0] = '\f';
+				break;
+			case 'n':
+				decoded[0] = '\n';
+				break;
+			case 'r':
+				decoded[0] = '\r';
+				break;
+			case 't':
+				decoded[0] = '\t';
+				break;
+			case '\"':
+			case '\\':
+			case '/':
+				decoded[0] = p[1];
+				break;
+			case 'u':
+			{
+				uint32_t codepoint;
+				if (reader->end - p < 6 || !parse_hex4(p + 2, &codepoint))
+					return fail(reader);
+				// A low surrogate may only follow a high one
+				if (codepoint >= 0xDC00 && codepoint <= 0xDFFF)
+					return fail(reader);
+
+				if (codepoint >= 0xD800 && codepoint <= 0xDBFF)
+				{
+					uint32_t low;
+					if (reader->end - p < 12 || p[6] != '\\' || p[7] != 'u' || !parse_hex4(p + 8, &low) ||
+						low < 0xDC00 || low > 0xDFFF)
+						return fail(reader);
+					codepoint = 0x10000 + (((codepoint & 0x3FF) << 10) | (low & 0x3FF));
+					p += 6;
+				}
+				decoded_length = utf8_encode(codepoint, decoded);
+				p += 4;
+				break;
+			}
+			default:
+				return fail(reader);
+			}
+			p += 2;
+		}
+
+		if (fits && length + decoded_length < size)
+		{
+			memcpy(buffer + length, decoded, decoded_length);
+			length += decoded_length;
+		}
+		else
+		{
+			fits = false;
+		}
+	}
+
+	reader->cursor = p;
+	if (!fits)
+	{
+		if (buffer && size > 0)
+			buffer[0] = '\0';
+		return false;
+	}
+	buffer[length] = '\0';
+	return true;
+}
+
+static bool parse_hex4(const char *p, uint32_t *value)
+{
+	uint32_t result = 0;
+	for (int i = 0; i < 4; ++i)
+	{
+		char ch = p[i];
+		result <<= 4;
+		if (ch >= '0' && ch <= '9')
+			result |= (uint32_t)(ch - '0');
+		else if (ch >= 'a' && ch <= 'f')
+			result |= (uint32_t)(ch - 'a' + 10);
+		else if (ch >= 'A' && ch <= 'F')
+			result |= (uint32_t)(ch - 'A' + 10);
+		else
+			return false;
+	}
+	*value = result;
+	return true;
+}
+
+static size_t utf8_encode(uint32_t codepoint, char out[4])
+{
+	if (codepoint < 0x80)
+	{
+		out[0] = (char)codepoint;
+		return 1;
+	}
+	if (codepoint < 0x800)
+	{
+		out[0] = (char)(0xC0 | (codepoint >> 6));
+		out[1] = (char)(0x80 | (codepoint & 0x3F));
+		return 2;
+	}
+	if (codepoint < 0x10000)
+	{
+		out[0] = (char)(0xE0 | (codepoint >> 12));
+		out[1] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+		out[2] = (char)(0x80 | (codepoint & 0x3F));
+		return 3;
+	}
+	out[0] = (char)(0xF0 | (codepoint >> 18));
+	out[1] = (char)(0x80 | ((codepoint >> 12) & 0x3F));
+	out[2] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+	out[3] = (char)(0x80 | (codepoint & 0x3F));
+	return 4;
+}
+
+static bool fail(json_reader_t *reader)
+{
+	reader->failed = true;
+	return false;
+}
@@ -0,0 +1,66 @@
+// Pull JSON reader: walks a document in place, one value at a time, without building
+// a tree. Accepts exactly what cJSON_Parse accepts: the same number, string and escape
+// rules, any bytes up to 0x20 as whitespace, at most JSON_READER_MAX_DEPTH nested
+// containers, and whatever follows the first value is ignored.
+
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define JSON_READER_MAX_DEPTH 1000 // CJSON_NESTING_LIMIT
+
+typedef enum {
+    JSON_READER_INVALID = 0,    // End of input or a byte no value starts with
+    JSON_READER_NULL,
+    JSON_READER_FALSE,
+    JSON_READER_TRUE,
+    JSON_READER_NUMBER,
+    JSON_READER_STRING,
+    JSON_READER_ARRAY,
+    JSON_READER_OBJECT
+} json_reader_type_t;
+
+typedef struct
+{
+    const char *cursor;
+    const char *end;
+    bool failed;                // Syntax error or nesting too deep; every call after it is a no-op
+
+    uint32_t depth;
+    bool container_empty;       // No member read yet in the innermost open container
+} json_reader_t;
+
+// text need not be NUL-terminated; a NUL byte ends the document like it ends cJSON's input
+void json_reader_init(json_reader_t *reader, const char *text, size_t length);
+
+// Type of the next value, judged by its first byte; nothing is consumed
+json_reader_type_t json_reader_peek(json_reader_t *reader);
+
+// Enter the next value, which must be an object / array
+void json_reader_begin_object(json_reader_t *reader);
+void json_reader_begin_array(json_reader_t *reader);
+
+// Moves to the next member of the innermost object and reads its name into key
+// (NUL-terminated; "" if it does not fit), leaving the value to be read next.
+// Returns false once the closing brace has been consumed, or on failure.
+bool json_reader_next_member(json_reader_t *reader, char *key, size_t key_size);
+
+// Same for array elements
+bool json_reader_next_element(json_reader_t *reader);
+
+// Scalar values. Each consumes the next value, which must be of its type, and returns
+// false when it is not (the reader then fails).
+bool json_reader_number(json_reader_t *reader, double *value);
+bool json_reader_bool(json_reader_t *reader, bool *value);
+
+// Decodes the string into buffer (NUL-terminated). A string that does not fit is still
+// consumed, but buffer is left "" and the result is false without failing the reader.
+bool json_reader_string(json_reader_t *reader, char *buffer, size_t size);
+
+// Consumes the next value whatever it is, checking its syntax
+void json_reader_skip(json_reader_t *reader);
+
+#endif // JSON_READER_H
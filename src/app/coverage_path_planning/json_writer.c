@@ -0,0 +1,326 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "json_writer.h"
+
+#define JSON_WRITER_NUMBER_SIZE 26
+
+static bool reserve(json_writer_t *writer, size_t extra);
+static void append(json_writer_t *writer, const char *text, size_t length);
+static void begin_value(json_writer_t *writer);
+static void begin_container(json_writer_t *writer, char open);
+static void end_container(json_writer_t *writer, char close);
+static void append_escaped(json_writer_t *writer, const char *value);
+static bool compare_double(double a, double b);
+
+int json_writer_init(json_writer_t *writer, size_t initial_capacity)
+{
+	memset(writer, 0, sizeof(*writer));
+	writer->float_decimals = FLOAT_FORMAT_SHORTEST;
+
+	writer->capacity = initial_capacity > 0 ? initial_capacity : 256;
+	writer->buffer = (char *)malloc(writer->capacity);
+	if (!writer->buffer)
+	{
+		writer->capacity = 0;
+		writer->failed = true;
+		return -1;
+	}
+	return 0;
+}
+
+void json_writer_begin_object(json_writer_t *writer)
+{
+	begin_container(writer, '{');
+}
+
+void json_writer_end_object(json_writer_t *writer)
+{
+	end_container(writer, '}');
+}
+
+void json_writer_begin_array(json_writer_t *writer)
+{
+	begin_container(writer, '[');
+}
+
+void json_writer_end_array(json_writer_t *writer)
+{
+	end_container(writer, ']');
+}
+
+void json_writer_key(json_writer_t *writer, const char *key)
+{
+	begin_value(writer);
+	append_escaped(writer, key);
+	append(writer, ":", 1);
+	writer->after_key = true;
+}
+
+void json_writer_string(json_writer_t *writer, const char *value)
+{
+	begin_value(writer);
+	if (value)
+		append_escaped(writer, value);
+	else
+		append(writer, "null", 4);
+}
+
+// Same decision ladder as cJSON's print_number: integral values that fit an int print
+// as %d, everything else as %1.15g unless that does not read back, then %1.17g
+void json_writer_number(json_writer_t *writer, double value)
+{
+	char number[JSON_WRITER_NUMBER_SIZE];
+	int length;
+
+	// cJSON_CreateNumber saturates valueint
+	int as_int;
+	if (value >= INT_MAX)
+		as_int = INT_MAX;
+	else if (value <= (double)INT_MIN)
+		as_int = INT_MIN;
+	else
+		as_int = (int)value;
+
+	if (isnan(value) || isinf(value))
+	{
+		length = snprintf(number, sizeof(number), "null");
+	}
+	else if (value == (double)as_int)
+	{
+		length = snprintf(number, sizeof(number), "%d", as_int);
+	}
+	else
+	{
+		double test = 0.0;
+		length = snprintf(number, sizeof(number), "%1.15g", value);
+		if (sscanf(number, "%lg", &test) != 1 || !compare_double(test, value))
+			length = snprintf(number, sizeof(number), "%1.17g", value);
+	}
+
+	if (length < 0 || length >= (int)sizeof(number))
+	{
+		writer->failed = true;
+		return;
+	}
+
+	begin_value(writer);
+	append(writer, number, (size_t)length);
+}
+
+void json_writer_float(json_writer_t *writer, float value)
+{
+	char number[FLOAT_FORMAT_BUFFER_SIZE];
+	int length = format_float(value, writer->float_decimals, number);
+	if (length <= 0)
+	{
+		writer->failed = true;
+		return;
+	}
+
+	begin_value(writer);
+	append(writer, number, (size_t)length);
+}
+
+void json_writer_int(json_writer_t *writer, int value)
+{
+	json_writer_int64(writer, value);
+}
+
+void json_writer_int64(json_writer_t *writer, int64_t value)
+{
+	char number[JSON_WRITER_NUMBER_SIZE];
+	char *end = number + sizeof(number);
+	char *p = end;
+
+	// Negate through uint64_t so INT64_MIN survives
+	uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+	do
+	{
+		*--p = (char)('0' + magnitude % 10);
+		magnitude /= 10;
+	} while (magnitude != 0);
+	if (value < 0)
+		*--p = '-';
+
+	begin_value(writer);
+	append(writer, p, (size_t)(end - p));
+}
+
+void json_writer_bool(json_writer_t *writer, bool value)
+{
+	begin_value(writer);
+	if (value)
+		append(writer, "true", 4);
+	else
+		append(writer, "false", 5);
+}
+
+char *json_writer_finish(json_writer_t *writer)
+{
+	char *json = NULL;
+	if (!writer->failed && writer->depth == 0 && reserve(writer, 1))
+	{
+		writer->buffer[writer->length] = '\0';
+		json = writer->buffer;
+		writer->buffer = NULL;
+	}
+
+	free_json_writer(writer);
+	return json;
+}
+
+void free_json_writer(json_writer_t *writer)
+{
+	if (!writer)
+		return;
+
+	free(writer->buffer);
+	memset(writer, 0, sizeof(*writer));
+}
+
+// Doubles the buffer until extra more bytes fit
+static bool reserve(json_writer_t *writer, size_t extra)
+{
+	if (writer->failed)
+		return false;
+
+	if (writer->capacity - writer->length >= extra)
+		return true;
+
+	size_t capacity = writer->capacity > 0 ? writer->capacity : 256;
+	while (capacity - writer->length < extra)
+	{
+		if (capacity > SIZE_MAX / 2)
+		{
+			writer->failed = true;
+			return false;
+		}
+		capacity *= 2;
+	}
+
+	char *buffer = (char *)realloc(writer->buffer, capacity);
+	if (!buffer)
+	{
+		writer->failed = true;
+		return false;
+	}
+	writer->buffer = buffer;
+	writer->capacity = capacity;
+	return true;
+}
+
+static void append(json_writer_t *writer, const char *text, size_t length)
+{
+	if (!reserve(writer, length))
+		return;
+
+	memcpy(writer->buffer + writer->length, text, length);
+	writer->length += length;
+}
+
+// Separates the value from its predecessor in the current container
+static void begin_value(json_writer_t *writer)
+{
+	if (writer->after_key)
+	{
+		writer->after_key = false;
+		return;
+	}
+
+	if (writer->depth > 0)
+	{
+		if (writer->has_member[writer->depth - 1])
+			append(writer, ",", 1);
+		writer->has_member[writer->depth - 1] = true;
+	}
+}
+
+static void begin_container(json_writer_t *writer, char open)
+{
+	begin_value(writer);
+
+	if (writer->depth == JSON_WRITER_MAX_DEPTH)
+	{
+		writer->failed = true;
+		return;
+	}
+
+	append(writer, &open, 1);
+	writer->has_member[writer->depth++] = false;
+}
+
+static void end_container(json_writer_t *writer, char close)
+{
+	if (writer->depth == 0)
+	{
+		writer->failed = true;
+		return;
+	}
+
+	writer->depth--;
+	append(writer, &close, 1);
+}
+
+// Escapes like cJSON: short forms for the usual suspects, \u00xx for other control bytes
+static void append_escaped(json_writer_t *writer, const char *value)
+{
+	append(writer, "\"", 1);
+
+	const char *run = value;
+	for (const char *p = value; *p != '\0'; ++p)
+	{
+		unsigned char ch = (unsigned char)*p;
+		if (ch >= 32 && ch != '\"' && ch != '\\')
+			continue;
+
+		append(writer, run, (size_t)(p - run));
+		run = p + 1;
+
+		char escape[8];
+		int length = 2;
+		escape[0] = '\\';
+		switch (ch)
+		{
+		case '\"':
+			escape[1] = '\"';
+			break;
+		case '\\':
+			escape[1] = '\\';
+			break;
+		case '\b':
+			escape[1] = 'b';
+			break;
+		case '\f':
+			escape[1] = 'f';
+			break;
+		case '\n':
+			escape[1] = 'n';
+			break;
+		case '\r':
+			escape[1] = 'r';
+			break;
+		case '\t':
+			escape[1] = 't';
+			break;
+		default:
+			length = snprintf(escape, sizeof(escape), "\\u%04x", ch);
+			break;
+		}
+		append(writer, escape, (size_t)length);
+	}
+	append(writer, run, strlen(run));
+
+	append(writer, "\"", 1);
+}
+
+static bool compare_double(double a, double b)
+{
+	double max_value = fabs(a) > fabs(b) ? fabs(a) : fabs(b);
+	return fabs(a - b) <= max_value * DBL_EPSILON;
+}
@@ -0,0 +1,52 @@
+// Streaming JSON writer: appends straight into one growable buffer, no per-value nodes.
+// Apart from json_writer_float, output is byte-for-byte what cJSON_PrintUnformatted
+// prints for the same document.
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "float_format.h"
+
+#define JSON_WRITER_MAX_DEPTH 32
+
+typedef struct
+{
+    char *buffer;               // malloc()ed so the result can outlive the request arena
+    size_t length;
+    size_t capacity;
+    bool failed;                // Out of memory or nesting too deep; the writer stops writing
+    int float_decimals;         // For json_writer_float: FLOAT_FORMAT_SHORTEST (the default) or fixed decimals
+
+    uint32_t depth;
+    bool has_member[JSON_WRITER_MAX_DEPTH]; // Current container already holds a value
+    bool after_key;             // Next value belongs to a key just written, no comma
+} json_writer_t;
+
+int json_writer_init(json_writer_t *writer, size_t initial_capacity);
+
+void json_writer_begin_object(json_writer_t *writer);
+void json_writer_end_object(json_writer_t *writer);
+void json_writer_begin_array(json_writer_t *writer);
+void json_writer_end_array(json_writer_t *writer);
+
+// Object member name; the value written next belongs to it
+void json_writer_key(json_writer_t *writer, const char *key);
+
+void json_writer_string(json_writer_t *writer, const char *value);
+void json_writer_number(json_writer_t *writer, double value);
+// Coordinates: printed by format_float with the writer's float_decimals
+void json_writer_float(json_writer_t *writer, float value);
+void json_writer_int(json_writer_t *writer, int value);
+void json_writer_int64(json_writer_t *writer, int64_t value);
+void json_writer_bool(json_writer_t *writer, bool value);
+
+// Returns the NUL-terminated document (caller must free()), or NULL if anything failed.
+// The writer is reset either way.
+char *json_writer_finish(json_writer_t *writer);
+
+void free_json_writer(json_writer_t *writer);
+
+#endif // JSON_WRITER_H
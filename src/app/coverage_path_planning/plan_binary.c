@@ -0,0 +1,233 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "plan_binary.h"
+
+// Sections are written and read in place, so the host has to share the layout's byte order
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "plan_binary: the binary plan layout is little-endian"
+#endif
+
+#define PLAN_BINARY_ELEMENT_SIZE 4
+
+static bool reserve(plan_binary_writer_t *writer, size_t extra);
+static void pad_to_alignment(plan_binary_writer_t *writer);
+static plan_binary_section_t *section_entry(plan_binary_writer_t *writer, uint16_t index);
+
+bool plan_binary_is_plan(const void *data, size_t length)
+{
+	if (!data || length < sizeof(plan_binary_header_t))
+		return false;
+
+	uint32_t magic;
+	memcpy(&magic, data, sizeof(magic));
+	return magic == PLAN_BINARY_MAGIC;
+}
+
+int plan_binary_open(const void *data, size_t length, plan_binary_view_t *view)
+{
+	if (!view)
+		return -1;
+	memset(view, 0, sizeof(*view));
+
+	if (!plan_binary_is_plan(data, length) || ((uintptr_t)data % PLAN_BINARY_ELEMENT_SIZE) != 0)
+		return -1;
+
+	const plan_binary_header_t *header = (const plan_binary_header_t *)data;
+	if (header->version != PLAN_BINARY_VERSION || header->total_length > length)
+		return -1;
+
+	size_t table_end = sizeof(plan_binary_header_t) + (size_t)header->section_count * sizeof(plan_binary_section_t);
+	if (table_end > header->total_length)
+		return -1;
+
+	const plan_binary_section_t *sections = (const plan_binary_section_t *)(header + 1);
+	for (uint16_t i = 0; i < header->section_count; ++i)
+	{
+		const plan_binary_section_t *section = &sections[i];
+		if (section->offset < table_end || section->offset % PLAN_BINARY_ALIGNMENT != 0)
+			return -1;
+		if ((uint64_t)section->offset + (uint64_t)section->count * PLAN_BINARY_ELEMENT_SIZE > header->total_length)
+			return -1;
+	}
+
+	view->data = (const uint8_t *)data;
+	view->length = header->total_length;
+	view->sections = sections;
+	view->section_count = header->section_count;
+	return 0;
+}
+
+const void *plan_binary_section(const plan_binary_view_t *view,
+								plan_binary_section_id_t id,
+								plan_binary_element_type_t element_type,
+								uint32_t *count)
+{
+	if (count)
+		*count = 0;
+	if (!view || !view->data)
+		return NULL;
+
+	for (uint16_t i = 0; i < view->section_count; ++i)
+	{
+		const plan_binary_section_t *section = &view->sections[i];
+		if (section->id != (uint32_t)id)
+			continue;
+		if (section->element_type != (uint32_t)element_type)
+			return NULL;
+
+		if (count)
+			*count = section->count;
+		return view->data + section->offset;
+	}
+	return NULL;
+}
+
+int plan_binary_writer_init(plan_binary_writer_t *writer, uint16_t section_count, size_t initial_capacity)
+{
+	memset(writer, 0, sizeof(*writer));
+	writer->section_capacity = section_count;
+
+	// Header and the whole table up front; their contents are filled in as sections begin
+	size_t table_end = sizeof(plan_binary_header_t) + (size_t)section_count * sizeof(plan_binary_section_t);
+	writer->capacity = initial_capacity > table_end ? initial_capacity : table_end + 256;
+	writer->buffer = (uint8_t *)malloc(writer->capacity);
+	if (!writer->buffer)
+	{
+		writer->capacity = 0;
+		writer->failed = true;
+		return -1;
+	}
+
+	memset(writer->buffer, 0, table_end);
+	writer->length = table_end;
+	return 0;
+}
+
+void plan_binary_begin_section(plan_binary_writer_t *writer,
+							   plan_binary_section_id_t id,
+							   plan_binary_element_type_t element_type)
+{
+	if (writer->failed)
+		return;
+	if (writer->section_count == writer->section_capacity)
+	{
+		writer->failed = true;
+		return;
+	}
+
+	pad_to_alignment(writer);
+	if (writer->failed || writer->length > UINT32_MAX)
+	{
+		writer->failed = true;
+		return;
+	}
+
+	plan_binary_section_t *section = section_entry(writer, writer->section_count++);
+	section->id = (uint32_t)id;
+	section->element_type = (uint32_t)element_type;
+	section->offset = (uint32_t)writer->length;
+	section->count = 0;
+}
+
+void plan_binary_append(plan_binary_writer_t *writer, const void *elements, size_t count)
+{
+	if (writer->failed || count == 0)
+		return;
+	if (writer->section_count == 0)
+	{
+		writer->failed = true;
+		return;
+	}
+
+	plan_binary_section_t *section = section_entry(writer, writer->section_count - 1);
+	if (count > UINT32_MAX - section->count || !reserve(writer, count * PLAN_BINARY_ELEMENT_SIZE))
+	{
+		writer->failed = true;
+		return;
+	}
+
+	// reserve() may have moved the buffer
+	section = section_entry(writer, writer->section_count - 1);
+	memcpy(writer->buffer + writer->length, elements, count * PLAN_BINARY_ELEMENT_SIZE);
+	writer->length += count * PLAN_BINARY_ELEMENT_SIZE;
+	section->count += (uint32_t)count;
+}
+
+uint8_t *plan_binary_finish(plan_binary_writer_t *writer, size_t *length)
+{
+	uint8_t *plan = NULL;
+	if (!writer->failed && writer->section_count == writer->section_capacity && writer->length <= UINT32_MAX)
+	{
+		plan_binary_header_t header = {0};
+		header.magic = PLAN_BINARY_MAGIC;
+		header.version = PLAN_BINARY_VERSION;
+		header.section_count = writer->section_count;
+		header.total_length = (uint32_t)writer->length;
+		memcpy(writer->buffer, &header, sizeof(header));
+
+		plan = writer->buffer;
+		if (length)
+			*length = writer->length;
+		writer->buffer = NULL;
+	}
+
+	free_plan_binary_writer(writer);
+	return plan;
+}
+
+void free_plan_binary_writer(plan_binary_writer_t *writer)
+{
+	if (!writer)
+		return;
+
+	free(writer->buffer);
+	memset(writer, 0, sizeof(*writer));
+}
+
+// Doubles the buffer until extra more bytes fit
+static bool reserve(plan_binary_writer_t *writer, size_t extra)
+{
+	if (writer->failed)
+		return false;
+
+	if (writer->capacity - writer->length >= extra)
+		return true;
+
+	size_t capacity = writer->capacity > 0 ? writer->capacity : 256;
+	while (capacity - writer->length < extra)
+	{
+		if (capacity > SIZE_MAX / 2)
+		{
+			writer->failed = true;
+			return false;
+		}
+		capacity *= 2;
+	}
+
+	uint8_t *buffer = (uint8_t *)realloc(writer->buffer, capacity);
+	if (!buffer)
+	{
+		writer->failed = true;
+		return false;
+	}
+	writer->buffer = buffer;
+	writer->capacity = capacity;
+	return true;
+}
+
+static void pad_to_alignment(plan_binary_writer_t *writer)
+{
+	size_t padding = (PLAN_BINARY_ALIGNMENT - writer->length % PLAN_BINARY_ALIGNMENT) % PLAN_BINARY_ALIGNMENT;
+	if (padding == 0 || !reserve(writer, padding))
+		return;
+
+	memset(writer->buffer + writer->length, 0, padding);
+	writer->length += padding;
+}
+
+static plan_binary_section_t *section_entry(plan_binary_writer_t *writer, uint16_t index)
+{
+	return (plan_binary_section_t *)(writer->buffer + sizeof(plan_binary_header_t)) + index;
+}
@@ -0,0 +1,142 @@
+// Binary planning result, served instead of JSON to clients that send
+// "Accept: application/vnd.bladeofgrass.plan". Only needs the C standard headers, so
+// other C programs (the robot uploader) can include it as is.
+//
+// Layout, version 1. Every number is little-endian; coordinates are float32 metres.
+//
+//   0           header         plan_binary_header_t, 16 bytes
+//   16          section table  section_count x plan_binary_section_t, 16 bytes each
+//   then        section data   each section starts on an 8-byte boundary, zero padded
+//
+// A section is one contiguous array of count float32 or int32 elements at offset
+// bytes from the start of the plan. Readers look sections up by id and view them in
+// place (typed arrays, or a cast in C); ids they do not know are skipped. Sections of
+// output the request did not ask for ("outputSections") are absent.
+//
+//   id  section              type     elements per record
+//   1   SIMPLIFICATION       int32    2: input vertices, output vertices (only if the pre-pass ran)
+//   2   EVENT_INFO           int32    2 per event: polygon type (0 boundary, 1 obstacle), event type
+//   3   EVENT_VERTICES       float32  2 per event: x, y
+//   4   EVENT_EDGES          float32  8 per event: floor edge bx, by, ex, ey, then ceiling edge
+//   5   CELL_INFO            int32    8 per cell: ceiling edge first, count, floor edge first, count,
+//                                     open, visited, cleaned, 0
+//   6   CELL_CORNERS         float32  8 per cell: c_begin, c_end, f_begin, f_end (x, y each)
+//   7   CELL_EDGES           float32  4 per edge: bx, by, ex, ey; cells index runs of it
+//   8   CELL_GRAPH_OFFSETS   int32    cell count + 1: neighbors of cell i are [offsets[i], offsets[i + 1])
+//   9   CELL_GRAPH_NEIGHBORS int32    1 per adjacency
+//   10  PATH                 int32    1 per visit: cell index
+//   11  MOTION_INFO          int32    4 per motion section: coverage first point, count,
+//                                     navigation first point, count
+//   12  MOTION_POINTS        float32  2 per point: x, y
+//   13  CELL_ORDER           float32  2: transit length, adjacency-order transit length
+//                                     (only for "cellOrder": "travel" with a motion plan)
+//
+// Event types: 0 B_IN, 1 B_SIDE_IN, 2 B_INIT, 3 B_OUT, 4 B_SIDE_OUT, 5 B_DEINIT,
+// 6 IN, 7 SIDE_IN, 8 OUT, 9 SIDE_OUT, 10 FLOOR, 11 CEILING.
+// Errors are never binary: they come back as the usual JSON error object.
+
+#ifndef PLAN_BINARY_H
+#define PLAN_BINARY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PLAN_BINARY_CONTENT_TYPE "application/vnd.bladeofgrass.plan"
+#define PLAN_BINARY_MAGIC 0x4C504742u      // "BGPL"
+#define PLAN_BINARY_VERSION 1
+#define PLAN_BINARY_ALIGNMENT 8
+
+typedef enum {
+    PLAN_BINARY_FLOAT32 = 1,
+    PLAN_BINARY_INT32 = 2
+} plan_binary_element_type_t;
+
+typedef enum {
+    PLAN_SECTION_SIMPLIFICATION = 1,
+    PLAN_SECTION_EVENT_INFO = 2,
+    PLAN_SECTION_EVENT_VERTICES = 3,
+    PLAN_SECTION_EVENT_EDGES = 4,
+    PLAN_SECTION_CELL_INFO = 5,
+    PLAN_SECTION_CELL_CORNERS = 6,
+    PLAN_SECTION_CELL_EDGES = 7,
+    PLAN_SECTION_CELL_GRAPH_OFFSETS = 8,
+    PLAN_SECTION_CELL_GRAPH_NEIGHBORS = 9,
+    PLAN_SECTION_PATH = 10,
+    PLAN_SECTION_MOTION_INFO = 11,
+    PLAN_SECTION_MOTION_POINTS = 12,
+    PLAN_SECTION_CELL_ORDER = 13
+} plan_binary_section_id_t;
+
+typedef struct
+{
+    uint32_t magic;             // PLAN_BINARY_MAGIC
+    uint16_t version;           // PLAN_BINARY_VERSION
+    uint16_t section_count;
+    uint32_t total_length;      // Bytes, header included
+    uint32_t reserved;          // 0
+} plan_binary_header_t;
+
+typedef struct
+{
+    uint32_t id;                // plan_binary_section_id_t
+    uint32_t element_type;      // plan_binary_element_type_t
+    uint32_t offset;            // From the start of the plan, multiple of PLAN_BINARY_ALIGNMENT
+    uint32_t count;             // Elements, 4 bytes each
+} plan_binary_section_t;
+
+// --- READING
+
+typedef struct
+{
+    const uint8_t *data;
+    size_t length;
+    const plan_binary_section_t *sections;
+    uint16_t section_count;
+} plan_binary_view_t;
+
+// True when data starts like a binary plan (it may still be truncated)
+bool plan_binary_is_plan(const void *data, size_t length);
+
+// Checks the header and that every section lies inside data. data must stay alive
+// and 4-byte aligned while the view is used. Returns 0, or -1 if it is not a valid plan.
+int plan_binary_open(const void *data, size_t length, plan_binary_view_t *view);
+
+// Start of section id if present with the given element type, NULL otherwise.
+// *count receives its element count (0 when absent).
+const void *plan_binary_section(const plan_binary_view_t *view,
+                                plan_binary_section_id_t id,
+                                plan_binary_element_type_t element_type,
+                                uint32_t *count);
+
+// --- WRITING
+
+typedef struct
+{
+    uint8_t *buffer;            // malloc()ed, like json_writer_t's
+    size_t length;
+    size_t capacity;
+    bool failed;                // Out of memory, too many sections or elements; the writer stops writing
+
+    uint16_t section_capacity;  // Table entries reserved by plan_binary_writer_init
+    uint16_t section_count;     // Sections begun so far; the last one is being appended to
+} plan_binary_writer_t;
+
+// section_count is the exact number of sections that will be written
+int plan_binary_writer_init(plan_binary_writer_t *writer, uint16_t section_count, size_t initial_capacity);
+
+// Starts the next section; elements appended from here on belong to it
+void plan_binary_begin_section(plan_binary_writer_t *writer,
+                               plan_binary_section_id_t id,
+                               plan_binary_element_type_t element_type);
+
+// Copies count 4-byte elements (float or int32_t, host order) into the current section
+void plan_binary_append(plan_binary_writer_t *writer, const void *elements, size_t count);
+
+// Returns the finished plan (caller must free()) and its size, or NULL if anything
+// failed or fewer sections than announced were written. The writer is reset either way.
+uint8_t *plan_binary_finish(plan_binary_writer_t *writer, size_t *length);
+
+void free_plan_binary_writer(plan_binary_writer_t *writer);
+
+#endif // PLAN_BINARY_H
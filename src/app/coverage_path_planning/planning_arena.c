@@ -0,0 +1,195 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "planning_arena.h"
+#include "../../../dependencies/cJSON/cJSON.h"
+
+#define ARENA_ALIGNMENT 16
+#define ARENA_HEADER_SIZE 16                    // Holds the allocation size, keeps payloads aligned
+#define ARENA_FIRST_BLOCK_SIZE (64 * 1024)
+#define ARENA_MAX_BLOCK_SIZE (16 * 1024 * 1024)
+
+struct planning_arena_block_t
+{
+	planning_arena_block_t *next;               // Next older block
+	char *begin;
+	char *top;
+	char *end;
+};
+
+static _Thread_local planning_arena_t *bound_arena = NULL;
+
+static size_t align_size(size_t size);
+static size_t payload_size(size_t size);
+static void *arena_alloc(planning_arena_t *arena, size_t size);
+static bool arena_owns(const planning_arena_t *arena, const void *ptr);
+static size_t arena_allocation_size(const void *ptr);
+
+void planning_arena_init(planning_arena_t *arena)
+{
+	arena->blocks = NULL;
+	arena->block_count = 0;
+	arena->reserved_bytes = 0;
+}
+
+void planning_arena_release(planning_arena_t *arena)
+{
+	if (!arena)
+		return;
+
+	planning_arena_block_t *block = arena->blocks;
+	while (block)
+	{
+		planning_arena_block_t *next = block->next;
+		free(block);
+		block = next;
+	}
+
+	planning_arena_init(arena);
+}
+
+void planning_arena_bind(planning_arena_t *arena)
+{
+	bound_arena = arena;
+}
+
+bool planning_arena_is_bound(void)
+{
+	return bound_arena != NULL;
+}
+
+void *planning_malloc(size_t size)
+{
+	if (!bound_arena)
+		return malloc(size);
+
+	return arena_alloc(bound_arena, size);
+}
+
+void *planning_calloc(size_t count, size_t size)
+{
+	if (!bound_arena)
+		return calloc(count, size);
+
+	if (size != 0 && count > SIZE_MAX / size)
+		return NULL;
+
+	void *ptr = arena_alloc(bound_arena, count * size);
+	if (ptr)
+		memset(ptr, 0, count * size);
+	return ptr;
+}
+
+void *planning_realloc(void *ptr, size_t size)
+{
+	if (!ptr)
+		return planning_malloc(size);
+
+	if (!bound_arena || !arena_owns(bound_arena, ptr))
+		return realloc(ptr, size);
+
+	size_t old_size = arena_allocation_size(ptr);
+	if (size <= old_size)
+		return ptr;
+
+	// Most growth (cvector push_back) hits the latest allocation: extend it in place
+	planning_arena_block_t *head = bound_arena->blocks;
+	char *payload_end = (char *)ptr + payload_size(old_size);
+	size_t extra = payload_size(size) - payload_size(old_size);
+	if (payload_end == head->top && (size_t)(head->end - head->top) >= extra)
+	{
+		head->top += extra;
+		memcpy((char *)ptr - ARENA_HEADER_SIZE, &size, sizeof(size));
+		return ptr;
+	}
+
+	void *grown = arena_alloc(bound_arena, size);
+	if (grown)
+		memcpy(grown, ptr, old_size);
+	return grown;
+}
+
+void planning_free(void *ptr)
+{
+	if (!ptr)
+		return;
+
+	if (bound_arena && arena_owns(bound_arena, ptr))
+		return;
+
+	free(ptr);
+}
+
+void planning_arena_install_hooks(void)
+{
+	cJSON_Hooks hooks;
+	hooks.malloc_fn = planning_malloc;
+	hooks.free_fn = planning_free;
+	cJSON_InitHooks(&hooks);
+}
+
+static size_t align_size(size_t size)
+{
+	return (size + (ARENA_ALIGNMENT - 1)) & ~(size_t)(ARENA_ALIGNMENT - 1);
+}
+
+// Zero-size requests still take a slot so the pointer lies inside its block
+static size_t payload_size(size_t size)
+{
+	return align_size(size > 0 ? size : 1);
+}
+
+static void *arena_alloc(planning_arena_t *arena, size_t size)
+{
+	size_t needed = ARENA_HEADER_SIZE + payload_size(size);
+	planning_arena_block_t *head = arena->blocks;
+
+	if (!head || (size_t)(head->end - head->top) < needed)
+	{
+		size_t capacity = head ? (size_t)(head->end - head->begin) * 2 : ARENA_FIRST_BLOCK_SIZE;
+		if (capacity > ARENA_MAX_BLOCK_SIZE)
+			capacity = ARENA_MAX_BLOCK_SIZE;
+		if (capacity < needed)
+			capacity = needed;
+
+		size_t header = align_size(sizeof(planning_arena_block_t));
+		planning_arena_block_t *block = (planning_arena_block_t *)malloc(header + capacity);
+		if (!block)
+			return NULL;
+
+		block->begin = (char *)block + header;
+		block->top = block->begin;
+		block->end = block->begin + capacity;
+		block->next = head;
+		arena->blocks = block;
+		arena->block_count++;
+		arena->reserved_bytes += capacity;
+		head = block;
+	}
+
+	memcpy(head->top, &size, sizeof(size));
+	void *ptr = head->top + ARENA_HEADER_SIZE;
+	head->top += needed;
+	return ptr;
+}
+
+static bool arena_owns(const planning_arena_t *arena, const void *ptr)
+{
+	const char *p = (const char *)ptr;
+
+	for (const planning_arena_block_t *block = arena->blocks; block; block = block->next)
+	{
+		if (p >= block->begin && p < block->top)
+			return true;
+	}
+	return false;
+}
+
+static size_t arena_allocation_size(const void *ptr)
+{
+	size_t size;
+	memcpy(&size, (const char *)ptr - ARENA_HEADER_SIZE, sizeof(size));
+	return size;
+}
@@ -0,0 +1,45 @@
+// Per-request bump allocator. While an arena is bound to the calling thread, cvector,
+// cJSON and the planner's small allocations come from it and are released together.
+// Include this header before cvector.h so the cvector_clib_* overrides take effect.
+
+#ifndef PLANNING_ARENA_H
+#define PLANNING_ARENA_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef struct planning_arena_block_t planning_arena_block_t;
+
+typedef struct
+{
+    planning_arena_block_t *blocks;     // Newest first; allocations bump the head block
+    size_t block_count;
+    size_t reserved_bytes;
+} planning_arena_t;
+
+void planning_arena_init(planning_arena_t *arena);
+
+// Frees every block at once; pointers handed out by the arena become invalid.
+void planning_arena_release(planning_arena_t *arena);
+
+// Binds arena to the calling thread (NULL unbinds).
+void planning_arena_bind(planning_arena_t *arena);
+bool planning_arena_is_bound(void);
+
+// Route to the bound arena, or to libc when none is bound. free() of arena memory is a
+// no-op and pointers the arena does not own go back to libc, so memory from other
+// threads or from before the bind can be mixed in safely.
+void *planning_malloc(size_t size);
+void *planning_calloc(size_t count, size_t size);
+void *planning_realloc(void *ptr, size_t size);
+void planning_free(void *ptr);
+
+// cJSON allocations follow the same routing; call once at start-up.
+void planning_arena_install_hooks(void);
+
+#define cvector_clib_malloc planning_malloc
+#define cvector_clib_calloc planning_calloc
+#define cvector_clib_realloc planning_realloc
+#define cvector_clib_free planning_free
+
+#endif // PLANNING_ARENA_H
@@ -0,0 +1,316 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "coverage_path_planning.h"
+#include "polygon_simplification.h"
+#include "planning_arena.h"
+
+#define SIMPLIFY_REMOVED UINT32_MAX
+
+// Per-polygon working set, sized once for the largest polygon
+typedef struct
+{
+	uint32_t *prev;
+	uint32_t *next;
+	double *cost;		// Error bound of the outline if the vertex were removed now
+	double *seg_err;	// Error bound already absorbed by the segment vertex -> next[vertex]
+	uint32_t *heap;
+	uint32_t *heap_pos; // SIMPLIFY_REMOVED once the vertex is gone
+	uint32_t heap_size;
+} simplify_scratch_t;
+
+static int init_simplify_scratch(simplify_scratch_t *scratch,
+								 uint32_t capacity);
+static void free_simplify_scratch(simplify_scratch_t *scratch);
+
+static uint32_t simplify_polygon(input_environment_t *env,
+								 polygon_t *polygon,
+								 uint32_t write_offset,
+								 double tolerance,
+								 simplify_scratch_t *scratch);
+
+static double removal_cost(const float *xs,
+						   const float *ys,
+						   const simplify_scratch_t *scratch,
+						   uint32_t vertex);
+static double point_segment_distance(double px, double py,
+									 double ax, double ay,
+									 double bx, double by);
+
+static bool heap_less(const simplify_scratch_t *scratch, uint32_t a, uint32_t b);
+static void heap_swap(simplify_scratch_t *scratch, uint32_t i, uint32_t j);
+static void heap_sift_up(simplify_scratch_t *scratch, uint32_t i);
+static void heap_sift_down(simplify_scratch_t *scratch, uint32_t i);
+static uint32_t heap_pop(simplify_scratch_t *scratch);
+static void heap_update(simplify_scratch_t *scratch, uint32_t vertex);
+
+int simplify_input_environment(input_environment_t *env,
+							   float tolerance,
+							   simplification_report_t *report)
+{
+	if (!env)
+		return -1;
+
+	uint32_t polygon_count = environment_polygon_count(env);
+	uint32_t max_vertex_count = 0;
+	for (uint32_t i = 0; i < polygon_count; ++i)
+	{
+		const polygon_t *polygon = environment_polygon(env, i);
+		if (polygon->vertex_count > max_vertex_count)
+			max_vertex_count = polygon->vertex_count;
+	}
+
+	if (report)
+	{
+		report->input_vertex_count = env->vertex_pool.count;
+		report->output_vertex_count = env->vertex_pool.count;
+	}
+
+	simplify_scratch_t scratch;
+	if (init_simplify_scratch(&scratch, max_vertex_count) != 0)
+		return -2;
+
+	// Polygons are stored back to back in the pool, so compacting in order never
+	// overwrites vertices that have not been read yet
+	uint32_t write_offset = 0;
+	for (uint32_t i = 0; i < polygon_count; ++i)
+	{
+		polygon_t *polygon = (polygon_t *)environment_polygon(env, i);
+		write_offset += simplify_polygon(env, polygon, write_offset, tolerance > 0.0f ? tolerance : 0.0, &scratch);
+	}
+	env->vertex_pool.count = write_offset;
+
+	free_simplify_scratch(&scratch);
+
+	if (report)
+		report->output_vertex_count = env->vertex_pool.count;
+
+	return 0;
+}
+
+static int init_simplify_scratch(simplify_scratch_t *scratch,
+								 uint32_t capacity)
+{
+	size_t n = capacity > 0 ? (size_t)capacity : 1;
+
+	scratch->prev = (uint32_t *)planning_malloc(n * sizeof(uint32_t));
+	scratch->next = (uint32_t *)planning_malloc(n * sizeof(uint32_t));
+	scratch->cost = (double *)planning_malloc(n * sizeof(double));
+	scratch->seg_err = (double *)planning_malloc(n * sizeof(double));
+	scratch->heap = (uint32_t *)planning_malloc(n * sizeof(uint32_t));
+	scratch->heap_pos = (uint32_t *)planning_malloc(n * sizeof(uint32_t));
+	scratch->heap_size = 0;
+
+	if (!scratch->prev || !scratch->next || !scratch->cost ||
+		!scratch->seg_err || !scratch->heap || !scratch->heap_pos)
+	{
+		free_simplify_scratch(scratch);
+		return -1;
+	}
+	return 0;
+}
+
+static void free_simplify_scratch(simplify_scratch_t *scratch)
+{
+	planning_free(scratch->prev);
+	planning_free(scratch->next);
+	planning_free(scratch->cost);
+	planning_free(scratch->seg_err);
+	planning_free(scratch->heap);
+	planning_free(scratch->heap_pos);
+	scratch->prev = NULL;
+	scratch->next = NULL;
+	scratch->cost = NULL;
+	scratch->seg_err = NULL;
+	scratch->heap = NULL;
+	scratch->heap_pos = NULL;
+	scratch->heap_size = 0;
+}
+
+// Returns the polygon's new vertex count; its vertices are moved to write_offset
+static uint32_t simplify_polygon(input_environment_t *env,
+								 polygon_t *polygon,
+								 uint32_t write_offset,
+								 double tolerance,
+								 simplify_scratch_t *scratch)
+{
+	uint32_t n = polygon->vertex_count;
+	float *xs = env->vertex_pool.x + polygon->first_vertex;
+	float *ys = env->vertex_pool.y + polygon->first_vertex;
+
+	if (n > 3)
+	{
+		for (uint32_t i = 0; i < n; ++i)
+		{
+			scratch->prev[i] = i == 0 ? n - 1 : i - 1;
+			scratch->next[i] = i + 1 == n ? 0 : i + 1;
+			scratch->seg_err[i] = 0.0;
+		}
+
+		scratch->heap_size = n;
+		for (uint32_t i = 0; i < n; ++i)
+		{
+			scratch->cost[i] = removal_cost(xs, ys, scratch, i);
+			scratch->heap[i] = i;
+			scratch->heap_pos[i] = i;
+		}
+		for (uint32_t i = n / 2; i-- > 0;)
+		{
+			heap_sift_down(scratch, i);
+		}
+
+		uint32_t remaining = n;
+		while (remaining > 3 && scratch->heap_size > 0 && scratch->cost[scratch->heap[0]] <= tolerance)
+		{
+			uint32_t v = heap_pop(scratch);
+			uint32_t p = scratch->prev[v];
+			uint32_t q = scratch->next[v];
+
+			scratch->seg_err[p] = scratch->cost[v];
+			scratch->next[p] = q;
+			scratch->prev[q] = p;
+			remaining--;
+
+			scratch->cost[p] = removal_cost(xs, ys, scratch, p);
+			heap_update(scratch, p);
+			scratch->cost[q] = removal_cost(xs, ys, scratch, q);
+			heap_update(scratch, q);
+		}
+	}
+	else
+	{
+		for (uint32_t i = 0; i < n; ++i)
+		{
+			scratch->heap_pos[i] = 0;
+		}
+	}
+
+	float *out_xs = env->vertex_pool.x + write_offset;
+	float *out_ys = env->vertex_pool.y + write_offset;
+	uint32_t kept = 0;
+	for (uint32_t i = 0; i < n; ++i)
+	{
+		if (scratch->heap_pos[i] == SIMPLIFY_REMOVED)
+			continue;
+		out_xs[kept] = xs[i];
+		out_ys[kept] = ys[i];
+		kept++;
+	}
+
+	polygon->first_vertex = write_offset;
+	polygon->vertex_count = kept;
+	return kept;
+}
+
+// Distance from the vertex to the chord that would replace it, plus what the two
+// segments it joins already deviate from the original outline
+static double removal_cost(const float *xs,
+						   const float *ys,
+						   const simplify_scratch_t *scratch,
+						   uint32_t vertex)
+{
+	uint32_t p = scratch->prev[vertex];
+	uint32_t q = scratch->next[vertex];
+
+	double distance = point_segment_distance(xs[vertex], ys[vertex], xs[p], ys[p], xs[q], ys[q]);
+	double absorbed = scratch->seg_err[p] > scratch->seg_err[vertex] ? scratch->seg_err[p] : scratch->seg_err[vertex];
+	return distance + absorbed;
+}
+
+static double point_segment_distance(double px, double py,
+									 double ax, double ay,
+									 double bx, double by)
+{
+	double dx = bx - ax;
+	double dy = by - ay;
+	double length_sq = dx * dx + dy * dy;
+
+	double t = length_sq > 0.0 ? ((px - ax) * dx + (py - ay) * dy) / length_sq : 0.0;
+	if (t < 0.0)
+		t = 0.0;
+	else if (t > 1.0)
+		t = 1.0;
+
+	double ex = ax + t * dx - px;
+	double ey = ay + t * dy - py;
+	return sqrt(ex * ex + ey * ey);
+}
+
+// --- INDEXED MIN-HEAP ON COST
+
+static bool heap_less(const simplify_scratch_t *scratch, uint32_t a, uint32_t b)
+{
+	if (scratch->cost[a] != scratch->cost[b])
+		return scratch->cost[a] < scratch->cost[b];
+	return a < b;
+}
+
+static void heap_swap(simplify_scratch_t *scratch, uint32_t i, uint32_t j)
+{
+	uint32_t a = scratch->heap[i];
+	uint32_t b = scratch->heap[j];
+	scratch->heap[i] = b;
+	scratch->heap[j] = a;
+	scratch->heap_pos[b] = i;
+	scratch->heap_pos[a] = j;
+}
+
+static void heap_sift_up(simplify_scratch_t *scratch, uint32_t i)
+{
+	while (i > 0)
+	{
+		uint32_t parent = (i - 1) / 2;
+		if (!heap_less(scratch, scratch->heap[i], scratch->heap[parent]))
+			return;
+		heap_swap(scratch, i, parent);
+		i = parent;
+	}
+}
+
+static void heap_sift_down(simplify_scratch_t *scratch, uint32_t i)
+{
+	for (;;)
+	{
+		uint32_t smallest = i;
+		uint32_t left = 2 * i + 1;
+		uint32_t right = left + 1;
+
+		if (left < scratch->heap_size && heap_less(scratch, scratch->heap[left], scratch->heap[smallest]))
+			smallest = left;
+		if (right < scratch->heap_size && heap_less(scratch, scratch->heap[right], scratch->heap[smallest]))
+			smallest = right;
+
+		if (smallest == i)
+			return;
+
+		heap_swap(scratch, i, smallest);
+		i = smallest;
+	}
+}
+
+static uint32_t heap_pop(simplify_scratch_t *scratch)
+{
+	uint32_t top = scratch->heap[0];
+
+	scratch->heap_size--;
+	if (scratch->heap_size > 0)
+	{
+		heap_swap(scratch, 0, scratch->heap_size);
+		heap_sift_down(scratch, 0);
+	}
+
+	scratch->heap_pos[top] = SIMPLIFY_REMOVED;
+	return top;
+}
+
+static void heap_update(simplify_scratch_t *scratch, uint32_t vertex)
+{
+	uint32_t i = scratch->heap_pos[vertex];
+	if (i == SIMPLIFY_REMOVED)
+		return;
+
+	heap_sift_up(scratch, i);
+	heap_sift_down(scratch, scratch->heap_pos[vertex]);
+}
@@ -0,0 +1,23 @@
+// Optional pre-pass that drops nearly-collinear polygon vertices before the decomposition
+
+#ifndef POLYGON_SIMPLIFICATION_H
+#define POLYGON_SIMPLIFICATION_H
+
+#include <stdint.h>
+#include "coverage_path_planning.h"
+
+typedef struct
+{
+    uint32_t input_vertex_count;
+    uint32_t output_vertex_count;
+} simplification_report_t;
+
+// Visvalingam-style elimination, cheapest vertex first (min-heap, O(n log n) per polygon).
+// A vertex is removed while every original vertex it stood for stays within tolerance
+// of the simplified outline; exactly collinear vertices always go. Polygons keep at
+// least 3 vertices. Compacts env->vertex_pool in place.
+int simplify_input_environment(input_environment_t *env,
+                               float tolerance,
+                               simplification_report_t *report);
+
+#endif // POLYGON_SIMPLIFICATION_H
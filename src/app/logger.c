@@ -0,0 +1,358 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "logger.h"
+
+#ifdef _WIN32
+#include <windows.h>
+
+typedef HANDLE log_thread_t;
+#define log_sleep_ms(ms) Sleep(ms)
+#else
+#include <pthread.h>
+#include <time.h>
+
+typedef pthread_t log_thread_t;
+#endif
+
+#define LOG_RING_CAPACITY 4096          // Records; power of two
+#define LOG_MESSAGE_SIZE 240            // Longer messages are cut
+#define LOG_IDLE_SLEEP_MS 5             // Writer naps this long when the ring is empty
+#define LOG_WRITE_BUFFER_SIZE 16384
+
+// A slot's sequence says whose turn it is (Vyukov's bounded queue): equal to the
+// enqueue position when a producer may fill it, one past it once the record is ready
+typedef struct
+{
+    atomic_size_t sequence;
+    unsigned char module;
+    unsigned char level;
+    unsigned short length;
+    char text[LOG_MESSAGE_SIZE];
+} log_record_t;
+
+static log_record_t log_ring[LOG_RING_CAPACITY];
+static atomic_size_t log_enqueue_position;
+static size_t log_dequeue_position;     // Writer thread only
+static atomic_size_t log_dropped;       // Messages lost to a full ring
+
+static atomic_int log_levels[LOG_MODULE_COUNT] = {LOG_LEVEL_INFO, LOG_LEVEL_INFO, LOG_LEVEL_INFO};
+static atomic_bool log_running;         // The writer thread drains the ring
+static atomic_bool log_stopping;
+static log_thread_t log_thread;
+
+static const char *const log_level_names[] = {"error", "warn", "info", "debug"};
+static const char *const log_module_names[LOG_MODULE_COUNT] = {"server", "planner", "bcd"};
+
+// FORWARD DECLARATIONS ---------------------------------------------
+
+static bool enqueue_record(log_module_t module, int level, const char *format, va_list args);
+static size_t drain_records(void);
+static int format_line(char *out, size_t size, int module, int level, const char *text, size_t length);
+static int level_from_name(const char *name, size_t length);
+static int module_from_name(const char *name, size_t length);
+
+static void log_writer_loop(void);
+static int start_log_thread(void);
+static void join_log_thread(void);
+#ifndef _WIN32
+static void log_sleep_ms(unsigned ms);
+#endif
+
+// IMPLEMENTATION --- logger ----------------------------------------
+
+int log_init(void)
+{
+    if (atomic_load(&log_running))
+        return 0;
+
+    for (size_t i = 0; i < LOG_RING_CAPACITY; ++i)
+    {
+        atomic_init(&log_ring[i].sequence, i);
+    }
+    atomic_store(&log_enqueue_position, 0);
+    log_dequeue_position = 0;
+    atomic_store(&log_stopping, false);
+
+    if (start_log_thread() != 0)
+        return -1;
+    atomic_store(&log_running, true);
+    return 0;
+}
+
+void log_shutdown(void)
+{
+    if (!atomic_load(&log_running))
+        return;
+
+    atomic_store(&log_stopping, true);
+    join_log_thread();
+    atomic_store(&log_running, false);
+
+    // Whatever producers squeezed in while the thread was stopping
+    drain_records();
+}
+
+void log_set_level(log_module_t module, int level)
+{
+    if ((int)module < 0 || module >= LOG_MODULE_COUNT)
+        return;
+    atomic_store_explicit(&log_levels[module], level, memory_order_relaxed);
+}
+
+int log_configure(const char *spec)
+{
+    if (!spec)
+        return 0;
+
+    const char *p = spec;
+    while (*p != '\0')
+    {
+        const char *end = strchr(p, ',');
+        size_t length = end ? (size_t)(end - p) : strlen(p);
+        const char *equals = memchr(p, '=', length);
+
+        if (equals)
+        {
+            int module = module_from_name(p, (size_t)(equals - p));
+            int level = level_from_name(equals + 1, length - (size_t)(equals - p) - 1);
+            if (module < 0 || level < 0)
+                return -1;
+            log_set_level((log_module_t)module, level);
+        }
+        else if (length > 0)
+        {
+            int level = level_from_name(p, length);
+            if (level < 0)
+                return -1;
+            for (int m = 0; m < LOG_MODULE_COUNT; ++m)
+            {
+                log_set_level((log_module_t)m, level);
+            }
+        }
+
+        p += length;
+        if (*p == ',')
+            p++;
+    }
+    return 0;
+}
+
+bool log_enabled(log_module_t module, int level)
+{
+    return level <= atomic_load_explicit(&log_levels[module], memory_order_relaxed);
+}
+
+void log_write(log_module_t module, int level, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+
+    if (atomic_load_explicit(&log_running, memory_order_acquire))
+    {
+        if (!enqueue_record(module, level, format, args))
+            atomic_fetch_add_explicit(&log_dropped, 1, memory_order_relaxed);
+    }
+    else
+    {
+        char text[LOG_MESSAGE_SIZE];
+        char line[LOG_MESSAGE_SIZE + 32];
+        int length = vsnprintf(text, sizeof(text), format, args);
+        if (length >= 0)
+        {
+            size_t kept = (size_t)length < sizeof(text) ? (size_t)length : sizeof(text) - 1;
+            int n = format_line(line, sizeof(line), module, level, text, kept);
+            fwrite(line, 1, (size_t)n, stdout);
+            fflush(stdout);
+        }
+    }
+
+    va_end(args);
+}
+
+// Claims a slot, formats straight into it and publishes it. Never blocks: when the
+// writer has fallen a whole ring behind, the message is dropped.
+static bool enqueue_record(log_module_t module, int level, const char *format, va_list args)
+{
+    log_record_t *record;
+    size_t position = atomic_load_explicit(&log_enqueue_position, memory_order_relaxed);
+    for (;;)
+    {
+        record = &log_ring[position & (LOG_RING_CAPACITY - 1)];
+        size_t sequence = atomic_load_explicit(&record->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+        if (difference == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&log_enqueue_position, &position, position + 1,
+                                                      memory_order_relaxed, memory_order_relaxed))
+                break;
+        }
+        else if (difference < 0)
+        {
+            return false;
+        }
+        else
+        {
+            position = atomic_load_explicit(&log_enqueue_position, memory_order_relaxed);
+        }
+    }
+
+    int length = vsnprintf(record->text, sizeof(record->text), format, args);
+    if (length < 0)
+        length = 0;
+    record->length = (unsigned short)((size_t)length < sizeof(record->text) ? (size_t)length : sizeof(record->text) - 1);
+    record->module = (unsigned char)module;
+    record->level = (unsigned char)level;
+
+    atomic_store_explicit(&record->sequence, position + 1, memory_order_release);
+    return true;
+}
+
+// Writer side: batches every ready record into one fwrite. Returns how many it wrote.
+static size_t drain_records(void)
+{
+    char buffer[LOG_WRITE_BUFFER_SIZE];
+    size_t used = 0;
+    size_t count = 0;
+
+    for (;;)
+    {
+        log_record_t *record = &log_ring[log_dequeue_position & (LOG_RING_CAPACITY - 1)];
+        size_t sequence = atomic_load_explicit(&record->sequence, memory_order_acquire);
+        if (sequence != log_dequeue_position + 1)
+            break;
+
+        if (LOG_WRITE_BUFFER_SIZE - used < LOG_MESSAGE_SIZE + 32)
+        {
+            fwrite(buffer, 1, used, stdout);
+            used = 0;
+        }
+        used += (size_t)format_line(buffer + used, LOG_WRITE_BUFFER_SIZE - used,
+                                    record->module, record->level, record->text, record->length);
+
+        // Hand the slot back to producers one lap later
+        atomic_store_explicit(&record->sequence, log_dequeue_position + LOG_RING_CAPACITY, memory_order_release);
+        log_dequeue_position++;
+        count++;
+    }
+
+    size_t dropped = atomic_exchange_explicit(&log_dropped, 0, memory_order_relaxed);
+    if (dropped > 0)
+    {
+        char text[64];
+        int length = snprintf(text, sizeof(text), "%zu messages dropped, log ring full", dropped);
+        if (LOG_WRITE_BUFFER_SIZE - used < sizeof(text) + 32)
+        {
+            fwrite(buffer, 1, used, stdout);
+            used = 0;
+        }
+        used += (size_t)format_line(buffer + used, LOG_WRITE_BUFFER_SIZE - used,
+                                    LOG_MODULE_SERVER, LOG_LEVEL_WARN, text, (size_t)length);
+    }
+
+    if (used > 0)
+    {
+        fwrite(buffer, 1, used, stdout);
+        fflush(stdout);
+    }
+    return count;
+}
+
+// "<level> <module>: <text>\n"; out must hold length + 32 bytes
+static int format_line(char *out, size_t size, int module, int level, const char *text, size_t length)
+{
+    const char *level_name = level >= LOG_LEVEL_ERROR && level <= LOG_LEVEL_DEBUG ? log_level_names[level] : "?";
+    const char *module_name = module >= 0 && module < LOG_MODULE_COUNT ? log_module_names[module] : "?";
+    int n = snprintf(out, size, "%-5s %s: %.*s\n", level_name, module_name, (int)length, text);
+    if (n < 0)
+        return 0;
+    return (size_t)n < size ? n : (int)size - 1;
+}
+
+static int level_from_name(const char *name, size_t length)
+{
+    for (int i = LOG_LEVEL_ERROR; i <= LOG_LEVEL_DEBUG; ++i)
+    {
+        if (strlen(log_level_names[i]) == length && strncmp(name, log_level_names[i], length) == 0)
+            return i;
+    }
+    return -1;
+}
+
+static int module_from_name(const char *name, size_t length)
+{
+    for (int i = 0; i < LOG_MODULE_COUNT; ++i)
+    {
+        if (strlen(log_module_names[i]) == length && strncmp(name, log_module_names[i], length) == 0)
+            return i;
+    }
+    return -1;
+}
+
+// IMPLEMENTATION --- writer thread ---------------------------------
+
+static void log_writer_loop(void)
+{
+    for (;;)
+    {
+        bool stopping = atomic_load(&log_stopping);
+        if (drain_records() == 0)
+        {
+            if (stopping)
+                return;
+            log_sleep_ms(LOG_IDLE_SLEEP_MS);
+        }
+    }
+}
+
+#ifdef _WIN32
+
+static DWORD WINAPI log_thread_main(LPVOID arg)
+{
+    (void)arg;
+    log_writer_loop();
+    return 0;
+}
+
+static int start_log_thread(void)
+{
+    log_thread = CreateThread(NULL, 0, log_thread_main, NULL, 0, NULL);
+    return log_thread ? 0 : -1;
+}
+
+static void join_log_thread(void)
+{
+    WaitForSingleObject(log_thread, INFINITE);
+    CloseHandle(log_thread);
+}
+
+#else
+
+static void *log_thread_main(void *arg)
+{
+    (void)arg;
+    log_writer_loop();
+    return NULL;
+}
+
+static int start_log_thread(void)
+{
+    return pthread_create(&log_thread, NULL, log_thread_main, NULL) == 0 ? 0 : -1;
+}
+
+static void join_log_thread(void)
+{
+    pthread_join(log_thread, NULL);
+}
+
+static void log_sleep_ms(unsigned ms)
+{
+    struct timespec delay = {(time_t)(ms / 1000), (long)(ms % 1000) * 1000000L};
+    nanosleep(&delay, NULL);
+}
+
+#endif
@@ -0,0 +1,91 @@
+// Leveled logging with per-module switches. Messages are formatted on the calling
+// thread into a lock-free ring buffer and written to stdout by a background thread,
+// so request threads never wait on console I/O. Before log_init (or if its thread
+// could not start) messages are written directly instead.
+//
+// A source file names its module once, then logs without repeating it:
+//
+//   #define LOG_MODULE LOG_MODULE_BCD
+//   LOG_ERROR("edge pool full in %s", __func__);
+//
+// Levels above LOG_COMPILE_LEVEL are removed by the preprocessor, arguments included;
+// debug dumps (log_bcd_cell_list and friends) only exist while LOG_DEBUG does.
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <stdbool.h>
+
+#define LOG_LEVEL_ERROR 0
+#define LOG_LEVEL_WARN 1
+#define LOG_LEVEL_INFO 2
+#define LOG_LEVEL_DEBUG 3
+
+// Highest level compiled in: -DLOG_COMPILE_LEVEL=LOG_LEVEL_DEBUG keeps everything.
+// Release builds (NDEBUG) stop at INFO.
+#ifndef LOG_COMPILE_LEVEL
+#ifdef NDEBUG
+#define LOG_COMPILE_LEVEL LOG_LEVEL_INFO
+#else
+#define LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG
+#endif
+#endif
+
+typedef enum {
+    LOG_MODULE_SERVER,          // webserver.c, plan cache
+    LOG_MODULE_PLANNER,         // coverage_path_planning pipeline
+    LOG_MODULE_BCD,             // Boustrophedon decomposition stages
+    LOG_MODULE_COUNT
+} log_module_t;
+
+// Starts the writer thread. Returns 0 on success; on failure logging stays synchronous.
+int log_init(void);
+
+// Writes out what is still queued and stops the writer thread.
+void log_shutdown(void);
+
+// Messages of module up to level are kept (LOG_LEVEL_INFO by default)
+void log_set_level(log_module_t module, int level);
+
+// Applies a comma-separated list of "module=level" or bare "level" (every module),
+// e.g. "warn,planner=debug". Module and level names are lower case. Returns 0, or -1
+// if part of spec was not understood (the parts before it still apply).
+int log_configure(const char *spec);
+
+bool log_enabled(log_module_t module, int level);
+
+#if defined(__GNUC__)
+__attribute__((format(printf, 3, 4)))
+#endif
+void log_write(log_module_t module, int level, const char *format, ...);
+
+#define LOG_AT(level, ...)                            \
+    do                                                \
+    {                                                 \
+        if (log_enabled(LOG_MODULE, (level)))         \
+            log_write(LOG_MODULE, (level), __VA_ARGS__); \
+    } while (0)
+
+#define LOG_ERROR(...) LOG_AT(LOG_LEVEL_ERROR, __VA_ARGS__)
+
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(...) LOG_AT(LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) ((void)0)
+#endif
+
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) LOG_AT(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) LOG_AT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_DEBUG_ENABLED() log_enabled(LOG_MODULE, LOG_LEVEL_DEBUG)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#define LOG_DEBUG_ENABLED() false
+#endif
+
+#endif // LOGGER_H
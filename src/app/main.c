@@ -2,16 +2,32 @@
 #include <stdlib.h>
 #include <string.h>
 #include "webserver.h"
+#include "worker_pool.h"
+#include "logger.h"
+#include "coverage_path_planning/coverage_path_planning.h"
 
 int main()
 {
     struct mg_mgr mgr;
+
+    // BOG_LOG adjusts levels per module, e.g. BOG_LOG=warn,planner=debug
+    log_init();
+    if (log_configure(getenv("BOG_LOG")) != 0)
+        fprintf(stderr, "BOG_LOG not understood: %s\n", getenv("BOG_LOG"));
+
+    coverage_path_planning_init();
+
+    worker_pool_t *pool = worker_pool_create(worker_pool_cpu_count());
+    coverage_path_planning_set_worker_pool(pool);
     
-    webserver_init(&mgr, "http://localhost:8000");
+    webserver_init(&mgr, "http://localhost:8000", pool);
     
     for (;;) mg_mgr_poll(&mgr, 1000);
     
+    coverage_path_planning_set_worker_pool(NULL);
+    worker_pool_destroy(pool);
     mg_mgr_free(&mgr);
+    log_shutdown();
     return 0;
 }
 
@@ -0,0 +1,136 @@
+// Times build_bcd_event_list on elliptical boundaries of growing vertex count, up to
+// 200k vertices, as the median of several runs after an untimed warm-up. Extraction
+// is linear and the sort a fixed number of passes, so the time per vertex (last
+// column) should grow only slowly, from caches filling up, while the vertex count
+// doubles. build_bcd_event_list allocates its buffers on every call; with glibc they
+// are kept in the heap so the timed runs reuse pages the warm-up already touched.
+// Other allocators may hand them back to the OS, and the page faults then count.
+// Build and run with `make bench`.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "../coverage_path_planning/coverage_path_planning.h"
+#include "../coverage_path_planning/boustrophedon_cellular_decomposition/bcd_event_list_building.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define BENCH_MIN_VERTICES 12500
+#define BENCH_MAX_VERTICES 200000
+#define BENCH_REPETITIONS 9 // Timed runs per size, after one warm-up run
+
+static double monotonic_ms(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER now;
+    LARGE_INTEGER frequency;
+    QueryPerformanceCounter(&now);
+    QueryPerformanceFrequency(&frequency);
+    return (double)now.QuadPart * 1000.0 / (double)frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec * 1000.0 + (double)now.tv_nsec / 1.0e6;
+#endif
+}
+
+static int compare_ms(const void *a, const void *b)
+{
+    double ms_a = *(const double *)a;
+    double ms_b = *(const double *)b;
+    return (ms_a > ms_b) - (ms_a < ms_b);
+}
+
+// Boundary only, wound like the parser's boundaries, with no two vertices sharing an x
+static int build_ellipse_environment(uint32_t vertex_count, input_environment_t *env)
+{
+    *env = (input_environment_t){0};
+    env->vertex_pool.x = (float *)malloc(vertex_count * sizeof(float));
+    env->vertex_pool.y = (float *)malloc(vertex_count * sizeof(float));
+    if (!env->vertex_pool.x || !env->vertex_pool.y)
+        return -2;
+
+    for (uint32_t i = 0; i < vertex_count; i++)
+    {
+        double t = M_PI / 2.0 + 2.0 * M_PI * (double)i / (double)vertex_count;
+        env->vertex_pool.x[i] = (float)(130.0 * cos(t));
+        env->vertex_pool.y[i] = (float)(100.0 * sin(t));
+    }
+    env->vertex_pool.count = env->vertex_pool.capacity = vertex_count;
+    env->boundary = (polygon_t){POLYGON_WINDING_CW, 0, vertex_count};
+    return 0;
+}
+
+// One build of the event list; returns its time in ms, or a negative value on failure
+static double time_event_list(const input_environment_t *env, int *event_count)
+{
+    bcd_event_list_t event_list = {0};
+    event_list.env = env;
+
+    double start = monotonic_ms();
+    int rc = build_bcd_event_list(env, &event_list);
+    double elapsed = monotonic_ms() - start;
+    if (rc != 0)
+    {
+        fprintf(stderr, "build_bcd_event_list failed (code %d) at %u vertices\n", rc, env->boundary.vertex_count);
+        return -1.0;
+    }
+
+    *event_count = event_list.length;
+    free_bcd_event_list(&event_list);
+    return elapsed;
+}
+
+int main(void)
+{
+    coverage_path_planning_init();
+#ifdef __GLIBC__
+    // Serve the event and sort buffers from the heap instead of fresh mappings, and
+    // keep them there once freed
+    mallopt(M_MMAP_THRESHOLD, 32 * 1024 * 1024);
+    mallopt(M_TRIM_THRESHOLD, 256 * 1024 * 1024);
+#endif
+    printf("%10s %8s %10s %12s\n", "vertices", "events", "median ms", "ns/vertex");
+
+    for (uint32_t n = BENCH_MIN_VERTICES; n <= BENCH_MAX_VERTICES; n *= 2)
+    {
+        input_environment_t env;
+        if (build_ellipse_environment(n, &env) != 0)
+        {
+            fprintf(stderr, "out of memory at %u vertices\n", n);
+            return 1;
+        }
+
+        int event_count = 0;
+        double run_ms[BENCH_REPETITIONS];
+        // Untimed warm-up: faults in the buffers the timed runs reuse
+        if (time_event_list(&env, &event_count) < 0.0)
+            return 1;
+        for (int r = 0; r < BENCH_REPETITIONS; r++)
+        {
+            run_ms[r] = time_event_list(&env, &event_count);
+            if (run_ms[r] < 0.0)
+                return 1;
+        }
+
+        qsort(run_ms, BENCH_REPETITIONS, sizeof(double), compare_ms);
+        double median_ms = run_ms[BENCH_REPETITIONS / 2];
+        printf("%10u %8d %10.2f %12.1f\n", n, event_count, median_ms, median_ms * 1.0e6 / n);
+        free(env.vertex_pool.x);
+        free(env.vertex_pool.y);
+    }
+
+    return 0;
+}
@@ -0,0 +1,161 @@
+// Regression inputs for the planner, each with what its plan must satisfy. Exits
+// non-zero when any check fails. Build and run with `make check`.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../coverage_path_planning/coverage_path_planning.h"
+#include "../coverage_path_planning/boustrophedon_cellular_decomposition/bcd_cell_graph.h"
+#include "../worker_pool.h"
+#include "../../../dependencies/cJSON/cJSON.h"
+
+// Boundary with a vertical edge at its leftmost x: (-5.04, 1.57) opens the sweep as
+// SIDE_IN and (-5.04, 0.77) below it continues as CEILING, so ordering same-x events
+// by y hands the sweep the CEILING before its cell exists. The obstacle vertex at
+// (1.69, 2.75) shares its x with the boundary vertex (1.69, 4.26) above it, so the
+// merge of the per-polygon runs has to break the tie by polygon, not by y. Nine
+// polygons put extraction on the pool when one is set.
+static const char *const vertical_edge_environment =
+    "{\"id\":11,\"pathWidth\":0.31,\"pathOverlap\":0.05,"
+    "\"boundary\":[{\"x\":3.19,\"y\":3.94},{\"x\":1.95,\"y\":4.59},{\"x\":1.69,\"y\":4.26},{\"x\":-4.44,\"y\":1.55},{\"x\":-5.04,\"y\":1.57},{\"x\":-5.04,\"y\":0.77},{\"x\":-4.89,\"y\":-1.21},{\"x\":-4.12,\"y\":-3.59},{\"x\":0.76,\"y\":-3.83},{\"x\":1.28,\"y\":-3.63},{\"x\":3.41,\"y\":-4.4},{\"x\":3.11,\"y\":-3.91},{\"x\":4.14,\"y\":-3.41}],"
+    "\"obstacleCount\":8,\"obstacles\":["
+    "[{\"x\":0.16,\"y\":1.39},{\"x\":-0.52,\"y\":1.24},{\"x\":-0.68,\"y\":1.46},{\"x\":-0.73,\"y\":1.89},{\"x\":-0.39,\"y\":1.98},{\"x\":0.18,\"y\":1.86},{\"x\":0.24,\"y\":1.89},{\"x\":0.19,\"y\":1.6}],"
+    "[{\"x\":-1.31,\"y\":-2.33},{\"x\":-1.45,\"y\":-2.6},{\"x\":-2.49,\"y\":-2.15},{\"x\":-1.87,\"y\":-1.67}],"
+    "[{\"x\":1.75,\"y\":0.1},{\"x\":2.2,\"y\":0.25},{\"x\":2.08,\"y\":-0.25}],"
+    "[{\"x\":-3.25,\"y\":0.1},{\"x\":-2.8,\"y\":0.25},{\"x\":-2.92,\"y\":-0.25}],"
+    "[{\"x\":0.25,\"y\":-0.9},{\"x\":0.7,\"y\":-0.75},{\"x\":0.57,\"y\":-1.25}],"
+    "[{\"x\":1.25,\"y\":2.6},{\"x\":1.69,\"y\":2.75},{\"x\":1.57,\"y\":2.25}],"
+    "[{\"x\":-2.75,\"y\":1.3},{\"x\":-2.3,\"y\":1.45},{\"x\":-2.42,\"y\":0.95}],"
+    "[{\"x\":2.75,\"y\":-2.4},{\"x\":3.2,\"y\":-2.25},{\"x\":3.08,\"y\":-2.75}]"
+    "]}";
+
+static int failures = 0;
+
+static void check(bool passed, const char *name)
+{
+    printf("%s %s\n", passed ? "PASS" : "FAIL", name);
+    if (!passed)
+        failures++;
+}
+
+// Parsed response, or NULL when planning failed
+static cJSON *plan(const char *environment_json)
+{
+    char *result = coverage_path_planning_process(environment_json);
+    if (!result)
+        return NULL;
+
+    cJSON *response = cJSON_Parse(result);
+    free(result);
+
+    const cJSON *status = cJSON_GetObjectItemCaseSensitive(response, "status");
+    if (!cJSON_IsString(status) || strcmp(status->valuestring, "ok") != 0)
+    {
+        cJSON_Delete(response);
+        return NULL;
+    }
+    return response;
+}
+
+// Same environment with "outputSections" set to every section but the event list,
+// which sends the sweep down the streaming path
+static char *without_event_list(const char *environment_json)
+{
+    cJSON *environment = cJSON_Parse(environment_json);
+    const char *sections[] = {"cell_list", "cell_graph", "path_list", "motion_plan"};
+    cJSON_AddItemToObject(environment, "outputSections", cJSON_CreateStringArray(sections, 4));
+
+    char *streamed_json = cJSON_PrintUnformatted(environment);
+    cJSON_Delete(environment);
+    return streamed_json;
+}
+
+static void check_vertical_edge(worker_pool_t *pool)
+{
+    cJSON *serial = plan(vertical_edge_environment);
+    check(serial != NULL, "vertical edge: plans");
+
+    coverage_path_planning_set_worker_pool(pool);
+    cJSON *pooled = plan(vertical_edge_environment);
+    coverage_path_planning_set_worker_pool(NULL);
+    check(serial && pooled && cJSON_Compare(serial, pooled, true),
+          "vertical edge: pooled plan equals serial plan");
+
+    char *streamed_json = without_event_list(vertical_edge_environment);
+    cJSON *streamed = streamed_json ? plan(streamed_json) : NULL;
+    if (serial)
+        cJSON_DeleteItemFromObjectCaseSensitive(serial, "event_list");
+    check(serial && streamed && cJSON_Compare(serial, streamed, true),
+          "vertical edge: streamed plan equals serial plan");
+
+    free(streamed_json);
+    cJSON_Delete(serial);
+    cJSON_Delete(pooled);
+    cJSON_Delete(streamed);
+}
+
+static bool near_point(point_t a, point_t b)
+{
+    return fabsf(a.x - b.x) <= 1e-5f && fabsf(a.y - b.y) <= 1e-5f;
+}
+
+// Cell 1 opens right of cell 0 and shares x = 2 with it over y in [1, 3]: below that the
+// floor corners cell 0 (2, 0.5) and cell 1 (2, 1) bound it, above it the ceiling corners
+// (2, 4) and (2, 3). Floors are stored right to left (f_begin is the floor-right corner),
+// so pairing the wrong floor corners widens the boundary down to y = 0.
+static void check_shared_boundary(void)
+{
+    cvector_vector_type(bcd_cell_t) cells = NULL;
+    bcd_cell_t left = {.c_begin = {0.0f, 4.0f}, .c_end = {2.0f, 4.0f}, .f_begin = {2.0f, 0.5f}, .f_end = {0.0f, -1.0f}};
+    bcd_cell_t right = {.c_begin = {2.0f, 3.0f}, .c_end = {5.0f, 3.5f}, .f_begin = {5.0f, 0.0f}, .f_end = {2.0f, 1.0f}};
+    bcd_neighbor_node_t left_to_right = {1, NULL, NULL};
+    bcd_neighbor_node_t right_to_left = {0, NULL, NULL};
+    left.neighbor_list = (bcd_neighbor_list_t){&left_to_right, &left_to_right, 1};
+    right.neighbor_list = (bcd_neighbor_list_t){&right_to_left, &right_to_left, 1};
+    cvector_push_back(cells, left);
+    cvector_push_back(cells, right);
+    const cvector_vector_type(bcd_cell_t) *cell_list = (const cvector_vector_type(bcd_cell_t) *)&cells;
+
+    bcd_cell_graph_t graph;
+    bool built = build_bcd_cell_graph(cell_list, &graph) == 0;
+    check(built && near_point(graph.crossings[0], (point_t){2.0f, 2.0f}) &&
+              near_point(graph.crossings[1], (point_t){2.0f, 2.0f}),
+          "shared boundary: crossing at its midpoint (2, 2) both ways");
+    if (built)
+        free_bcd_cell_graph(&graph);
+
+    // Straight lines that pass below and above the boundary bend at its ends
+    const int forward[] = {0, 1};
+    const int backward[] = {1, 0};
+    cvector_vector_type(point_t) bends = NULL;
+    trace_bcd_cell_corridor(cell_list, forward, 2, (point_t){0.5f, 0.0f}, (point_t){4.0f, 0.8f}, &bends);
+    check(cvector_size(bends) == 1 && near_point(bends[0], (point_t){2.0f, 1.0f}),
+          "shared boundary: low end at (2, 1)");
+
+    cvector_clear(bends);
+    trace_bcd_cell_corridor(cell_list, backward, 2, (point_t){4.5f, 3.3f}, (point_t){0.5f, 3.8f}, &bends);
+    check(cvector_size(bends) == 1 && near_point(bends[0], (point_t){2.0f, 3.0f}),
+          "shared boundary: high end at (2, 3) from the right");
+
+    cvector_free(bends);
+    cvector_free(cells);
+}
+
+int main(void)
+{
+    coverage_path_planning_init();
+    worker_pool_t *pool = worker_pool_create(4);
+    if (!pool)
+    {
+        fprintf(stderr, "could not start the worker pool\n");
+        return 1;
+    }
+
+    check_vertical_edge(pool);
+    check_shared_boundary();
+
+    worker_pool_destroy(pool);
+    printf("%d failed\n", failures);
+    return failures ? 1 : 0;
+}
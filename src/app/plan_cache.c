@@ -0,0 +1,302 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "plan_cache.h"
+
+#define PLAN_CACHE_MIN_BUCKETS 64
+
+typedef struct plan_cache_entry_t plan_cache_entry_t;
+
+struct plan_cache_entry_t
+{
+    planning_fingerprint_t key;
+    char *json;
+    size_t len;
+
+    plan_cache_entry_t *bucket_next;
+    plan_cache_entry_t *lru_prev;   // Towards the most recently used entry
+    plan_cache_entry_t *lru_next;   // Towards the least recently used entry
+};
+
+struct plan_cache_t
+{
+    plan_cache_entry_t **buckets;
+    size_t bucket_count;            // Power of two
+
+    plan_cache_entry_t *lru_head;   // Most recently used
+    plan_cache_entry_t *lru_tail;   // Least recently used, evicted first
+
+    plan_cache_stats_t stats;
+};
+
+// FORWARD DECLARATIONS ---------------------------------------------
+
+static size_t entry_cost(size_t len);
+static size_t bucket_index(const plan_cache_t *cache, const planning_fingerprint_t *key);
+static bool equal_keys(const planning_fingerprint_t *a, const planning_fingerprint_t *b);
+static plan_cache_entry_t *find_entry(const plan_cache_t *cache, const planning_fingerprint_t *key);
+static void grow_buckets(plan_cache_t *cache);
+
+static void lru_unlink(plan_cache_t *cache, plan_cache_entry_t *entry);
+static void lru_push_front(plan_cache_t *cache, plan_cache_entry_t *entry);
+
+static void remove_entry(plan_cache_t *cache, plan_cache_entry_t *entry);
+static void evict_until_fits(plan_cache_t *cache, size_t cost);
+
+// IMPLEMENTATION --- plan_cache ------------------------------------
+
+plan_cache_t *plan_cache_create(size_t byte_budget)
+{
+    plan_cache_t *cache = (plan_cache_t *)calloc(1, sizeof(plan_cache_t));
+    if (!cache)
+        return NULL;
+
+    cache->bucket_count = PLAN_CACHE_MIN_BUCKETS;
+    cache->buckets = (plan_cache_entry_t **)calloc(cache->bucket_count, sizeof(plan_cache_entry_t *));
+    if (!cache->buckets)
+    {
+        free(cache);
+        return NULL;
+    }
+
+    cache->stats.byte_budget = byte_budget;
+    return cache;
+}
+
+const char *plan_cache_get(plan_cache_t *cache,
+                           const planning_fingerprint_t *key,
+                           size_t *len)
+{
+    if (!cache || !key)
+        return NULL;
+
+    plan_cache_entry_t *entry = find_entry(cache, key);
+    if (!entry)
+    {
+        cache->stats.misses++;
+        return NULL;
+    }
+
+    cache->stats.hits++;
+    lru_unlink(cache, entry);
+    lru_push_front(cache, entry);
+
+    if (len)
+        *len = entry->len;
+    return entry->json;
+}
+
+int plan_cache_put(plan_cache_t *cache,
+                   const planning_fingerprint_t *key,
+                   const char *json,
+                   size_t len)
+{
+    if (!cache || !key || !json)
+        return -1;
+    if (entry_cost(len) > cache->stats.byte_budget)
+        return -2;
+
+    char *copy = (char *)malloc(len + 1);
+    if (!copy)
+        return -3;
+    memcpy(copy, json, len);
+    copy[len] = '\0';
+
+    int rc = plan_cache_adopt(cache, key, copy, len);
+    if (rc != 0)
+        free(copy);
+    return rc;
+}
+
+int plan_cache_adopt(plan_cache_t *cache,
+                     const planning_fingerprint_t *key,
+                     char *result,
+                     size_t len)
+{
+    if (!cache || !key || !result)
+        return -1;
+
+    size_t cost = entry_cost(len);
+    if (cost > cache->stats.byte_budget)
+        return -2;
+
+    plan_cache_entry_t *existing = find_entry(cache, key);
+    if (existing)
+        remove_entry(cache, existing);
+
+    evict_until_fits(cache, cost);
+
+    plan_cache_entry_t *entry = (plan_cache_entry_t *)calloc(1, sizeof(plan_cache_entry_t));
+    if (!entry)
+        return -3;
+
+    entry->key = *key;
+    entry->json = result;
+    entry->len = len;
+
+    size_t b = bucket_index(cache, key);
+    entry->bucket_next = cache->buckets[b];
+    cache->buckets[b] = entry;
+    lru_push_front(cache, entry);
+
+    cache->stats.entry_count++;
+    cache->stats.bytes_used += cost;
+
+    if (cache->stats.entry_count > cache->bucket_count)
+        grow_buckets(cache);
+
+    return 0;
+}
+
+void plan_cache_count_not_modified(plan_cache_t *cache)
+{
+    if (cache)
+        cache->stats.not_modified++;
+}
+
+void plan_cache_get_stats(const plan_cache_t *cache, plan_cache_stats_t *stats)
+{
+    if (!cache || !stats)
+        return;
+    *stats = cache->stats;
+}
+
+void plan_cache_destroy(plan_cache_t *cache)
+{
+    if (!cache)
+        return;
+
+    plan_cache_entry_t *entry = cache->lru_head;
+    while (entry)
+    {
+        plan_cache_entry_t *next = entry->lru_next;
+        free(entry->json);
+        free(entry);
+        entry = next;
+    }
+
+    free(cache->buckets);
+    free(cache);
+}
+
+void format_plan_etag(const planning_fingerprint_t *key, char etag[PLAN_ETAG_SIZE])
+{
+    snprintf(etag, PLAN_ETAG_SIZE, "\"%016llx%016llx\"",
+             (unsigned long long)key->hi, (unsigned long long)key->lo);
+}
+
+// --- HASH TABLE
+
+static size_t entry_cost(size_t len)
+{
+    return len + 1 + sizeof(plan_cache_entry_t);
+}
+
+// Fingerprints are already well mixed
+static size_t bucket_index(const plan_cache_t *cache, const planning_fingerprint_t *key)
+{
+    return (size_t)(key->lo & (uint64_t)(cache->bucket_count - 1));
+}
+
+static bool equal_keys(const planning_fingerprint_t *a, const planning_fingerprint_t *b)
+{
+    return a->hi == b->hi && a->lo == b->lo;
+}
+
+static plan_cache_entry_t *find_entry(const plan_cache_t *cache, const planning_fingerprint_t *key)
+{
+    for (plan_cache_entry_t *entry = cache->buckets[bucket_index(cache, key)]; entry; entry = entry->bucket_next)
+    {
+        if (equal_keys(&entry->key, key))
+            return entry;
+    }
+    return NULL;
+}
+
+// Keeps chains short; on allocation failure the table just stays at its current size
+static void grow_buckets(plan_cache_t *cache)
+{
+    size_t new_count = cache->bucket_count * 2;
+    plan_cache_entry_t **buckets = (plan_cache_entry_t **)calloc(new_count, sizeof(plan_cache_entry_t *));
+    if (!buckets)
+        return;
+
+    for (size_t i = 0; i < cache->bucket_count; i++)
+    {
+        plan_cache_entry_t *entry = cache->buckets[i];
+        while (entry)
+        {
+            plan_cache_entry_t *next = entry->bucket_next;
+            size_t b = (size_t)(entry->key.lo & (uint64_t)(new_count - 1));
+            entry->bucket_next = buckets[b];
+            buckets[b] = entry;
+            entry = next;
+        }
+    }
+
+    free(cache->buckets);
+    cache->buckets = buckets;
+    cache->bucket_count = new_count;
+}
+
+// --- LRU LIST
+
+static void lru_unlink(plan_cache_t *cache, plan_cache_entry_t *entry)
+{
+    if (entry->lru_prev)
+        entry->lru_prev->lru_next = entry->lru_next;
+    else
+        cache->lru_head = entry->lru_next;
+
+    if (entry->lru_next)
+        entry->lru_next->lru_prev = entry->lru_prev;
+    else
+        cache->lru_tail = entry->lru_prev;
+
+    entry->lru_prev = NULL;
+    entry->lru_next = NULL;
+}
+
+static void lru_push_front(plan_cache_t *cache, plan_cache_entry_t *entry)
+{
+    entry->lru_prev = NULL;
+    entry->lru_next = cache->lru_head;
+
+    if (cache->lru_head)
+        cache->lru_head->lru_prev = entry;
+    else
+        cache->lru_tail = entry;
+
+    cache->lru_head = entry;
+}
+
+// --- EVICTION
+
+static void remove_entry(plan_cache_t *cache, plan_cache_entry_t *entry)
+{
+    plan_cache_entry_t **link = &cache->buckets[bucket_index(cache, &entry->key)];
+    while (*link && *link != entry)
+    {
+        link = &(*link)->bucket_next;
+    }
+    if (*link)
+        *link = entry->bucket_next;
+
+    lru_unlink(cache, entry);
+
+    cache->stats.entry_count--;
+    cache->stats.bytes_used -= entry_cost(entry->len);
+
+    free(entry->json);
+    free(entry);
+}
+
+static void evict_until_fits(plan_cache_t *cache, size_t cost)
+{
+    while (cache->lru_tail && cache->stats.bytes_used + cost > cache->stats.byte_budget)
+    {
+        remove_entry(cache, cache->lru_tail);
+        cache->stats.evictions++;
+    }
+}
@@ -0,0 +1,57 @@
+// In-memory LRU cache of serialized planning results, keyed by environment fingerprint
+// and bounded by a byte budget. Not thread-safe: owned by the event loop.
+
+#ifndef PLAN_CACHE_H
+#define PLAN_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "coverage_path_planning/coverage_path_planning.h"
+
+#define PLAN_ETAG_SIZE 35 // Quoted 32 hex digits plus NUL
+
+typedef struct plan_cache_t plan_cache_t;
+
+typedef struct
+{
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t not_modified;      // Hits answered with 304
+    uint64_t evictions;
+    size_t entry_count;
+    size_t bytes_used;          // Results plus per-entry bookkeeping
+    size_t byte_budget;
+} plan_cache_stats_t;
+
+plan_cache_t *plan_cache_create(size_t byte_budget);
+
+// Counts a hit or a miss. On a hit returns the cached result, JSON or a binary plan
+// (len bytes), valid until the next plan_cache_put; NULL on a miss.
+const char *plan_cache_get(plan_cache_t *cache,
+                           const planning_fingerprint_t *key,
+                           size_t *len);
+
+// Copies json in as the most recently used entry, evicting least recently used
+// ones to stay within the budget. Results larger than the budget are not kept.
+// Returns 0 on success.
+int plan_cache_put(plan_cache_t *cache,
+                   const planning_fingerprint_t *key,
+                   const char *json,
+                   size_t len);
+
+// Same, but keeps result (malloc()ed) itself instead of a copy. On success the cache
+// owns it; on failure the caller still does.
+int plan_cache_adopt(plan_cache_t *cache,
+                     const planning_fingerprint_t *key,
+                     char *result,
+                     size_t len);
+
+void plan_cache_count_not_modified(plan_cache_t *cache);
+void plan_cache_get_stats(const plan_cache_t *cache, plan_cache_stats_t *stats);
+
+void plan_cache_destroy(plan_cache_t *cache);
+
+// Strong ETag for a result, e.g. "0123...cdef" including the quotes
+void format_plan_etag(const planning_fingerprint_t *key, char etag[PLAN_ETAG_SIZE]);
+
+#endif // PLAN_CACHE_H
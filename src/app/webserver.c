@@ -3,16 +3,85 @@
 #include <string.h>
 #include "webserver.h"
 #include "coverage_path_planning/coverage_path_planning.h"
+#include "coverage_path_planning/plan_binary.h"
+#include "coverage_path_planning/json_reader.h"
+#include "plan_cache.h"
+#include "logger.h"
 #include "../../dependencies/cJSON/cJSON.h"
 #include <sys/stat.h>
 #include <direct.h>
 #include <windows.h>
 
-void webserver_init(struct mg_mgr *mgr, const char *listen_url)
+#define LOG_MODULE LOG_MODULE_SERVER
+
+#define PLAN_CACHE_BYTE_BUDGET (64u * 1024u * 1024u)
+
+// Content-Type follows the result: JSON, or the binary plan for clients that accept it
+#define PLANNING_REPLY_HEADERS "Access-Control-Allow-Origin: *\r\nAccess-Control-Allow-Methods: POST, GET, OPTIONS\r\nAccess-Control-Allow-Headers: Content-Type, If-None-Match\r\nAccess-Control-Expose-Headers: ETag, X-Plan-Cache\r\nVary: Accept\r\n"
+
+// Planning request handed from the event loop to a pool worker and back.
+// Only body, format and the result are touched by the worker; the rest belongs to the loop.
+typedef struct planning_job_t
+{
+    struct mg_mgr *mgr;
+    char *body;                 // Worker-owned copy of the request body (see the export route)
+    size_t body_length;
+    plan_format_t format;
+    char *result;               // Filled in by the worker: JSON, or a binary plan
+    size_t result_length;
+    bool keyed;                 // fingerprint is valid: the job can be shared and its result cached
+    planning_fingerprint_t fingerprint;
+
+    unsigned long *conn_ids;    // Connections parked until the result arrives, first one submitted the job
+    size_t conn_count;
+    size_t conn_capacity;
+
+    struct planning_job_t *next_in_flight;
+} planning_job_t;
+
+static worker_pool_t *planning_pool = NULL;
+static unsigned long planning_listener_id = 0; // Receives MG_EV_WAKEUP for finished jobs
+static plan_cache_t *plan_cache = NULL;        // Event loop only
+static planning_job_t *in_flight_jobs = NULL;  // Keyed jobs still running, event loop only
+static uint64_t coalesced_requests = 0;
+
+static void run_planning_job(void *arg);
+static void handle_planning_job_done(struct mg_connection *c, struct mg_str *data);
+static planning_job_t *find_in_flight_job(const planning_fingerprint_t *fingerprint);
+static int add_planning_waiter(planning_job_t *job, unsigned long conn_id);
+static void unlink_in_flight_job(planning_job_t *job);
+static void free_planning_job(planning_job_t *job);
+static void finish_planning(struct mg_mgr *mgr,
+                            const unsigned long *conn_ids,
+                            size_t conn_count,
+                            char *result,
+                            size_t result_length,
+                            bool keyed,
+                            const planning_fingerprint_t *fingerprint);
+static void reply_planning_result(struct mg_connection *c,
+                                  int status,
+                                  const char *body,
+                                  size_t len,
+                                  const char *etag,
+                                  const char *cache_state);
+static bool etag_matches(const struct mg_str *if_none_match, const char *etag);
+static bool accepts_media_type(const struct mg_str *accept, const char *media_type);
+
+void webserver_init(struct mg_mgr *mgr, const char *listen_url, worker_pool_t *pool)
 {
     mg_mgr_init(mgr);
-    mg_http_listen(mgr, listen_url, webserver_event_handler, NULL);
-    printf("Server started on %s\n", listen_url);
+    plan_cache = plan_cache_create(PLAN_CACHE_BYTE_BUDGET);
+    struct mg_connection *listener = mg_http_listen(mgr, listen_url, webserver_event_handler, NULL);
+
+    // Workers hand results back through the wakeup pipe; without it plan inline
+    if (pool && listener && mg_wakeup_init(mgr))
+    {
+        planning_pool = pool;
+        planning_listener_id = listener->id;
+    }
+
+    LOG_INFO("Server started on %s (%d planning workers)", listen_url,
+             planning_pool ? worker_pool_thread_count(planning_pool) : 0);
 }
 
 void webserver_event_handler(struct mg_connection *c, int ev, void *ev_data)
@@ -81,6 +150,9 @@ void webserver_event_handler(struct mg_connection *c, int ev, void *ev_data)
         case ROUTE_PATH_INPUT_ENVIRONMENT_DELETE:
             handle_path_input_environment_delete_route(c, hm);
             break;
+        case ROUTE_PATH_INPUT_ENVIRONMENT_CACHE_STATS:
+            handle_path_input_environment_cache_stats_route(c, hm);
+            break;
 
         case ROUTE_TEST_INDEX:
             handle_test_route(c, hm);
@@ -100,6 +172,10 @@ void webserver_event_handler(struct mg_connection *c, int ev, void *ev_data)
             break;
         }
     }
+    else if (ev == MG_EV_WAKEUP && c->id == planning_listener_id)
+    {
+        handle_planning_job_done(c, (struct mg_str *)ev_data);
+    }
 }
 
 void handle_path_input_environment_script_route(struct mg_connection *c, struct mg_http_message *hm)
@@ -164,29 +240,40 @@ void handle_test_route(struct mg_connection *c, struct mg_http_message *hm)
     mg_http_serve_file(c, hm, "../../web/test/test-index.html", &opts);
 }
 
+// Reads "msg" straight out of the request body
 void handle_send_route(struct mg_connection *c, struct mg_http_message *hm)
 {
-    char *body_str = malloc(hm->body.len + 1);
-    memcpy(body_str, hm->body.buf, hm->body.len);
-    body_str[hm->body.len] = '\0';
+    char msg[224];
+    bool has_msg = false;
+    bool seen_msg = false;
+    char key[8];
+    json_reader_t reader;
+    json_reader_init(&reader, hm->body.buf, hm->body.len);
+    if (json_reader_peek(&reader) == JSON_READER_OBJECT)
+    {
+        json_reader_begin_object(&reader);
+        while (json_reader_next_member(&reader, key, sizeof(key)))
+        {
+            if (!seen_msg && strcmp(key, "msg") == 0 && json_reader_peek(&reader) == JSON_READER_STRING)
+                has_msg = json_reader_string(&reader, msg, sizeof(msg));
+            else
+                json_reader_skip(&reader);
+            seen_msg = seen_msg || strcmp(key, "msg") == 0;
+        }
+    }
 
-    cJSON *json = cJSON_Parse(body_str);
-    const cJSON *msg = cJSON_GetObjectItemCaseSensitive(json, "msg");
     char response[256] = {0};
-
-    if (cJSON_IsString(msg) && (msg->valuestring != NULL))
+    if (has_msg && !reader.failed)
     {
-        snprintf(response, sizeof(response), "{\"reply\":\"Received: %s\"}", msg->valuestring);
+        snprintf(response, sizeof(response), "{\"reply\":\"Received: %s\"}", msg);
     }
     else
     {
         snprintf(response, sizeof(response), "{\"error\":\"No msg\"}");
     }
 
-    printf("Sending response: %s\n", response);
+    LOG_DEBUG("Sending response: %s", response);
 
-    cJSON_Delete(json);
-    free(body_str);
     mg_http_reply(c, 200, "Content-Type: application/json\r\nAccess-Control-Allow-Origin: *\r\nAccess-Control-Allow-Methods: POST, GET, OPTIONS\r\nAccess-Control-Allow-Headers: Content-Type\r\n", "%s", response);
 }
 
@@ -238,6 +325,10 @@ route_type_t get_route_type(struct mg_str uri)
     {
         return ROUTE_PATH_INPUT_ENVIRONMENT_DELETE;
     }
+    if (mg_strcmp(uri, mg_str("/environment/InputEnvironment/cache")) == 0)
+    {
+        return ROUTE_PATH_INPUT_ENVIRONMENT_CACHE_STATS;
+    }
 
     if (mg_strcmp(uri, mg_str("/services/CoordinateTransformer.js")) == 0)
     {
@@ -298,42 +389,335 @@ route_type_t get_route_type(struct mg_str uri)
     return ROUTE_UNKNOWN;
 }
 
+// The body is parsed where mongoose received it; it is only copied for a pool worker.
+// That copy is the thread hand-off: hm->body points into c->recv, which mongoose trims
+// as soon as this handler returns and keeps reallocating for the next request on the
+// connection (or frees when the client hangs up) while the worker is still planning.
+// The buffer cannot be borrowed until the wakeup without owning the connection's I/O.
 void handle_path_input_environment_export_route(struct mg_connection *c, struct mg_http_message *hm)
 {
-    char *body_str = (char *)malloc(hm->body.len + 1);
-    if (!body_str)
+    plan_format_t format = accepts_media_type(mg_http_get_header(hm, "Accept"), PLAN_BINARY_CONTENT_TYPE)
+                               ? PLAN_FORMAT_BINARY
+                               : PLAN_FORMAT_JSON;
+
+    // Equal environments plan to equal results: answer repeats from the cache
+    planning_fingerprint_t fingerprint = {0, 0};
+    bool keyed = coverage_path_planning_fingerprint(hm->body.buf, hm->body.len, format, &fingerprint) == 0;
+    if (keyed && plan_cache)
+    {
+        size_t cached_len = 0;
+        const char *cached = plan_cache_get(plan_cache, &fingerprint, &cached_len);
+        if (cached)
+        {
+            char etag[PLAN_ETAG_SIZE];
+            format_plan_etag(&fingerprint, etag);
+
+            if (etag_matches(mg_http_get_header(hm, "If-None-Match"), etag))
+            {
+                plan_cache_count_not_modified(plan_cache);
+                reply_planning_result(c, 304, NULL, 0, etag, "hit");
+            }
+            else
+            {
+                reply_planning_result(c, 200, cached, cached_len, etag, "hit");
+            }
+            return;
+        }
+    }
+
+    // The same environment is already being planned: wait for that result instead
+    if (keyed)
     {
-        mg_http_reply(c, 500, "Access-Control-Allow-Origin: *\r\n", "{\"error\":\"OOM\"}");
+        planning_job_t *running = find_in_flight_job(&fingerprint);
+        if (running && add_planning_waiter(running, c->id) == 0)
+        {
+            coalesced_requests++;
+            return;
+        }
+    }
+
+    if (planning_pool)
+    {
+        planning_job_t *job = (planning_job_t *)calloc(1, sizeof(planning_job_t));
+        if (job)
+            job->body = (char *)malloc(hm->body.len > 0 ? hm->body.len : 1);
+        if (job && job->body && add_planning_waiter(job, c->id) == 0)
+        {
+            memcpy(job->body, hm->body.buf, hm->body.len);
+            job->body_length = hm->body.len;
+            job->mgr = c->mgr;
+            job->format = format;
+            job->keyed = keyed;
+            job->fingerprint = fingerprint;
+
+            if (worker_pool_submit(planning_pool, run_planning_job, job) == 0)
+            {
+                if (keyed)
+                {
+                    job->next_in_flight = in_flight_jobs;
+                    in_flight_jobs = job;
+                }
+                return;
+            }
+        }
+        if (job)
+            free_planning_job(job);
+    }
+
+    // No pool, or the job could not be queued: plan on the event loop
+    size_t result_length = 0;
+    char *result = coverage_path_planning_process_as(hm->body.buf, hm->body.len, format, &result_length);
+
+    unsigned long conn_id = c->id;
+    finish_planning(c->mgr, &conn_id, 1, result, result_length, keyed, &fingerprint);
+}
+
+// Runs on a pool worker
+static void run_planning_job(void *arg)
+{
+    planning_job_t *job = (planning_job_t *)arg;
+
+    job->result = coverage_path_planning_process_as(job->body, job->body_length, job->format, &job->result_length);
+    free(job->body);
+    job->body = NULL;
+
+    mg_wakeup(job->mgr, planning_listener_id, &job, sizeof(job));
+}
+
+// Back on the event loop: the wakeup carries the job pointer
+static void handle_planning_job_done(struct mg_connection *c, struct mg_str *data)
+{
+    planning_job_t *job;
+    if (data->len != sizeof(job))
         return;
+    memcpy(&job, data->buf, sizeof(job));
+
+    // Later identical requests start a new job from here on (or hit the cache)
+    unlink_in_flight_job(job);
+
+    finish_planning(c->mgr, job->conn_ids, job->conn_count, job->result, job->result_length, job->keyed, &job->fingerprint);
+    job->result = NULL;
+    free_planning_job(job);
+}
+
+static planning_job_t *find_in_flight_job(const planning_fingerprint_t *fingerprint)
+{
+    for (planning_job_t *job = in_flight_jobs; job != NULL; job = job->next_in_flight)
+    {
+        if (job->fingerprint.hi == fingerprint->hi && job->fingerprint.lo == fingerprint->lo)
+            return job;
     }
-    memcpy(body_str, hm->body.buf, hm->body.len);
-    body_str[hm->body.len] = '\0';
+    return NULL;
+}
 
-    char *result_json = coverage_path_planning_process(body_str);
+static int add_planning_waiter(planning_job_t *job, unsigned long conn_id)
+{
+    if (job->conn_count == job->conn_capacity)
+    {
+        size_t capacity = job->conn_capacity ? job->conn_capacity * 2 : 4;
+        unsigned long *conn_ids = (unsigned long *)realloc(job->conn_ids, capacity * sizeof(unsigned long));
+        if (!conn_ids)
+            return -1;
+        job->conn_ids = conn_ids;
+        job->conn_capacity = capacity;
+    }
+    job->conn_ids[job->conn_count++] = conn_id;
+    return 0;
+}
+
+static void unlink_in_flight_job(planning_job_t *job)
+{
+    for (planning_job_t **link = &in_flight_jobs; *link != NULL; link = &(*link)->next_in_flight)
+    {
+        if (*link == job)
+        {
+            *link = job->next_in_flight;
+            job->next_in_flight = NULL;
+            return;
+        }
+    }
+}
+
+static void free_planning_job(planning_job_t *job)
+{
+    free(job->body);
+    free(job->result);
+    free(job->conn_ids);
+    free(job);
+}
+
+// Caches successful results, replies to every waiting connection that is still
+// there, and frees result (or hands it to the cache)
+static void finish_planning(struct mg_mgr *mgr,
+                            const unsigned long *conn_ids,
+                            size_t conn_count,
+                            char *result,
+                            size_t result_length,
+                            bool keyed,
+                            const planning_fingerprint_t *fingerprint)
+{
+    size_t len = result ? result_length : 0;
+
+    // Binary results are always successful plans; errors come back as JSON
+    char etag[PLAN_ETAG_SIZE];
+    bool succeeded = result && (plan_binary_is_plan(result, len) ||
+                                (len >= 14 && strncmp(result, "{\"status\":\"ok\"", 14) == 0));
+    bool cacheable = keyed && succeeded;
+    bool adopted = false;
+    if (cacheable)
+    {
+        // The cache keeps result itself; it stays valid until the next put, after the replies
+        adopted = plan_cache_adopt(plan_cache, fingerprint, result, len) == 0;
+        format_plan_etag(fingerprint, etag);
+    }
+
+    // Clients may have gone away while the plan was running; the result is cached anyway
+    for (size_t i = 0; i < conn_count; ++i)
+    {
+        struct mg_connection *target = NULL;
+        for (struct mg_connection *t = mgr->conns; t != NULL; t = t->next)
+        {
+            if (t->id == conn_ids[i] && !t->is_closing)
+            {
+                target = t;
+                break;
+            }
+        }
+        if (!target)
+            continue;
+
+        if (result)
+            reply_planning_result(target, 200, result, len, cacheable ? etag : NULL, i == 0 ? "miss" : "coalesced");
+        else
+            reply_planning_result(target, 500, NULL, 0, NULL, NULL);
+    }
+
+    if (!adopted)
+        free(result);
+}
 
-    free(body_str);
+static void reply_planning_result(struct mg_connection *c,
+                                  int status,
+                                  const char *body,
+                                  size_t len,
+                                  const char *etag,
+                                  const char *cache_state)
+{
+    char headers[512];
+    int n = snprintf(headers, sizeof(headers), "%sContent-Type: %s\r\n", PLANNING_REPLY_HEADERS,
+                     plan_binary_is_plan(body, len) ? PLAN_BINARY_CONTENT_TYPE : "application/json");
+    if (etag && n > 0 && (size_t)n < sizeof(headers))
+        n += snprintf(headers + n, sizeof(headers) - (size_t)n, "ETag: %s\r\n", etag);
+    if (cache_state && n > 0 && (size_t)n < sizeof(headers))
+        n += snprintf(headers + n, sizeof(headers) - (size_t)n, "X-Plan-Cache: %s\r\n", cache_state);
 
-    const char *headers = "Content-Type: application/json\r\nAccess-Control-Allow-Origin: *\r\nAccess-Control-Allow-Methods: POST, GET, OPTIONS\r\nAccess-Control-Allow-Headers: Content-Type\r\n";
-    if (result_json)
+    if (status == 304)
+    {
+        mg_http_reply(c, 304, headers, "");
+    }
+    else if (body)
     {
-        mg_http_reply(
-            c,
-            200,
-            headers,
-            "%s",
-            result_json);
-        free(result_json);
+        // mg_http_reply() formats the body and would stop at the first NUL of a binary plan
+        mg_printf(c, "HTTP/1.1 %d %s\r\n%sContent-Length: %lu\r\n\r\n",
+                  status, status == 200 ? "OK" : "Error", headers, (unsigned long)len);
+        mg_send(c, body, len);
     }
     else
     {
-        mg_http_reply(
-            c,
-            500,
-            headers,
-            "{\"status\":\"error\",\"message\":\"no result\"}");
+        mg_http_reply(c, status, headers, "{\"status\":\"error\",\"message\":\"no result\"}");
     }
 }
 
+// If-None-Match holds "*" or a comma-separated list of (possibly weak) ETags
+static bool etag_matches(const struct mg_str *if_none_match, const char *etag)
+{
+    if (!if_none_match)
+        return false;
+
+    struct mg_str header = *if_none_match;
+    struct mg_str item;
+    while (mg_span(header, &item, &header, ','))
+    {
+        while (item.len > 0 && (item.buf[0] == ' ' || item.buf[0] == '\t'))
+            item = mg_str_n(item.buf + 1, item.len - 1);
+        while (item.len > 0 && (item.buf[item.len - 1] == ' ' || item.buf[item.len - 1] == '\t'))
+            item.len--;
+        if (item.len > 2 && item.buf[0] == 'W' && item.buf[1] == '/')
+            item = mg_str_n(item.buf + 2, item.len - 2);
+        if (mg_strcmp(item, mg_str("*")) == 0 || mg_strcmp(item, mg_str(etag)) == 0)
+            return true;
+    }
+    return false;
+}
+
+// Accept lists media ranges, each optionally weighted with ";q=". media_type is
+// acceptable when it is listed by name with a weight above zero.
+static bool accepts_media_type(const struct mg_str *accept, const char *media_type)
+{
+    if (!accept)
+        return false;
+
+    struct mg_str header = *accept;
+    struct mg_str item;
+    while (mg_span(header, &item, &header, ','))
+    {
+        struct mg_str range;
+        struct mg_str params;
+        mg_span(item, &range, &params, ';');
+        while (range.len > 0 && (range.buf[0] == ' ' || range.buf[0] == '\t'))
+            range = mg_str_n(range.buf + 1, range.len - 1);
+        while (range.len > 0 && (range.buf[range.len - 1] == ' ' || range.buf[range.len - 1] == '\t'))
+            range.len--;
+        if (mg_strcasecmp(range, mg_str(media_type)) != 0)
+            continue;
+
+        // q=0, q=0.0, ... rules the type out; any other weight accepts it
+        struct mg_str param;
+        bool refused = false;
+        while (mg_span(params, &param, &params, ';'))
+        {
+            while (param.len > 0 && (param.buf[0] == ' ' || param.buf[0] == '\t'))
+                param = mg_str_n(param.buf + 1, param.len - 1);
+            if (param.len < 3 || (param.buf[0] != 'q' && param.buf[0] != 'Q') || param.buf[1] != '=')
+                continue;
+
+            refused = true;
+            for (size_t i = 2; i < param.len; ++i)
+            {
+                char ch = param.buf[i];
+                if (ch != '0' && ch != '.' && ch != ' ' && ch != '\t')
+                    refused = false;
+            }
+        }
+        return !refused;
+    }
+    return false;
+}
+
+// Plan cache counters: GET /environment/InputEnvironment/cache
+void handle_path_input_environment_cache_stats_route(struct mg_connection *c, struct mg_http_message *hm)
+{
+    plan_cache_stats_t stats = {0};
+    plan_cache_get_stats(plan_cache, &stats);
+
+    cJSON *obj = cJSON_CreateObject();
+    cJSON_AddBoolToObject(obj, "enabled", plan_cache != NULL);
+    cJSON_AddNumberToObject(obj, "hits", (double)stats.hits);
+    cJSON_AddNumberToObject(obj, "misses", (double)stats.misses);
+    cJSON_AddNumberToObject(obj, "not_modified", (double)stats.not_modified);
+    cJSON_AddNumberToObject(obj, "evictions", (double)stats.evictions);
+    cJSON_AddNumberToObject(obj, "entries", (double)stats.entry_count);
+    cJSON_AddNumberToObject(obj, "bytes_used", (double)stats.bytes_used);
+    cJSON_AddNumberToObject(obj, "byte_budget", (double)stats.byte_budget);
+    cJSON_AddNumberToObject(obj, "coalesced", (double)coalesced_requests);
+    char *out = cJSON_PrintUnformatted(obj);
+    cJSON_Delete(obj);
+    mg_http_reply(c, 200, "Access-Control-Allow-Origin: *\r\nContent-Type: application/json\r\nCache-Control: no-store\r\n", "%s", out ? out : "{}");
+    if (out)
+        free(out);
+    (void)hm;
+}
+
 static void ensure_save_dir_exists(void)
 {
     struct _stat st;
@@ -448,27 +832,17 @@ void handle_path_input_environment_load_route(struct mg_connection *c, struct mg
     }
     char path[512];
     snprintf(path, sizeof(path), "../../save_files/%s.json", fname);
-    FILE *f = fopen(path, "rb");
-    if (!f)
+    struct _stat st;
+    if (_stat(path, &st) != 0)
     {
         mg_http_reply(c, 404, "Access-Control-Allow-Origin: *\r\n", "{\"error\":\"not found\"}");
         return;
     }
-    fseek(f, 0, SEEK_END);
-    long sz = ftell(f);
-    fseek(f, 0, SEEK_SET);
-    char *buf = (char *)malloc(sz + 1);
-    if (!buf)
-    {
-        fclose(f);
-        mg_http_reply(c, 500, "Access-Control-Allow-Origin: *\r\n", "{\"error\":\"OOM\"}");
-        return;
-    }
-    fread(buf, 1, sz, f);
-    fclose(f);
-    buf[sz] = '\0';
-    mg_http_reply(c, 200, "Access-Control-Allow-Origin: *\r\nContent-Type: application/json\r\n", "%s", buf);
-    free(buf);
+
+    // Mongoose streams the file out as the socket drains instead of holding all of it
+    struct mg_http_serve_opts opts = {.root_dir = "../../save_files",
+                                      .extra_headers = "Access-Control-Allow-Origin: *\r\n"};
+    mg_http_serve_file(c, hm, path, &opts);
 }
 
 // Delete file: POST /environment/InputEnvironment/delete?name=<filename>
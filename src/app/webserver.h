@@ -2,6 +2,7 @@
 #define WEBSERVER_H
 
 #include "../../dependencies/mongoose/mongoose.h"
+#include "worker_pool.h"
 
 typedef enum {
     ROUTE_HOME,
@@ -12,6 +13,7 @@ typedef enum {
     ROUTE_PATH_INPUT_ENVIRONMENT_SAVES_LIST,
     ROUTE_PATH_INPUT_ENVIRONMENT_LOAD,
     ROUTE_PATH_INPUT_ENVIRONMENT_DELETE,
+    ROUTE_PATH_INPUT_ENVIRONMENT_CACHE_STATS,
     // /services
     ROUTE_PATH_COORDINATE_TRANSFORMER_SCRIPT,
     ROUTE_PATH_DATA_SERVICE_SCRIPT,
@@ -33,7 +35,9 @@ typedef enum {
     ROUTE_UNKNOWN
 } route_type_t;
 
-void webserver_init(struct mg_mgr *mgr, const char *listen_url);
+// With a pool, planning requests run on its workers and the event loop keeps serving;
+// with NULL they are planned inline.
+void webserver_init(struct mg_mgr *mgr, const char *listen_url, worker_pool_t *pool);
 void webserver_event_handler(struct mg_connection *c, int ev, void *ev_data);
 
 
@@ -45,6 +49,7 @@ void handle_path_input_environment_save_route(struct mg_connection *c, struct mg
 void handle_path_input_environment_saves_list_route(struct mg_connection *c, struct mg_http_message *hm);
 void handle_path_input_environment_load_route(struct mg_connection *c, struct mg_http_message *hm);
 void handle_path_input_environment_delete_route(struct mg_connection *c, struct mg_http_message *hm);
+void handle_path_input_environment_cache_stats_route(struct mg_connection *c, struct mg_http_message *hm);
 
 // /services
 void handle_path_coordinate_transformer_script_route(struct mg_connection *c, struct mg_http_message *hm);
@@ -0,0 +1,373 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "worker_pool.h"
+
+#ifdef _WIN32
+#include <windows.h>
+
+typedef CRITICAL_SECTION pool_mutex_t;
+typedef CONDITION_VARIABLE pool_cond_t;
+typedef HANDLE pool_thread_t;
+
+#define pool_mutex_init(m) InitializeCriticalSection(m)
+#define pool_mutex_destroy(m) DeleteCriticalSection(m)
+#define pool_mutex_lock(m) EnterCriticalSection(m)
+#define pool_mutex_unlock(m) LeaveCriticalSection(m)
+#define pool_cond_init(c) InitializeConditionVariable(c)
+#define pool_cond_destroy(c) ((void)(c))
+#define pool_cond_wait(c, m) SleepConditionVariableCS((c), (m), INFINITE)
+#define pool_cond_signal(c) WakeConditionVariable(c)
+#define pool_cond_broadcast(c) WakeAllConditionVariable(c)
+#else
+#include <pthread.h>
+#include <unistd.h>
+
+typedef pthread_mutex_t pool_mutex_t;
+typedef pthread_cond_t pool_cond_t;
+typedef pthread_t pool_thread_t;
+
+#define pool_mutex_init(m) pthread_mutex_init((m), NULL)
+#define pool_mutex_destroy(m) pthread_mutex_destroy(m)
+#define pool_mutex_lock(m) pthread_mutex_lock(m)
+#define pool_mutex_unlock(m) pthread_mutex_unlock(m)
+#define pool_cond_init(c) pthread_cond_init((c), NULL)
+#define pool_cond_destroy(c) pthread_cond_destroy(c)
+#define pool_cond_wait(c, m) pthread_cond_wait((c), (m))
+#define pool_cond_signal(c) pthread_cond_signal(c)
+#define pool_cond_broadcast(c) pthread_cond_broadcast(c)
+#endif
+
+typedef struct
+{
+    worker_task_fn_t fn;
+    void *arg;
+} worker_task_t;
+
+struct worker_pool_t
+{
+    pool_mutex_t mutex;
+    pool_cond_t task_available;
+
+    worker_task_t *tasks;       // Ring buffer
+    int task_capacity;
+    int task_head;
+    int task_count;
+
+    pool_thread_t *threads;
+    int thread_count;
+    bool stopping;
+};
+
+// Shared by the caller and the helpers of one worker_pool_parallel_for call; freed by
+// whoever drops the last reference, so helpers that start late never touch freed memory
+typedef struct
+{
+    pool_mutex_t mutex;
+    pool_cond_t done;
+    worker_range_fn_t fn;
+    void *ctx;
+    int count;
+    int next;
+    int completed;
+    int refs;
+} worker_range_t;
+
+// FORWARD DECLARATIONS ---------------------------------------------
+
+static int start_worker_thread(pool_thread_t *thread, worker_pool_t *pool);
+static void join_worker_thread(pool_thread_t thread);
+static void run_worker_loop(worker_pool_t *pool);
+
+static void run_range(worker_range_t *range);
+static void run_range_task(void *arg);
+static void release_range(worker_range_t *range);
+
+// IMPLEMENTATION --- worker_pool -----------------------------------
+
+worker_pool_t *worker_pool_create(int thread_count)
+{
+    if (thread_count < 1)
+        thread_count = 1;
+
+    worker_pool_t *pool = (worker_pool_t *)calloc(1, sizeof(worker_pool_t));
+    if (!pool)
+        return NULL;
+
+    pool->task_capacity = 64;
+    pool->tasks = (worker_task_t *)malloc((size_t)pool->task_capacity * sizeof(worker_task_t));
+    pool->threads = (pool_thread_t *)calloc((size_t)thread_count, sizeof(pool_thread_t));
+    if (!pool->tasks || !pool->threads)
+    {
+        free(pool->tasks);
+        free(pool->threads);
+        free(pool);
+        return NULL;
+    }
+
+    pool_mutex_init(&pool->mutex);
+    pool_cond_init(&pool->task_available);
+
+    for (int i = 0; i < thread_count; i++)
+    {
+        if (start_worker_thread(&pool->threads[pool->thread_count], pool) != 0)
+            break;
+        pool->thread_count++;
+    }
+
+    if (pool->thread_count == 0)
+    {
+        worker_pool_destroy(pool);
+        return NULL;
+    }
+
+    return pool;
+}
+
+int worker_pool_submit(worker_pool_t *pool, worker_task_fn_t fn, void *arg)
+{
+    if (!pool || !fn)
+        return -1;
+
+    pool_mutex_lock(&pool->mutex);
+
+    if (pool->stopping)
+    {
+        pool_mutex_unlock(&pool->mutex);
+        return -2;
+    }
+
+    if (pool->task_count == pool->task_capacity)
+    {
+        int new_capacity = pool->task_capacity * 2;
+        worker_task_t *tasks = (worker_task_t *)malloc((size_t)new_capacity * sizeof(worker_task_t));
+        if (!tasks)
+        {
+            pool_mutex_unlock(&pool->mutex);
+            return -3;
+        }
+        for (int i = 0; i < pool->task_count; i++)
+        {
+            tasks[i] = pool->tasks[(pool->task_head + i) % pool->task_capacity];
+        }
+        free(pool->tasks);
+        pool->tasks = tasks;
+        pool->task_capacity = new_capacity;
+        pool->task_head = 0;
+    }
+
+    int tail = (pool->task_head + pool->task_count) % pool->task_capacity;
+    pool->tasks[tail].fn = fn;
+    pool->tasks[tail].arg = arg;
+    pool->task_count++;
+
+    pool_cond_signal(&pool->task_available);
+    pool_mutex_unlock(&pool->mutex);
+    return 0;
+}
+
+int worker_pool_parallel_for(worker_pool_t *pool, int count, worker_range_fn_t fn, void *ctx)
+{
+    if (!fn || count < 0)
+        return -1;
+
+    if (count == 0)
+        return 0;
+
+    if (!pool || count == 1)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            fn(ctx, i);
+        }
+        return 0;
+    }
+
+    worker_range_t *range = (worker_range_t *)calloc(1, sizeof(worker_range_t));
+    if (!range)
+        return -2;
+
+    pool_mutex_init(&range->mutex);
+    pool_cond_init(&range->done);
+    range->fn = fn;
+    range->ctx = ctx;
+    range->count = count;
+    range->refs = 1;
+
+    int helpers = pool->thread_count < count - 1 ? pool->thread_count : count - 1;
+    for (int i = 0; i < helpers; i++)
+    {
+        pool_mutex_lock(&range->mutex);
+        range->refs++;
+        pool_mutex_unlock(&range->mutex);
+
+        if (worker_pool_submit(pool, run_range_task, range) != 0)
+        {
+            pool_mutex_lock(&range->mutex);
+            range->refs--;
+            pool_mutex_unlock(&range->mutex);
+            break;
+        }
+    }
+
+    run_range(range);
+
+    pool_mutex_lock(&range->mutex);
+    while (range->completed < range->count)
+    {
+        pool_cond_wait(&range->done, &range->mutex);
+    }
+    pool_mutex_unlock(&range->mutex);
+
+    release_range(range);
+    return 0;
+}
+
+int worker_pool_thread_count(const worker_pool_t *pool)
+{
+    return pool ? pool->thread_count : 0;
+}
+
+int worker_pool_cpu_count(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+void worker_pool_destroy(worker_pool_t *pool)
+{
+    if (!pool)
+        return;
+
+    pool_mutex_lock(&pool->mutex);
+    pool->stopping = true;
+    pool_cond_broadcast(&pool->task_available);
+    pool_mutex_unlock(&pool->mutex);
+
+    for (int i = 0; i < pool->thread_count; i++)
+    {
+        join_worker_thread(pool->threads[i]);
+    }
+
+    pool_cond_destroy(&pool->task_available);
+    pool_mutex_destroy(&pool->mutex);
+    free(pool->threads);
+    free(pool->tasks);
+    free(pool);
+}
+
+// --- WORKER THREADS
+
+#ifdef _WIN32
+static DWORD WINAPI worker_thread_main(LPVOID arg)
+{
+    run_worker_loop((worker_pool_t *)arg);
+    return 0;
+}
+
+static int start_worker_thread(pool_thread_t *thread, worker_pool_t *pool)
+{
+    *thread = CreateThread(NULL, 0, worker_thread_main, pool, 0, NULL);
+    return *thread ? 0 : -1;
+}
+
+static void join_worker_thread(pool_thread_t thread)
+{
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+#else
+static void *worker_thread_main(void *arg)
+{
+    run_worker_loop((worker_pool_t *)arg);
+    return NULL;
+}
+
+static int start_worker_thread(pool_thread_t *thread, worker_pool_t *pool)
+{
+    return pthread_create(thread, NULL, worker_thread_main, pool) == 0 ? 0 : -1;
+}
+
+static void join_worker_thread(pool_thread_t thread)
+{
+    pthread_join(thread, NULL);
+}
+#endif
+
+static void run_worker_loop(worker_pool_t *pool)
+{
+    for (;;)
+    {
+        pool_mutex_lock(&pool->mutex);
+        while (pool->task_count == 0 && !pool->stopping)
+        {
+            pool_cond_wait(&pool->task_available, &pool->mutex);
+        }
+
+        if (pool->task_count == 0)
+        {
+            pool_mutex_unlock(&pool->mutex);
+            return;
+        }
+
+        worker_task_t task = pool->tasks[pool->task_head];
+        pool->task_head = (pool->task_head + 1) % pool->task_capacity;
+        pool->task_count--;
+        pool_mutex_unlock(&pool->mutex);
+
+        task.fn(task.arg);
+    }
+}
+
+// --- PARALLEL_FOR
+
+static void run_range(worker_range_t *range)
+{
+    for (;;)
+    {
+        pool_mutex_lock(&range->mutex);
+        if (range->next >= range->count)
+        {
+            pool_mutex_unlock(&range->mutex);
+            return;
+        }
+        int index = range->next++;
+        pool_mutex_unlock(&range->mutex);
+
+        range->fn(range->ctx, index);
+
+        pool_mutex_lock(&range->mutex);
+        range->completed++;
+        if (range->completed == range->count)
+            pool_cond_broadcast(&range->done);
+        pool_mutex_unlock(&range->mutex);
+    }
+}
+
+static void run_range_task(void *arg)
+{
+    worker_range_t *range = (worker_range_t *)arg;
+    run_range(range);
+    release_range(range);
+}
+
+static void release_range(worker_range_t *range)
+{
+    pool_mutex_lock(&range->mutex);
+    int refs = --range->refs;
+    pool_mutex_unlock(&range->mutex);
+
+    if (refs == 0)
+    {
+        pool_cond_destroy(&range->done);
+        pool_mutex_destroy(&range->mutex);
+        free(range);
+    }
+}
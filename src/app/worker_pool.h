@@ -0,0 +1,28 @@
+// Fixed-size pool of worker threads (Win32 threads on Windows, pthreads elsewhere)
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+typedef struct worker_pool_t worker_pool_t;
+
+typedef void (*worker_task_fn_t)(void *arg);
+typedef void (*worker_range_fn_t)(void *ctx, int index);
+
+// Returns NULL if no thread could be started.
+worker_pool_t *worker_pool_create(int thread_count);
+
+// Queues fn(arg) to run on one of the workers. Returns 0 on success.
+int worker_pool_submit(worker_pool_t *pool, worker_task_fn_t fn, void *arg);
+
+// Runs fn(ctx, i) for every i in [0, count) and returns once all calls have finished.
+// The calling thread takes part, so this never waits on workers that are busy
+// elsewhere (safe to call from inside a pool task). Returns 0 on success.
+int worker_pool_parallel_for(worker_pool_t *pool, int count, worker_range_fn_t fn, void *ctx);
+
+int worker_pool_thread_count(const worker_pool_t *pool);
+int worker_pool_cpu_count(void);
+
+// Runs the tasks still queued, then joins and frees the workers.
+void worker_pool_destroy(worker_pool_t *pool);
+
+#endif // WORKER_POOL_H
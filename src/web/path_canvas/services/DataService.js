@@ -1,25 +1,49 @@
 class DataService {
     constructor() {
         this.baseUrl = '';
+        this.lastPlan = null;      // { etag, json } of the last plan, for If-None-Match
+        // Binary plans (src/app/coverage_path_planning/plan_binary.h) are preferred; the
+        // JSON fallback uses flat polylines in integer millimetres, delta-encoded
+        this.planBinaryType = 'application/vnd.bladeofgrass.plan';
+        this.coordinateEncoding = { coordinateFormat: 'flat', coordinateScale: 1000, coordinateDelta: true };
     }
 
     exportToConsole(data) {
     // Intentionally no-op: avoid logging environment data in the browser console
     }
 
-    async sendToServer(data) {
+    // sections: optional list of response sections, e.g. ['motion_plan']; omitted means all
+    async sendToServer(data, sections) {
         try {
+            const headers = {
+                'Content-Type': 'application/json',
+                'Accept': `${this.planBinaryType}, application/json;q=0.5`
+            };
+            if (this.lastPlan) {
+                headers['If-None-Match'] = this.lastPlan.etag;
+            }
             const res = await fetch('/environment/InputEnvironment/export', {
                 method: 'POST',
-                headers: {
-                    'Content-Type': 'application/json'
-                },
-                body: JSON.stringify(data)
+                headers,
+                body: JSON.stringify({
+                    ...data,
+                    ...this.coordinateEncoding,
+                    ...(sections ? { outputSections: sections } : {})
+                })
             });
+            // Unchanged environment: the server only sends the ETag back
+            if (res.status === 304 && this.lastPlan) {
+                return this.lastPlan.json;
+            }
             if (!res.ok) {
                 throw new Error(`Server responded ${res.status}`);
             }
-            const json = await res.json().catch(() => ({}));
+            const contentType = res.headers.get('Content-Type') || '';
+            const json = contentType.startsWith(this.planBinaryType)
+                ? this.decodePlanBinary(await res.arrayBuffer())
+                : this.decodeCoordinates(await res.json().catch(() => ({})));
+            const etag = res.headers.get('ETag');
+            this.lastPlan = etag ? { etag, json } : null;
             if (json && Array.isArray(json.event_list)) {
                 console.log('Event list received:', json);
             } else {
@@ -32,6 +56,155 @@ class DataService {
         }
     }
 
+    // Turns a flat-coordinate response back into metres, in place. Points and event edges
+    // become {x, y} / {begin, end} objects; polylines (cell ceiling_edges and floor_edges,
+    // motion coverage and navigation) stay flat as Float64Array [x0, y0, x1, y1, ...],
+    // which is what CanvasManager draws from. Edge chains hold four values per edge.
+    decodeCoordinates(json) {
+        const encoding = json && json.coordinates;
+        if (!encoding || encoding.format !== 'flat') {
+            return json;
+        }
+
+        const unit = encoding.scale ? 1 / encoding.scale : 1;
+        const point = (p) => ({ x: p[0] * unit, y: p[1] * unit });
+        const edge = (e) => ({ begin: point(e), end: { x: e[2] * unit, y: e[3] * unit } });
+        const polyline = (values) => {
+            const out = new Float64Array(values ? values.length : 0);
+            let x = 0;
+            let y = 0;
+            for (let i = 0; i + 1 < out.length; i += 2) {
+                x = encoding.delta ? x + values[i] : values[i];
+                y = encoding.delta ? y + values[i + 1] : values[i + 1];
+                out[i] = x * unit;
+                out[i + 1] = y * unit;
+            }
+            return out;
+        };
+
+        if (Array.isArray(json.event_list)) {
+            for (const ev of json.event_list) {
+                if (ev.vertex) ev.vertex = point(ev.vertex);
+                if (ev.floor_edge) ev.floor_edge = edge(ev.floor_edge);
+                if (ev.ceiling_edge) ev.ceiling_edge = edge(ev.ceiling_edge);
+            }
+        }
+        if (Array.isArray(json.cell_list)) {
+            for (const cell of json.cell_list) {
+                cell.c_begin = point(cell.c_begin);
+                cell.c_end = point(cell.c_end);
+                cell.f_begin = point(cell.f_begin);
+                cell.f_end = point(cell.f_end);
+                cell.ceiling_edges = polyline(cell.ceiling_edges);
+                cell.floor_edges = polyline(cell.floor_edges);
+            }
+        }
+        if (json.motion_plan && Array.isArray(json.motion_plan.sections)) {
+            for (const section of json.motion_plan.sections) {
+                section.coverage = polyline(section.coverage);
+                section.navigation = polyline(section.navigation);
+            }
+        }
+        return json;
+    }
+
+    // Reads a binary plan into the same shape decodeCoordinates produces. Polylines,
+    // the cell graph and edge chains are typed-array views into the response buffer,
+    // not copies; typed arrays use the host byte order, little-endian in every browser.
+    decodePlanBinary(buffer) {
+        const view = new DataView(buffer);
+        if (buffer.byteLength < 16 || view.getUint32(0, true) !== 0x4C504742 || view.getUint16(4, true) !== 1) {
+            return { status: 'error', message: 'Malformed binary plan' };
+        }
+
+        const sections = new Map();
+        const sectionCount = view.getUint16(6, true);
+        for (let i = 0; i < sectionCount; i++) {
+            const entry = 16 + i * 16;
+            const id = view.getUint32(entry, true);
+            const type = view.getUint32(entry + 4, true);
+            const offset = view.getUint32(entry + 8, true);
+            const count = view.getUint32(entry + 12, true);
+            sections.set(id, type === 1 ? new Float32Array(buffer, offset, count) : new Int32Array(buffer, offset, count));
+        }
+
+        const polygonTypes = ['BOUNDARY', 'OBSTACLE'];
+        const eventTypes = ['B_IN', 'B_SIDE_IN', 'B_INIT', 'B_OUT', 'B_SIDE_OUT', 'B_DEINIT',
+            'IN', 'SIDE_IN', 'OUT', 'SIDE_OUT', 'FLOOR', 'CEILING'];
+        const point = (values, i) => ({ x: values[i], y: values[i + 1] });
+        const plan = { status: 'ok' };
+
+        const simplification = sections.get(1);
+        if (simplification) {
+            plan.simplification = { input_vertices: simplification[0], output_vertices: simplification[1] };
+        }
+
+        const cellOrder = sections.get(13);
+        if (cellOrder) {
+            plan.cell_order = { transit_length: cellOrder[0], adjacency_transit_length: cellOrder[1] };
+        }
+
+        const eventInfo = sections.get(2);
+        if (eventInfo) {
+            const vertices = sections.get(3);
+            const edges = sections.get(4);
+            plan.event_list = [];
+            for (let i = 0; i < eventInfo.length / 2; i++) {
+                plan.event_list.push({
+                    polygon_type: polygonTypes[eventInfo[2 * i]] || 'UNKNOWN',
+                    vertex: point(vertices, 2 * i),
+                    event_type: eventTypes[eventInfo[2 * i + 1]] || 'UNKNOWN',
+                    floor_edge: { begin: point(edges, 8 * i), end: point(edges, 8 * i + 2) },
+                    ceiling_edge: { begin: point(edges, 8 * i + 4), end: point(edges, 8 * i + 6) }
+                });
+            }
+        }
+
+        const cellInfo = sections.get(5);
+        if (cellInfo) {
+            const corners = sections.get(6);
+            const edges = sections.get(7);
+            plan.cell_list = [];
+            for (let i = 0; i < cellInfo.length / 8; i++) {
+                const info = 8 * i;
+                plan.cell_list.push({
+                    cell_number: i,
+                    c_begin: point(corners, 8 * i),
+                    c_end: point(corners, 8 * i + 2),
+                    f_begin: point(corners, 8 * i + 4),
+                    f_end: point(corners, 8 * i + 6),
+                    ceiling_edges: edges.subarray(4 * cellInfo[info], 4 * (cellInfo[info] + cellInfo[info + 1])),
+                    floor_edges: edges.subarray(4 * cellInfo[info + 2], 4 * (cellInfo[info + 2] + cellInfo[info + 3])),
+                    open: cellInfo[info + 4] !== 0,
+                    visited: cellInfo[info + 5] !== 0,
+                    cleaned: cellInfo[info + 6] !== 0
+                });
+            }
+        }
+
+        if (sections.has(8)) {
+            plan.cell_graph = { offsets: sections.get(8), neighbors: sections.get(9) };
+        }
+        if (sections.has(10)) {
+            plan.path_list = Array.from(sections.get(10));
+        }
+
+        const motionInfo = sections.get(11);
+        if (motionInfo) {
+            const points = sections.get(12);
+            plan.motion_plan = { sections: [] };
+            for (let i = 0; i < motionInfo.length / 4; i++) {
+                const info = 4 * i;
+                plan.motion_plan.sections.push({
+                    section_id: i,
+                    coverage: points.subarray(2 * motionInfo[info], 2 * (motionInfo[info] + motionInfo[info + 1])),
+                    navigation: points.subarray(2 * motionInfo[info + 2], 2 * (motionInfo[info + 2] + motionInfo[info + 3]))
+                });
+            }
+        }
+        return plan;
+    }
+
     async saveEnvironment(name, data) {
     const url = `/environment/InputEnvironment/save?name=${encodeURIComponent(name)}`;
         const res = await fetch(url, {
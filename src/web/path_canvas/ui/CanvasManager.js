@@ -394,15 +394,12 @@ class CanvasManager {
             this.ctx.moveTo(cx1, cy1);
             
             // Draw ceiling edges: c_begin, ceiling_edges[0].end -> ceiling_edges[i] -> ceiling_edges[last].begin, c_end
-            if (cell.ceiling_edges && cell.ceiling_edges.length > 0) {
-                // Move to first ceiling edge end
-                const firstEdge = cell.ceiling_edges[0];
-                this.ctx.lineTo(firstEdge.end.x * this.pixelsPerMeter, firstEdge.end.y * this.pixelsPerMeter);
-                
-                // Draw through all ceiling edges
-                for (let j = 1; j < cell.ceiling_edges.length; j++) {
-                    const edge = cell.ceiling_edges[j];
-                    this.ctx.lineTo(edge.end.x * this.pixelsPerMeter, edge.end.y * this.pixelsPerMeter);
+            // Edge chains are flat [bx, by, ex, ey, ...]: edge j ends at [4j + 2], [4j + 3]
+            const ceiling = cell.ceiling_edges;
+            if (ceiling && ceiling.length > 0) {
+                // Draw through the end of every ceiling edge, first to last
+                for (let j = 2; j < ceiling.length; j += 4) {
+                    this.ctx.lineTo(ceiling[j] * this.pixelsPerMeter, ceiling[j + 1] * this.pixelsPerMeter);
                 }
             }
             
@@ -417,20 +414,15 @@ class CanvasManager {
             this.ctx.lineTo(fx1, fy1);
             
             // Draw floor edges in reverse: f_begin, floor_edges[last].end -> floor_edges[i] -> floor_edges[0].begin, f_end
-            if (cell.floor_edges && cell.floor_edges.length > 0) {
-                // Move to last floor edge end (traverse in reverse)
-                const lastEdge = cell.floor_edges[cell.floor_edges.length - 1];
-                this.ctx.lineTo(lastEdge.end.x * this.pixelsPerMeter, lastEdge.end.y * this.pixelsPerMeter);
-                
-                // Draw through all floor edges in reverse order
-                for (let j = cell.floor_edges.length - 2; j >= 0; j--) {
-                    const edge = cell.floor_edges[j];
-                    this.ctx.lineTo(edge.end.x * this.pixelsPerMeter, edge.end.y * this.pixelsPerMeter);
+            const floor = cell.floor_edges;
+            if (floor && floor.length > 0) {
+                // Draw through the end of every floor edge, last to first
+                for (let j = floor.length - 2; j >= 2; j -= 4) {
+                    this.ctx.lineTo(floor[j] * this.pixelsPerMeter, floor[j + 1] * this.pixelsPerMeter);
                 }
                 
                 // Draw to first floor edge begin: floor_edges[0].begin
-                const firstEdge = cell.floor_edges[0];
-                this.ctx.lineTo(firstEdge.begin.x * this.pixelsPerMeter, firstEdge.begin.y * this.pixelsPerMeter);
+                this.ctx.lineTo(floor[0] * this.pixelsPerMeter, floor[1] * this.pixelsPerMeter);
             }
             
             // Draw to floor end: floor_edges[0].begin, f_end
@@ -483,34 +475,32 @@ class CanvasManager {
         const edgePoints = [];
         
         // Add ceiling edge points
-        if (cell.ceiling_edges && cell.ceiling_edges.length > 0) {
+        const ceiling = cell.ceiling_edges;
+        if (ceiling && ceiling.length > 0) {
             edgePoints.push({ x: cx1, y: cy1 });
-            for (const edge of cell.ceiling_edges) {
+            for (let i = 2; i < ceiling.length; i += 4) {
                 edgePoints.push({ 
-                    x: edge.end.x * this.pixelsPerMeter, 
-                    y: edge.end.y * this.pixelsPerMeter 
+                    x: ceiling[i] * this.pixelsPerMeter, 
+                    y: ceiling[i + 1] * this.pixelsPerMeter 
                 });
             }
             edgePoints.push({ x: cx2, y: cy2 });
         }
         
         // Add floor edge points (in reverse)
-        if (cell.floor_edges && cell.floor_edges.length > 0) {
+        const floor = cell.floor_edges;
+        if (floor && floor.length > 0) {
             edgePoints.push({ x: fx1, y: fy1 });
-            for (let i = cell.floor_edges.length - 1; i >= 0; i--) {
-                const edge = cell.floor_edges[i];
-                edgePoints.push({ 
-                    x: edge.end.x * this.pixelsPerMeter, 
-                    y: edge.end.y * this.pixelsPerMeter 
-                });
-            }
-            if (cell.floor_edges.length > 0) {
-                const firstEdge = cell.floor_edges[0];
+            for (let i = floor.length - 2; i >= 2; i -= 4) {
                 edgePoints.push({ 
-                    x: firstEdge.begin.x * this.pixelsPerMeter, 
-                    y: firstEdge.begin.y * this.pixelsPerMeter 
+                    x: floor[i] * this.pixelsPerMeter, 
+                    y: floor[i + 1] * this.pixelsPerMeter 
                 });
             }
+            edgePoints.push({ 
+                x: floor[0] * this.pixelsPerMeter, 
+                y: floor[1] * this.pixelsPerMeter 
+            });
             edgePoints.push({ x: fx2, y: fy2 });
         }
         
@@ -556,26 +546,23 @@ class CanvasManager {
         // Add ceiling path
         polygon.push({ x: cell.c_begin.x * this.pixelsPerMeter, y: cell.c_begin.y * this.pixelsPerMeter });
         
-        if (cell.ceiling_edges && cell.ceiling_edges.length > 0) {
-            for (const edge of cell.ceiling_edges) {
-                polygon.push({ x: edge.end.x * this.pixelsPerMeter, y: edge.end.y * this.pixelsPerMeter });
+        const ceiling = cell.ceiling_edges;
+        if (ceiling && ceiling.length > 0) {
+            for (let i = 2; i < ceiling.length; i += 4) {
+                polygon.push({ x: ceiling[i] * this.pixelsPerMeter, y: ceiling[i + 1] * this.pixelsPerMeter });
             }
         }
         
         polygon.push({ x: cell.c_end.x * this.pixelsPerMeter, y: cell.c_end.y * this.pixelsPerMeter });
         polygon.push({ x: cell.f_begin.x * this.pixelsPerMeter, y: cell.f_begin.y * this.pixelsPerMeter });
         
-        if (cell.floor_edges && cell.floor_edges.length > 0) {
-            const lastEdge = cell.floor_edges[cell.floor_edges.length - 1];
-            polygon.push({ x: lastEdge.end.x * this.pixelsPerMeter, y: lastEdge.end.y * this.pixelsPerMeter });
-            
-            for (let i = cell.floor_edges.length - 2; i >= 0; i--) {
-                const edge = cell.floor_edges[i];
-                polygon.push({ x: edge.end.x * this.pixelsPerMeter, y: edge.end.y * this.pixelsPerMeter });
+        const floor = cell.floor_edges;
+        if (floor && floor.length > 0) {
+            for (let i = floor.length - 2; i >= 2; i -= 4) {
+                polygon.push({ x: floor[i] * this.pixelsPerMeter, y: floor[i + 1] * this.pixelsPerMeter });
             }
             
-            const firstEdge = cell.floor_edges[0];
-            polygon.push({ x: firstEdge.begin.x * this.pixelsPerMeter, y: firstEdge.begin.y * this.pixelsPerMeter });
+            polygon.push({ x: floor[0] * this.pixelsPerMeter, y: floor[1] * this.pixelsPerMeter });
         }
         
         polygon.push({ x: cell.f_end.x * this.pixelsPerMeter, y: cell.f_end.y * this.pixelsPerMeter });
@@ -763,21 +750,20 @@ class CanvasManager {
         for (let i = 0; i < this.motionPlan.sections.length; i++) {
             const section = this.motionPlan.sections[i];
             
-            // Draw coverage path as a continuous line
-            if (section.coverage && section.coverage.length > 1) {
+            // Draw coverage path as a continuous line (flat [x0, y0, x1, y1, ...])
+            const coverage = section.coverage;
+            if (coverage && coverage.length > 2) {
                 this.ctx.beginPath();
                 
                 // Start the path at the first point
-                const firstPoint = section.coverage[0];
-                const firstX = firstPoint.x * this.pixelsPerMeter;
-                const firstY = firstPoint.y * this.pixelsPerMeter;
+                const firstX = coverage[0] * this.pixelsPerMeter;
+                const firstY = coverage[1] * this.pixelsPerMeter;
                 this.ctx.moveTo(firstX, firstY);
                 
                 // Connect all subsequent points
-                for (let j = 1; j < section.coverage.length; j++) {
-                    const point = section.coverage[j];
-                    const x = point.x * this.pixelsPerMeter;
-                    const y = point.y * this.pixelsPerMeter;
+                for (let j = 2; j < coverage.length; j += 2) {
+                    const x = coverage[j] * this.pixelsPerMeter;
+                    const y = coverage[j + 1] * this.pixelsPerMeter;
                     this.ctx.lineTo(x, y);
                 }
                 
@@ -793,14 +779,14 @@ class CanvasManager {
         for (let i = 0; i < this.motionPlan.sections.length; i++) {
             const section = this.motionPlan.sections[i];
             
-            // Draw navigation points
-            if (section.navigation && section.navigation.length > 1) {
+            // Draw navigation points (flat [x0, y0, x1, y1, ...])
+            const navigation = section.navigation;
+            if (navigation && navigation.length > 2) {
                 this.ctx.beginPath();
                 
-                for (let j = 0; j < section.navigation.length; j++) {
-                    const point = section.navigation[j];
-                    const x = point.x * this.pixelsPerMeter;
-                    const y = point.y * this.pixelsPerMeter;
+                for (let j = 0; j < navigation.length; j += 2) {
+                    const x = navigation[j] * this.pixelsPerMeter;
+                    const y = navigation[j + 1] * this.pixelsPerMeter;
                     
                     if (j === 0) {
                         this.ctx.moveTo(x, y);
@@ -821,21 +807,20 @@ class CanvasManager {
         for (let i = 0; i < this.motionPlan.sections.length; i++) {
             const section = this.motionPlan.sections[i];
             
-            if (section.coverage && section.coverage.length > 0) {
+            const coverage = section.coverage;
+            if (coverage && coverage.length > 0) {
                 // Mark start of coverage
-                const startPoint = section.coverage[0];
-                const startX = startPoint.x * this.pixelsPerMeter;
-                const startY = startPoint.y * this.pixelsPerMeter;
+                const startX = coverage[0] * this.pixelsPerMeter;
+                const startY = coverage[1] * this.pixelsPerMeter;
                 
                 this.ctx.beginPath();
                 this.ctx.arc(startX, startY, this.getScaledPointRadius(this.baseValues.pointRadius.large), 0, 2 * Math.PI);
                 this.ctx.fill();
                 
                 // Mark end of coverage
-                if (section.coverage.length > 1) {
-                    const endPoint = section.coverage[section.coverage.length - 1];
-                    const endX = endPoint.x * this.pixelsPerMeter;
-                    const endY = endPoint.y * this.pixelsPerMeter;
+                if (coverage.length > 2) {
+                    const endX = coverage[coverage.length - 2] * this.pixelsPerMeter;
+                    const endY = coverage[coverage.length - 1] * this.pixelsPerMeter;
 
                     this.ctx.fillStyle = this.styles.motion.end;
                     this.ctx.beginPath();
@@ -869,14 +854,14 @@ class CanvasManager {
         for (let i = 0; i < this.motionPlan.sections.length; i++) {
             const section = this.motionPlan.sections[i];
             
-            // Draw navigation points
-            if (section.navigation && section.navigation.length > 1) {
+            // Draw navigation points (flat [x0, y0, x1, y1, ...])
+            const navigation = section.navigation;
+            if (navigation && navigation.length > 2) {
                 this.ctx.beginPath();
                 
-                for (let j = 0; j < section.navigation.length; j++) {
-                    const point = section.navigation[j];
-                    const x = point.x * this.pixelsPerMeter;
-                    const y = point.y * this.pixelsPerMeter;
+                for (let j = 0; j < navigation.length; j += 2) {
+                    const x = navigation[j] * this.pixelsPerMeter;
+                    const y = navigation[j + 1] * this.pixelsPerMeter;
                     
                     if (j === 0) {
                         this.ctx.moveTo(x, y);
@@ -897,21 +882,20 @@ class CanvasManager {
         for (let i = 0; i < this.motionPlan.sections.length; i++) {
             const section = this.motionPlan.sections[i];
             
-            if (section.coverage && section.coverage.length > 0) {
+            const coverage = section.coverage;
+            if (coverage && coverage.length > 0) {
                 // Mark start of coverage section
-                const startPoint = section.coverage[0];
-                const startX = startPoint.x * this.pixelsPerMeter;
-                const startY = startPoint.y * this.pixelsPerMeter;
+                const startX = coverage[0] * this.pixelsPerMeter;
+                const startY = coverage[1] * this.pixelsPerMeter;
                 
                 this.ctx.beginPath();
                 this.ctx.arc(startX, startY, this.getScaledPointRadius(this.baseValues.pointRadius.motion), 0, 2 * Math.PI);
                 this.ctx.fill();
                 
                 // Mark end of coverage section
-                if (section.coverage.length > 1) {
-                    const endPoint = section.coverage[section.coverage.length - 1];
-                    const endX = endPoint.x * this.pixelsPerMeter;
-                    const endY = endPoint.y * this.pixelsPerMeter;
+                if (coverage.length > 2) {
+                    const endX = coverage[coverage.length - 2] * this.pixelsPerMeter;
+                    const endY = coverage[coverage.length - 1] * this.pixelsPerMeter;
 
                     this.ctx.fillStyle = this.styles.motion.end;
                     this.ctx.beginPath();
@@ -927,11 +911,11 @@ class CanvasManager {
         for (let i = 0; i < this.motionPlan.sections.length; i++) {
             const section = this.motionPlan.sections[i];
             
-            if (section.navigation && section.navigation.length > 0) {
-                for (let j = 0; j < section.navigation.length; j++) {
-                    const point = section.navigation[j];
-                    const x = point.x * this.pixelsPerMeter;
-                    const y = point.y * this.pixelsPerMeter;
+            const navigation = section.navigation;
+            if (navigation && navigation.length > 0) {
+                for (let j = 0; j < navigation.length; j += 2) {
+                    const x = navigation[j] * this.pixelsPerMeter;
+                    const y = navigation[j + 1] * this.pixelsPerMeter;
                     
                     this.ctx.beginPath();
                     this.ctx.arc(x, y, Math.max(2, 3 / this.scale), 0, 2 * Math.PI);
@@ -1162,15 +1146,15 @@ class CanvasManager {
         for (let i = 0; i < this.motionPlan.sections.length; i++) {
             const section = this.motionPlan.sections[i];
             
-            if (section.coverage && section.coverage.length > 0) {
+            const coverage = section.coverage;
+            if (coverage && coverage.length > 0) {
                 // Get section_id from the section data, or fall back to array index
                 const sectionId = section.section_id !== undefined ? section.section_id : i;
                 const label = String(sectionId);
                 
                 // Label start point
-                const startPoint = section.coverage[0];
-                const startX = startPoint.x * this.pixelsPerMeter;
-                const startY = startPoint.y * this.pixelsPerMeter;
+                const startX = coverage[0] * this.pixelsPerMeter;
+                const startY = coverage[1] * this.pixelsPerMeter;
                 
                 // Dark outline for contrast
                 this.ctx.lineWidth = this.getScaledLineWidth(this.baseValues.lineWidth.normal);
@@ -1182,10 +1166,9 @@ class CanvasManager {
                 this.ctx.fillText(label, startX, startY);
                 
                 // Label end point (if different from start)
-                if (section.coverage.length > 1) {
-                    const endPoint = section.coverage[section.coverage.length - 1];
-                    const endX = endPoint.x * this.pixelsPerMeter;
-                    const endY = endPoint.y * this.pixelsPerMeter;
+                if (coverage.length > 2) {
+                    const endX = coverage[coverage.length - 2] * this.pixelsPerMeter;
+                    const endY = coverage[coverage.length - 1] * this.pixelsPerMeter;
                     
                     // Dark outline for contrast
                     this.ctx.strokeStyle = this.styles.text.outline;